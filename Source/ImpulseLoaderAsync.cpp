@@ -10,9 +10,10 @@ Author:  John Flynn
 
 #include "ImpulseLoaderAsync.h"
 
-ImpulseLoaderAsync::ImpulseLoaderAsync (ado::Convolution& eng, ado::Buffer& impulse)
+ImpulseLoaderAsync::ImpulseLoaderAsync (ado::MultichannelConvolution& eng, ado::Buffer& impulse, const AudioProcessor& proc)
     : engine {eng},
-      ir {impulse}
+      ir {impulse},
+      processor {proc}
 {
     startTimer (500);
 }
@@ -39,50 +40,13 @@ void ImpulseLoaderAsync::timerCallback()
 
 void ImpulseLoaderAsync::changeImpulse (int newImpulse)
 {
-    jassert (1 <= newImpulse && newImpulse <= 6);   // only 6 WAV IRs to choose!
+    jassert (1 <= newImpulse && newImpulse <= ReverbSettings::numImpulses);   // only 6 WAV IRs to choose!
 
-    switch (newImpulse)
-    {
-        case 1:                                               // here's the number \/
-        jdo::bufferLoadFromAudioBinaryData<FlacAudioFormat> (BinaryData::balancemasteringteufelsbergIR014410024bit_flac,
-                                                             BinaryData::balancemasteringteufelsbergIR014410024bit_flacSize,
-                                                             ir,
-                                                             44100);
-        break;
-        case 2:
-        jdo::bufferLoadFromAudioBinaryData<FlacAudioFormat> (BinaryData::balancemasteringteufelsbergIR024410024bit_flac,
-                                                             BinaryData::balancemasteringteufelsbergIR024410024bit_flacSize,
-                                                             ir,
-                                                             44100);
-        break;
-        case 3:
-        jdo::bufferLoadFromAudioBinaryData<FlacAudioFormat> (BinaryData::balancemasteringteufelsbergIR034410024bit_flac,
-                                                             BinaryData::balancemasteringteufelsbergIR034410024bit_flacSize,
-                                                             ir,
-                                                             44100);
-        break;
-        case 4:
-        jdo::bufferLoadFromAudioBinaryData<FlacAudioFormat> (BinaryData::balancemasteringteufelsbergIR044410024bit_flac,
-                                                             BinaryData::balancemasteringteufelsbergIR044410024bit_flacSize,
-                                                             ir,
-                                                             44100);
-        break;
-        case 5:
-        jdo::bufferLoadFromAudioBinaryData<FlacAudioFormat> (BinaryData::balancemasteringteufelsbergIR054410024bit_flac,
-                                                             BinaryData::balancemasteringteufelsbergIR054410024bit_flacSize,
-                                                             ir,
-                                                             44100);
-        break;
-        case 6:
-        jdo::bufferLoadFromAudioBinaryData<FlacAudioFormat> (BinaryData::balancemasteringteufelsbergIR064410024bit_flac,
-                                                             BinaryData::balancemasteringteufelsbergIR064410024bit_flacSize,
-                                                             ir,
-                                                             44100);
-        break;
-
-        default: jassertfalse;  // there are only 6 IRs 1-6 !!!
-        break;
-    }
+    ReverbSettings::loadImpulse (newImpulse, ir);
 
+        // a 2 & a 4 channel capture want different topologies, set before set() rebuilds
+    engine.setTopology (ReverbSettings::getTopology (processor.getMainBusNumInputChannels(),
+                                                     processor.getMainBusNumOutputChannels(),
+                                                     ir.getNumChannels()));
     engine.set (ir);
-}
\ No newline at end of file
+}
@@ -13,6 +13,7 @@
 
 #include "../JuceLibraryCode/JuceHeader.h"
 #include "Judio/Judio.h"
+#include "ReverbSettings.h"
 
 //==============================================================================
 /** Loads impulse from WAV file asynchronously
@@ -23,12 +24,12 @@
     Outside audio thread, a timer checks periodically if this flag is set and
     calls the loading routine appropriately
     
-    @see juce::Timer, ado::Convolution, ado::Buffer
+    @see juce::Timer, ado::MultichannelConvolution, ado::Buffer
 */
 class ImpulseLoaderAsync  : private Timer
 {
 public:
-    ImpulseLoaderAsync (ado::Convolution& eng, ado::Buffer& impulse);
+    ImpulseLoaderAsync (ado::MultichannelConvolution& eng, ado::Buffer& impulse, const AudioProcessor& proc);
 
     void changeImpulseAsync (int newImpulse);
     void changeImpulseNow (int newImpulse) { changeImpulse (newImpulse); } // will block
@@ -39,8 +40,9 @@ private:
     int currentImpulse {-1};    // force initial load
     bool nowChangingImpulseAsync {false};
     
-    ado::Convolution& engine;   // keep handles to processor members
+    ado::MultichannelConvolution& engine;   // keep handles to processor members
     ado::Buffer& ir;
+    const AudioProcessor& processor;        // for its buses, the topology following the impulse's channels
 
     void timerCallback() override;
     void changeImpulse (int newImpulse);
@@ -42,9 +42,15 @@
     - #include "Aidio/Aidio.h"
 */
 
+#include "Kernels.h"
 #include "Utility.h"
 #include "Buffer.h"
+#include "Memory.h"
 #include "Convolution.h"
+#include "MultichannelConvolution.h"
+#include "PartitionTuner.h"
+#include "SegmentedConvolution.h"
+#include "MultiStreamConvolution.h"
 #include "Maths.h"
 #include "Resampling.h"
 #include "Test.h"
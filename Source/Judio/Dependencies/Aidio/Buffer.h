@@ -28,9 +28,12 @@
 #define BUFFER_H_INCLUDED
 
 #include <cassert>
+#include <cstdint>
+#include <vector>
 
 #include "../JuceLibraryCode/JuceHeader.h"
 #include "Dependencies/gsl.h"
+#include "Kernels.h"
 
 namespace ado
 {
@@ -107,7 +110,7 @@ public:
     BufferView (float** buffer, int numChannels, int numSamples)
         : fpp {buffer}, chans {numChannels}, samps {numSamples}
     {
-        Expects (1 <= chans && chans <= 6);     // don't mix up channels and samples
+        Expects (1 <= chans && chans <= 64);    // don't mix up channels and samples
         Expects (8 <= samps);
     }
 
@@ -133,6 +136,17 @@ public:
     int getNumChannels() const { return chans; }
     int getNumSamples()  const { return samps; }
 
+    /** True if every channel starts on an alignment byte boundary. Always true
+        for views of an ado::Buffer (64 bytes).
+    */
+    bool isAligned (int alignment = 64) const
+    {
+        for (int c = 0; c < chans; ++c)
+            if (reinterpret_cast<uintptr_t> (fpp[c]) % static_cast<uintptr_t> (alignment) != 0)
+                return false;
+        return true;
+    }
+
     //==============================================================================
 
     class ChannelIterator
@@ -189,9 +203,8 @@ public:
 
     void operator*= (float mult)
     {
-        for (auto chan : *this)
-            for (auto& samp : chan)
-                samp *= mult;
+        for (int c = 0; c < chans; ++c)
+            vectorScale (fpp[c], mult, samps);
     }
 
     float** getRawArray() { return fpp; }
@@ -207,53 +220,78 @@ private:
 */
 BufferView makeBufferView (juce::AudioBuffer<float>& juceBuffer);
 
+class Buffer;
+BufferView makeBufferView (Buffer& buffer);
+
 void coutBuffer (const BufferView& buffer);
 
 //==============================================================================
-/** Simple audio buffer based on juce::AudioBuffer<T>
+/** Simple audio buffer with SIMD friendly storage.
+
+    Every channel starts on a 64 byte boundary and is zero padded up to a
+    multiple of 16 floats (one AVX-512 register), so vectorised code can use
+    aligned loads and run to getNumPaddedSamples() without a scalar tail.
+    Copies are deep, moves just take the storage.
 
     @example Buffer b {2, 512, 44100};
              float** rawBuff = b.getWriteArray();
-             
+             gsl::span<float> left = b.channel (0);
+
     @see juce::AudioBuffer<T>
 */
 class Buffer
 {
 public:
+    static const int alignmentBytes = 64;
+    static const int paddingSamples = 16;
+
     Buffer (int numChannels = 1, int numSamples = 1, int samplingRate = 44100);
     ~Buffer() {}
 
+    Buffer (const Buffer& other);
+    Buffer& operator= (const Buffer& other);
+    Buffer (Buffer&& other) noexcept;
+    Buffer& operator= (Buffer&& other) noexcept;
+
     void clearAndResize (int numChannels, int numSamples);
     void clearAndResize (int numChannels, int numSamples, int samplingRate);
 
-    int getNumChannels() const { return bufferData.getNumChannels(); }
-    int getNumSamples()  const { return bufferData.getNumSamples();  }
-    int getSampleRate()  const { return sampleRate; }
+    int getNumChannels()       const { return chans; }
+    int getNumSamples()        const { return samps; }
+    int getNumPaddedSamples()  const { return stride; }    // multiple of paddingSamples
+    int getSampleRate()        const { return sampleRate; }
 
-    const float** getReadArray() const { return bufferData.getArrayOfReadPointers();  }
-          float** getWriteArray()      { return bufferData.getArrayOfWritePointers(); }
+    const float** getReadArray() const { return const_cast<const float**> (channels.data()); }
+          float** getWriteArray()      { return channels.data(); }
 
-    void clear() { bufferData.clear(); }
-    void fillAllOnes();                                                     
-    void fillAscending();
-
-    void copyFrom (const Buffer& source)
+    gsl::span<float> channel (int c)
+    {
+        Expects (0 <= c && c < chans);
+        return gsl::span<float> {channels[c], static_cast<size_t> (samps)};
+    }
+    gsl::span<const float> channel (int c) const
     {
-        jassert (source.getNumChannels() <= getNumChannels());
-        jassert (source.getNumSamples() <= getNumSamples());
+        Expects (0 <= c && c < chans);
+        return gsl::span<const float> {channels[c], static_cast<size_t> (samps)};
+    }
 
-        clear();
+    void clear();
+    void fillAllOnes();                                                     
+    void fillAscending();
 
-        for (int c = 0; c < source.getNumChannels(); ++c)
-            for (int s = 0; s < source.getNumSamples(); ++s)
-                getWriteArray()[c][s] = source.getReadArray()[c][s];
-    }
+    void copyFrom (const Buffer& source);   // clears, then copies source into the start of this
 
     Buffer& operator*= (float scale);
 
 private:
+    void allocate (int numChannels, int numSamples);
+
     int sampleRate;
-    juce::AudioBuffer<float> bufferData;
+    int chans  {0};
+    int samps  {0};
+    int stride {0};                     // samps rounded up to paddingSamples
+    std::vector<float>  storage;        // chans * stride, plus slack for alignment
+    std::vector<float*> channels;       // into storage, each alignmentBytes aligned
 };
 
 //==============================================================================
@@ -32,6 +32,7 @@
 
 #include "Buffer.h"
 #include "Utility.h"
+#include "Memory.h"
 #include "Dependencies/WDL/convoengine.h"
 
 
@@ -188,6 +189,7 @@ private:
                 engine.set (ir);
                 
                 engine.reset (sampleRate);  // put in prepareToPlay()
+                engine.prepare (numChannels, samplesPerBlock);
                 
                                             // put in processBlock()
                 engine.process (buffer.getArrayOfWritePointers(),
@@ -195,9 +197,11 @@ private:
                                 buffer.getNumSamples());
     
     Notes: 
-    - Max 4 channels!!!
-    - If impulse has same data in all channels, WDL treats signal as mono and
-      won't work > 2 channels. Watch for this!
+    - Max 4 channels!!! See ado::MultichannelConvolution for more.
+    - If impulse has same data in all channels, WDL treats it as mono (and
+      convolves every channel with it).
+    - Without prepare(), WDL allocates its histories on the first process()
+      call, i.e. on the audio thread.
 
 */
 class Convolution
@@ -213,21 +217,185 @@ public:
 
     void set (const ado::Buffer& impulse);
 
+    /** How the block's channels map onto the impulse's. */
+    enum class Topology
+    {
+        matched,        // each channel convolved with its own impulse channel
+        monoInput,      // only channel 0 is input, convolved with every impulse
+                        // channel (FFT'd once, no duplicated input or detection)
+        trueStereo      // 2 channels, 4 channel impulse [LL, LR, RL, RR]:
+    };                  // L = L*LL + R*RL, R = L*LR + R*RR, summed before the IFFT
+
+    /** Resets the engine, so set it up front (e.g. in prepareToPlay()). 
+        trueStereo falls back to matched unless the impulse has 4 channels
+        and the block 2.
+    */
+    void setTopology (Topology newTopology);
+    Topology getTopology() const noexcept { return topology; }
+
     void resampleIrOnRateChange (double sampleRate);
 
+    /** The impulse as resampleIrOnRateChange() makes it for a sample rate
+        (resampled & level matched). An engine built on the result at that
+        rate convolves identically, so callers with many engines at one rate
+        can share it instead of each resampling.
+    */
+    static ado::Buffer resampleImpulse (const ado::Buffer& impulse, double sampleRate);
+
+    /** Length of the zero latency direct form head (ado::vectorFir()), the
+        rest of the impulse is FFT'd in partitions from twice this up. With
+        autoHeadSize (the default) prepare() uses measureHeadSize() for its
+        channels & block size. Resets the engine if the size changes.
+    */
+    static constexpr int autoHeadSize {0};
+    void setHeadSize (int numSamples);
+    int getHeadSize() const noexcept { return eng.GetBruteSize(); }   // in use
+
+    /** Times the head sizes 32-512 on a synthetic impulse at this channel
+        count & block size, returns the fastest. Takes a few ms, only measured
+        once per process for each combination.
+    */
+    static int measureHeadSize (int numChannels, int blockSize);
+
+    /** Largest FFT for the impulse's last partitions, a power of two from 32768
+        (the default) to 262144. Bigger means fewer partitions and less
+        multiply-accumulate for very long impulses, but a bigger FFT in the
+        block each one's due: for offline rendering, or with latency to spare.
+        Only pays once the impulse is many partitions long (20s at 96kHz ran
+        2x faster at 131072, 6s no faster). Resets the engine.
+    */
+    static constexpr int defaultMaxFftSize {32768};
+    void setMaxFftSize (int size);
+    int getMaxFftSize() const noexcept { return maxFftSize; }
+
+    /** FFT blocks in each partition after the head, 1-16. 1 doubles the FFT
+        size every partition, more holds each size longer (WDL's plan is 3).
+        Which is fastest depends on the CPU & impulse, see ado::PartitionTuner.
+        Resets the engine if it changes.
+    */
+    static constexpr int defaultSegmentBlocks {WDL_CONVO_DEFAULT_SEGMENT_BLOCKS};
+    void setSegmentBlocks (int blocks);
+    int getSegmentBlocks() const noexcept { return eng.GetSegmentBlocks(); }
+
+    /** Spreads the FFT partitions' work evenly over blocks, for when the worst
+        block matters more than the mean. Unbalanced, each partition runs in
+        the block its input completes, and every so often several complete in
+        the same block. Balanced, the partitions after the first are half the
+        size so each has a block to spare, and each block runs what's due plus
+        the work waiting longest, up to the average. The mean goes up (those
+        partitions do twice the multiply-accumulates), the worst block comes
+        down. Off by default. Resets the engine if it changes.
+    */
+    void setLoadBalancing (bool shouldBalance);
+    bool getLoadBalancing() const noexcept { return eng.GetLoadBalance(); }
+
+    /** The partitions' work per block since resetAccounting(), estimated not
+        timed: how many ran, and their cost in ~flops. See
+        WDL_ConvolutionAccounting.
+    */
+    using Accounting = WDL_ConvolutionAccounting;
+    const Accounting& getAccounting() const noexcept { return eng.GetAccounting(); }
+    void resetAccounting() noexcept { eng.ResetAccounting(); }
+
+    /** FFT implementations for the partitions, in order of preference: each
+        partition runs the first that supports its size, WDL's own otherwise.
+        Not owned, they must outlive the engine. See WDL_ConvolutionFFTBackend
+        for what one has to provide. Resets the engine.
+    */
+    using FftBackend = WDL_ConvolutionFFTBackend;
+    void setFftBackends (std::vector<FftBackend*> preferred);
+    const std::vector<FftBackend*>& getFftBackends() const noexcept { return fftBackends; }
+
+    /** Runs the engine at a fixed power of two quantum whatever blocks the host
+        sends (480, 441, 1000, blocks split around automation), so the FFT
+        partitions are scheduled evenly and every quantum costs the same.
+        - off:          the engine follows the host's blocks (the default)
+        - fixedLatency: the whole impulse in partitions from the quantum up, the
+                        output a quantum late, see getLatencySamples()
+        - zeroLatency:  the first quantum of the impulse runs on the host's
+                        blocks as before, the rest on quanta (it's a quantum
+                        late anyway, so nothing is added)
+        Reblocking needs prepare(). In fixedLatency the mixing process() delays
+        the dry signal to match.
+    */
+    enum class Reblocking { off, fixedLatency, zeroLatency };
+    void setReblocking (Reblocking newMode, int quantumSamples = 512);
+    Reblocking getReblocking() const noexcept { return reblocking; }
+    int getLatencySamples() const noexcept { return reblocking == Reblocking::fixedLatency ? reblockQuantum : 0; }
+
+    /** Allocate and prefault everything the engine needs for this layout now,
+        rather than on the audio thread. Repeated automatically by set().
+        Without reblocking, a max block size that isn't a power of two but is
+        made of 2s, 3s & 5s (480, 960, 1440) gets mixed radix FFT partitions
+        that line up with it.
+    */
+    void prepare (int numChannels, int maxBlockSize);
+
+    /** Whether prepare() lines the partitions up with this block size, if not
+        it's one to reblock.
+    */
+    static bool partitionsMatchBlockSize (int blockSize);
+
+    /** Also page-lock the impulse spectra & histories when prepared. Takes
+        effect on the next prepare()/set().
+    */
+    void setMemoryLocking (bool shouldLock) noexcept { shouldLockMemory = shouldLock; }
+    const MemoryLockReport& getMemoryLockReport() const noexcept { return locker.getReport(); }
+
     void process (ado::Buffer& block);
     void process (float** block, int blockNumChannels, int blockNumSamples);
 
+    /** Wet & dry gains for the mixing process() */
+    struct MixGains
+    {
+        float wet;
+        float dry;
+    };
+
+    /** Convolve in place and mix with the dry input in the same pass:
+        block = wet * convolved + dry * block, each gain ramped linearly from 
+        'from' to 'to' across the block. No dry copy needed, the engine already
+        has the input. All-wet skips the dry reads, all-dry skips the wet output
+        (the engine still runs so the tail is right when the mix comes back).
+        With Topology::monoInput channel 0 is the dry signal for every channel.
+        The wet signal goes through a scratch buffer sized by prepare(), blocks
+        bigger than that are mixed in chunks.
+    */
+    void process (float** block, int blockNumChannels, int blockNumSamples,
+                  MixGains from, MixGains to);
+
 private:
     void convolve (float** block, int blockNumChannels, int blockNumSamples);
+    void reblock (float** block, int blockNumChannels, int blockNumSamples);
+    void loadImpulse();
+    void prepareEngine();
+    void applyHeadSize (int numSamples);
 
     double lastSampleRate;
+    int preparedNumChannels {0};
+    int preparedMaxBlockSize {0};
+    bool shouldLockMemory {false};
+    Topology topology {Topology::matched};
+    int headSize {autoHeadSize};
+    int maxFftSize {defaultMaxFftSize};
+    std::vector<FftBackend*> fftBackends;
+    Reblocking reblocking {Reblocking::off};
+    int reblockQuantum {512};
+    int reblockFill {0};                            // samples into the current quantum
+    bool hasTail {false};                           // zeroLatency impulse longer than a quantum
 
     const ado::Buffer& irOriginal;
           ado::Buffer  irResampled {1, 1};
 
     WDL_ImpulseBuffer imp;
     WDL_ConvolutionEngine_Div eng;
+    WDL_ConvolutionEngine_Div tailEng;              // zeroLatency reblocking, the impulse after a quantum
+    MemoryLocker locker;
+
+    ado::Buffer wetScratch {WDL_CONVO_MAX_PROC_NCH, 1024};   // engine output for the mixing process()
+    ado::Buffer dryScratch {WDL_CONVO_MAX_PROC_NCH, 1024};   // fixedLatency reblocking's delayed dry input
+    ado::Buffer reblockIn  {1, 1};                           // input gathered for the next quantum
+    ado::Buffer reblockOut {1, 1};                           // last quantum's output, being handed out
 };
 
 } // namespace
@@ -26,6 +26,7 @@
 #include <stdlib.h>
 #include <memory.h>
 #include "convoengine.h"
+#include "../../Kernels.h" // JF: ado::vectorFir() for the brute head
 
 #include "denormal.h"
 
@@ -220,7 +221,88 @@ static void WDL_CONVO_CplxMul3(WDL_FFT_COMPLEX *c, const WDL_FFT_COMPLEX *a, con
 }
 #endif // WDL_CONVO_SSE
 
-static bool CompareQueueToBuf(WDL_FastQueue *q, const void *data, int len)
+// JF: dest += src, for summing the _Div sub-engines' outputs
+static void WDL_CONVO_Accumulate(WDL_FFT_REAL *dest, const WDL_FFT_REAL *src, int n)
+{
+#if defined(WDL_CONVO_SSE) || defined(WDL_CONVO_SSE3)
+  while (n >= 4)
+  {
+    _mm_storeu_ps(dest,_mm_add_ps(_mm_loadu_ps(dest),_mm_loadu_ps(src)));
+    dest+=4;
+    src+=4;
+    n-=4;
+  }
+#endif
+  while (n-- > 0) *dest++ += *src++;
+}
+
+// JF: direct convolution of len samples at psrc (with imp_len-1 samples of history before it), factored out
+// of WDL_ConvolutionEngine::Add() so it can also run on the shared input ring. add sums into pout.
+// With float samples & impulse it's ado::vectorFir() (SSE2/AVX2+FMA/AVX-512 picked at runtime).
+static void WDL_CONVO_Brute(const WDL_CONVO_IMPULSEBUFf *imp, int imp_len, const WDL_FFT_REAL *psrc, WDL_FFT_REAL *pout, int len, bool add)
+{
+#if WDL_FFT_REALSIZE == 4 && !defined(WDL_CONVO_WANT_FULLPRECISION_IMPULSE_STORAGE)
+  ado::vectorFir(imp,imp_len,psrc-imp_len+1,pout,len,add);
+#else
+  int x;
+  int len1 = len&~1;
+  for (x=0; x < len1 ; x += 2)
+  {
+    int i=imp_len;
+    double sum=0.0,sum2=0.0;
+    const WDL_FFT_REAL *sp=psrc+x-imp_len + 1;
+    const WDL_CONVO_IMPULSEBUFf *ip=imp;
+    int j=i/4; i&=3;
+    while (j--) // produce 2 samples, 4 impulse samples at a time
+    {
+      double a = ip[0],b=ip[1],aa=ip[2],bb=ip[3];
+      double c = sp[1],d=sp[2],cc=sp[3];
+      sum+=a * sp[0] + b * c + aa * d + bb * cc;
+      sum2+=a * c + b * d + aa * cc + bb * sp[4];
+      ip+=4;
+      sp+=4;
+    }
+
+    while (i--)
+    {
+      double a = *ip++;
+      sum+=a * sp[0];
+      sum2+=a * sp[1];
+      sp++;
+    }
+    if (add)
+    {
+      pout[x]+=(WDL_FFT_REAL) sum;
+      pout[x+1]+=(WDL_FFT_REAL) sum2;
+    }
+    else
+    {
+      pout[x]=(WDL_FFT_REAL) sum;
+      pout[x+1]=(WDL_FFT_REAL) sum2;
+    }
+  }
+  for(;x<len;x++) // any odd samples left
+  {
+    int i=imp_len;
+    double sum=0.0;
+    const WDL_FFT_REAL *sp=psrc+x-imp_len + 1;
+    const WDL_CONVO_IMPULSEBUFf *ip=imp;
+    int j=i/4; i&=3;
+    while (j--)
+    {
+      sum+=ip[0] * sp[0] + ip[1] * sp[1] + ip[2] * sp[2] + ip[3] * sp[3];
+      ip+=4;
+      sp+=4;
+    }
+
+    while (i--) sum+=*ip++ * *sp++;
+    if (add) pout[x]+=(WDL_FFT_REAL) sum;
+    else pout[x]=(WDL_FFT_REAL) sum;
+  }
+#endif
+}
+
+static bool CompareQueueToBuf(const WDL_FastQueue *q, const void *data, int len)
 {
   int offs=0;
   while (len>0)
@@ -248,13 +330,221 @@ static bool CompareQueueToBuf(WDL_FastQueue *q, const void *data, int len)
 }
 
 
+void WDL_ConvolutionInputRing::Resize(int size, int nch)
+{
+  int sz=1;
+  while (sz < size) sz*=2;
+  if (nch>WDL_CONVO_MAX_PROC_NCH) nch=WDL_CONVO_MAX_PROC_NCH;
+
+  int x;
+  for (x = 0; x < WDL_CONVO_MAX_PROC_NCH; x ++) m_buf[x].Resize(x<nch ? sz*2 : 0);
+  m_size=sz;
+  m_nch=nch;
+  Clear(0);
+}
+
+void WDL_ConvolutionInputRing::Grow(int size, int nch, WDL_INT64 keepfrom)
+{
+  if (nch>WDL_CONVO_MAX_PROC_NCH) nch=WDL_CONVO_MAX_PROC_NCH;
+  if (size<=m_size && nch<=m_nch) return;
+  if (size<m_size) size=m_size;
+
+  int keep=(int)(m_wpos-keepfrom);
+  if (keep>m_size) keep=m_size;
+  if (keep<0) keep=0;
+
+  WDL_TypedBuf<WDL_FFT_REAL> tmp;
+  WDL_FFT_REAL *t=tmp.Resize(keep*m_nch);
+  int x;
+  for (x = 0; x < m_nch; x ++) memcpy(t+x*keep,Get(x,m_wpos-keep),keep*sizeof(WDL_FFT_REAL));
+
+  const int oldnch=m_nch;
+  const WDL_INT64 wpos=m_wpos;
+  Resize(size,nch);
+  m_wpos=wpos;
+  for (x = 0; x < oldnch && x < m_nch; x ++) Write(x,wpos-keep,t+x*keep,keep);
+}
+
+void WDL_ConvolutionInputRing::Clear(int prefill)
+{
+  int x;
+  for (x = 0; x < m_nch; x ++) memset(m_buf[x].Get(),0,m_buf[x].GetSize()*sizeof(WDL_FFT_REAL));
+  m_wpos=prefill;
+}
+
+void WDL_ConvolutionInputRing::Add(WDL_FFT_REAL **bufs, int len, int nch)
+{
+  int x;
+  for (x = 0; x < nch && x < m_nch; x ++) Write(x,m_wpos,bufs ? bufs[x] : NULL,len);
+  m_wpos+=len;
+}
+
+void WDL_ConvolutionInputRing::Write(int ch, WDL_INT64 pos, const WDL_FFT_REAL *src, int len)
+{
+  WDL_FFT_REAL *buf=m_buf[ch].Get();
+  int p=(int)(pos&(m_size-1));
+  while (len>0)
+  {
+    int n=m_size-p;
+    if (n>len) n=len;
+    if (src)
+    {
+      memcpy(buf+p,src,n*sizeof(WDL_FFT_REAL));
+      memcpy(buf+p+m_size,src,n*sizeof(WDL_FFT_REAL));
+      src+=n;
+    }
+    else
+    {
+      memset(buf+p,0,n*sizeof(WDL_FFT_REAL));
+      memset(buf+p+m_size,0,n*sizeof(WDL_FFT_REAL));
+    }
+    len-=n;
+    p=0;
+  }
+}
+
+void WDL_ConvolutionInputRing::EnumBuffers(void (*func)(void *ctx, void *buf, int bytes), void *ctx)
+{
+  int x;
+  for (x = 0; x < m_nch; x ++)
+  {
+    if (m_buf[x].GetSize()) func(ctx,m_buf[x].Get(),m_buf[x].GetSize()*(int)sizeof(WDL_FFT_REAL));
+  }
+}
+
+
+void WDL_ConvolutionOutputRing::Resize(int size, int nch)
+{
+  int sz=1;
+  while (sz < size) sz*=2;
+  if (nch>WDL_CONVO_MAX_PROC_NCH) nch=WDL_CONVO_MAX_PROC_NCH;
+
+  int x;
+  for (x = 0; x < WDL_CONVO_MAX_PROC_NCH; x ++) m_buf[x].Resize(x<nch ? sz : 0);
+  m_size=sz;
+  m_nch=nch;
+  Clear();
+}
+
+void WDL_ConvolutionOutputRing::Grow(int size)
+{
+  if (size<=m_size) return;
+
+  const int oldsize=m_size;
+  WDL_TypedBuf<WDL_FFT_REAL> tmp;
+  WDL_FFT_REAL *t=tmp.Resize(oldsize*m_nch);
+  int x;
+  for (x = 0; x < m_nch; x ++) // unwrapped, from the read position
+  {
+    const int p=(int)(m_rpos&(oldsize-1));
+    memcpy(t+x*oldsize,m_buf[x].Get()+p,(oldsize-p)*sizeof(WDL_FFT_REAL));
+    memcpy(t+x*oldsize+oldsize-p,m_buf[x].Get(),p*sizeof(WDL_FFT_REAL));
+  }
+
+  const WDL_INT64 rpos=m_rpos;
+  Resize(size,m_nch);
+  m_rpos=rpos;
+  for (x = 0; x < m_nch; x ++) Accumulate(x,rpos,t+x*oldsize,oldsize);
+}
+
+void WDL_ConvolutionOutputRing::Clear()
+{
+  int x;
+  for (x = 0; x < m_nch; x ++) memset(m_buf[x].Get(),0,m_buf[x].GetSize()*sizeof(WDL_FFT_REAL));
+  m_rpos=0;
+}
+
+void WDL_ConvolutionOutputRing::Accumulate(int ch, WDL_INT64 pos, const WDL_FFT_REAL *src, int len)
+{
+  if (!src || ch>=m_nch) return;
+  while (len>0)
+  {
+    int n=len;
+    WDL_FFT_REAL *buf=GetSpan(ch,pos,&n);
+    WDL_CONVO_Accumulate(buf,src,n);
+    src+=n;
+    pos+=n;
+    len-=n;
+  }
+}
+
+WDL_FFT_REAL *WDL_ConvolutionOutputRing::GetSpan(int ch, WDL_INT64 pos, int *len)
+{
+  const int p=(int)(pos&(m_size-1));
+  if (*len>m_size-p) *len=m_size-p;
+  return m_buf[ch].Get()+p;
+}
+
+void WDL_ConvolutionOutputRing::Read(WDL_FFT_REAL **dest, int nch, int len)
+{
+  int x;
+  for (x = 0; x < nch || x < m_nch; x ++)
+  {
+    WDL_FFT_REAL *d=x<nch ? dest[x] : NULL;
+    WDL_INT64 pos=m_rpos;
+    int left=len;
+    while (left>0)
+    {
+      int n=left;
+      if (x<m_nch)
+      {
+        WDL_FFT_REAL *buf=GetSpan(x,pos,&n);
+        if (d) memcpy(d,buf,n*sizeof(WDL_FFT_REAL));
+        memset(buf,0,n*sizeof(WDL_FFT_REAL));
+      }
+      else memset(d,0,n*sizeof(WDL_FFT_REAL));
+      if (d) d+=n;
+      pos+=n;
+      left-=n;
+    }
+  }
+  m_rpos+=len;
+}
+
+void WDL_ConvolutionOutputRing::EnumBuffers(void (*func)(void *ctx, void *buf, int bytes), void *ctx)
+{
+  int x;
+  for (x = 0; x < m_nch; x ++)
+  {
+    if (m_buf[x].GetSize()) func(ctx,m_buf[x].Get(),m_buf[x].GetSize()*(int)sizeof(WDL_FFT_REAL));
+  }
+}
+
+
+// JF: see WDL_ConvolutionFFTBackend
+class WDL_ConvolutionFFT_WDL : public WDL_ConvolutionFFTBackend
+{
+public:
+  const char *GetName() const { return "WDL"; }
+  bool SupportsSize(int len) const { return !!WDL_fft_size_supported(len); }
+  bool PrepareSize(int len) { return !!WDL_fft_init_size(len); }
+  void FFT(WDL_FFT_COMPLEX *buf, int len, int isInverse) { WDL_fft(buf,len,isInverse); }
+};
+
+WDL_ConvolutionFFTBackend *WDL_ConvolutionFFTBackend::GetDefault()
+{
+  static WDL_ConvolutionFFT_WDL fft; // stateless, WDL_fft_init() has its own once guard
+  return &fft;
+}
+
+
 WDL_ConvolutionEngine::WDL_ConvolutionEngine()
 {
   WDL_fft_init();
+  m_fft_pref=NULL;
+  m_fft=WDL_ConvolutionFFTBackend::GetDefault();
+  m_block_limit=0;
+  m_zl_fftcnt=0;
   m_impulse_nch=1;
   m_fft_size=0;
   m_impulse_len=0;
   m_proc_nch=0;
+  m_inring=NULL;
+  m_inring_mono=false;
+  m_zl_truestereo=false;
+  memset(m_inring_pos,0,sizeof(m_inring_pos));
+  m_outring=NULL;
+  memset(m_outring_pos,0,sizeof(m_outring_pos));
 }
 
 WDL_ConvolutionEngine::~WDL_ConvolutionEngine()
@@ -274,7 +564,7 @@ int WDL_ConvolutionEngine::SetImpulse(WDL_ImpulseBuffer *impulse, int fft_size,
   }
   m_impulse_nch=nch;
 
-  if (m_impulse_nch>1) // detect mono signals pretending to be multichannel
+  if (m_impulse_nch>1 && !m_zl_truestereo) // detect mono signals pretending to be multichannel
   {
     for (x = 1; x < m_impulse_nch; x ++)
     {
@@ -325,6 +615,12 @@ int WDL_ConvolutionEngine::SetImpulse(WDL_ImpulseBuffer *impulse, int fft_size,
     while (fft_size < impulse_len*2 && fft_size < msz) fft_size*=2;
   }
 
+  m_fft=m_fft_pref; // JF: see SetFFTBackend()
+  if (!m_fft || !m_fft->PrepareSize(fft_size))
+  {
+    m_fft=WDL_ConvolutionFFTBackend::GetDefault();
+    m_fft->PrepareSize(fft_size); // mixed radix twiddles, see WDL_ConvolutionEngine_Div::SetImpulse()
+  }
   m_fft_size=fft_size;
 
   int impchunksize=fft_size/2;
@@ -387,7 +683,7 @@ int WDL_ConvolutionEngine::SetImpulse(WDL_ImpulseBuffer *impulse, int fft_size,
       if (mv>CONVOENGINE_IMPULSE_SILENCE_THRESH||mv2>CONVOENGINE_IMPULSE_SILENCE_THRESH)
       {
         *zbuf++=mv>CONVOENGINE_IMPULSE_SILENCE_THRESH ? 2 : 1; // 1 means only second channel has content
-        WDL_fft((WDL_FFT_COMPLEX*)impout,fft_size,0);
+        m_fft->FFT((WDL_FFT_COMPLEX*)impout,fft_size,0);
 
         if (smallerSizeMode)
         {
@@ -421,6 +717,12 @@ void WDL_ConvolutionEngine::Reset() // clears out any latent samples
 
 void WDL_ConvolutionEngine::Add(WDL_FFT_REAL **bufs, int len, int nch)
 {
+  if (m_inring) // JF: input is already in the shared ring
+  {
+    AddFromRing(nch);
+    return;
+  }
+
   if (m_fft_size<1)
   {
     int ch;
@@ -428,7 +730,7 @@ void WDL_ConvolutionEngine::Add(WDL_FFT_REAL **bufs, int len, int nch)
     for (ch = 0; ch < nch; ch ++)
     {
       int wch=ch;
-      if (wch >=m_impulse_nch) wch-=m_impulse_nch;
+      if (wch >=m_impulse_nch) wch%=m_impulse_nch; // JF: was -=, wrong for more than 2x the impulse channels
       WDL_CONVO_IMPULSEBUFf *imp=m_impulse[wch].WDL_CONVO_GETALIGNED();
       int imp_len = m_impulse[wch].GetSize()-(WDL_CONVO_ALIGN-1);
 
@@ -451,52 +753,7 @@ void WDL_ConvolutionEngine::Add(WDL_FFT_REAL **bufs, int len, int nch)
         }
 
         WDL_FFT_REAL *pout=(WDL_FFT_REAL*)m_samplesout[ch].Add(NULL,len*sizeof(WDL_FFT_REAL));
-        int x;
-        int len1 = len&~1;
-        for (x=0; x < len1 ; x += 2)
-        {
-          int i=imp_len;
-          double sum=0.0,sum2=0.0;
-          WDL_FFT_REAL *sp=psrc+x-imp_len + 1;
-          WDL_CONVO_IMPULSEBUFf *ip=imp;
-          int j=i/4; i&=3;
-          while (j--) // produce 2 samples, 4 impulse samples at a time
-          {
-            double a = ip[0],b=ip[1],aa=ip[2],bb=ip[3];
-            double c = sp[1],d=sp[2],cc=sp[3];
-            sum+=a * sp[0] + b * c + aa * d + bb * cc;
-            sum2+=a * c + b * d + aa * cc + bb * sp[4];
-            ip+=4;
-            sp+=4;
-          }
-
-          while (i--)
-          {
-            double a = *ip++;
-            sum+=a * sp[0];
-            sum2+=a * sp[1];
-            sp++;
-          }
-          pout[x]=(WDL_FFT_REAL) sum;
-          pout[x+1]=(WDL_FFT_REAL) sum2;
-        }
-        for(;x<len;x++) // any odd samples left
-        {
-          int i=imp_len;
-          double sum=0.0;
-          WDL_FFT_REAL *sp=psrc+x-imp_len + 1;
-          WDL_CONVO_IMPULSEBUFf *ip=imp;
-          int j=i/4; i&=3;
-          while (j--)
-          {
-            sum+=ip[0] * sp[0] + ip[1] * sp[1] + ip[2] * sp[2] + ip[3] * sp[3];
-            ip+=4;
-            sp+=4;
-          }
-
-          while (i--) sum+=*ip++ * *sp++;
-          pout[x]=(WDL_FFT_REAL) sum;
-        }
+        WDL_CONVO_Brute(imp,imp_len,psrc,pout,len,false);
         m_samplesin2[ch].Advance(len*sizeof(WDL_FFT_REAL));
         m_samplesin2[ch].Compact();
       }
@@ -517,73 +774,333 @@ void WDL_ConvolutionEngine::Add(WDL_FFT_REAL **bufs, int len, int nch)
   int impchunksize=m_fft_size/2;
   int nblocks=(m_impulse_len+impchunksize-1)/impchunksize;
 
-  if (m_proc_nch != nch)
+  if (m_proc_nch != nch) SetProcChannels(nch);
+
+  int ch;
+  if (m_impulse_len<1||!nblocks) 
   {
-    m_proc_nch=nch;
-    memset(m_hist_pos,0,sizeof(m_hist_pos));
-    int x;
-    int mso=0;
-    for (x = 0; x < WDL_CONVO_MAX_PROC_NCH; x ++)
+    for (ch = 0; ch < nch; ch ++)
     {
-      int so=m_samplesin[x].Available() + m_samplesout[x].Available();
-      if (so>mso) mso=so;
+      if (bufs && bufs[ch])
+        m_samplesout[ch].Add(bufs[ch],len*sizeof(WDL_FFT_REAL));
+      else
+        memset(m_samplesout[ch].Add(NULL,len*sizeof(WDL_FFT_REAL)),0,len*sizeof(WDL_FFT_REAL));
+    }
+    // pass through
+    return;
+  }
+
+  for (ch = 0; ch < nch; ch ++)
+  {
+    if (m_samplehist[ch].GetSize()<WDL_CONVO_ALIGN || !m_overlaphist[ch].GetSize()) continue;
+
+    m_samplesin[ch].Add(bufs ? bufs[ch] : NULL,len*sizeof(WDL_FFT_REAL));
+
+  }
+}
+
+void WDL_ConvolutionEngine::SetProcChannels(int nch)
+{
+  int impchunksize=m_fft_size/2;
+  int nblocks=(m_impulse_len+impchunksize-1)/impchunksize;
+
+  int x;
+  if (m_inring) for (x = m_proc_nch>0 ? m_proc_nch : 1; x < nch; x ++) m_inring_pos[x]=m_inring_pos[0];
+  if (m_outring) for (x = m_proc_nch>0 ? m_proc_nch : 1; x < nch; x ++) m_outring_pos[x]=m_outring_pos[0];
+
+  m_proc_nch=nch;
+  memset(m_hist_pos,0,sizeof(m_hist_pos));
+  int mso=0;
+  for (x = 0; x < WDL_CONVO_MAX_PROC_NCH; x ++)
+  {
+    int so=m_samplesin[x].Available() + m_samplesout[x].Available();
+    if (so>mso) mso=so;
 
-      if (x>=nch)
+    if (x>=nch)
+    {
+      m_samplesin[x].Clear();
+      m_samplesout[x].Clear();
+    }
+    else 
+    {
+      if (m_impulse_len<1||!nblocks) 
       {
-        m_samplesin[x].Clear();
-        m_samplesout[x].Clear();
+        if (m_samplesin[x].Available())
+        {
+          int s=m_samplesin[x].Available();
+          void *buf=m_samplesout[x].Add(NULL,s);
+          m_samplesin[x].GetToBuf(0,buf,s);
+          m_samplesin[x].Clear();
+        }
       }
-      else 
+
+      if (so < mso)
       {
-        if (m_impulse_len<1||!nblocks) 
+        memset(m_samplesout[x].Add(NULL,mso-so),0,mso-so);
+      }
+    }
+    
+    int sz=0;
+    if (x<nch) sz=nblocks*m_fft_size;
+
+    memset(m_samplehist_zflag[x].Resize(nblocks),0,nblocks);
+    m_samplehist[x].Resize(sz>0 ? sz*2+WDL_CONVO_ALIGN-1 : 0);
+    m_overlaphist[x].Resize(x<nch ? m_fft_size/2 : 0);
+    memset(m_samplehist[x].Get(),0,m_samplehist[x].GetSize()*sizeof(WDL_FFT_REAL));
+    memset(m_overlaphist[x].Get(),0,m_overlaphist[x].GetSize()*sizeof(WDL_FFT_REAL));
+  }
+}
+
+void WDL_ConvolutionEngine::AddFromRing(int nch)
+{
+  int ch;
+  if (m_fft_size<1)
+  {
+    for (ch = m_proc_nch>0 ? m_proc_nch : 1; ch < nch; ch ++)
+    {
+      m_inring_pos[ch]=m_inring_pos[0];
+      m_outring_pos[ch]=m_outring_pos[0];
+    }
+    m_proc_nch=nch;
+  }
+  else if (m_proc_nch != nch) SetProcChannels(nch);
+
+  if (m_fft_size<1 && IsTrueStereo())
+  {
+    const int len=InputAvailable(0);
+    int out;
+    for (out = 0; out < 2 && len>0; out ++)
+    {
+      int done=0;
+      while (done<len) // all of it, or each contiguous span of the output ring
+      {
+        int n=len-done;
+        WDL_FFT_REAL *pout;
+        if (m_outring) pout=m_outring->GetSpan(out,m_outring_pos[out]+done,&n);
+        else
         {
-          if (m_samplesin[x].Available())
-          {
-            int s=m_samplesin[x].Available();
-            void *buf=m_samplesout[x].Add(NULL,s);
-            m_samplesin[x].GetToBuf(0,buf,s);
-            m_samplesin[x].Clear();
-          }
+          pout=(WDL_FFT_REAL*)m_samplesout[out].Add(NULL,n*sizeof(WDL_FFT_REAL));
+          memset(pout,0,n*sizeof(WDL_FFT_REAL));
         }
-
-        if (so < mso)
+        for (ch = 0; ch < 2; ch ++) // L->out, R->out
         {
-          memset(m_samplesout[x].Add(NULL,mso-so),0,mso-so);
+          const int imp_len=m_impulse[ch*2+out].GetSize()-(WDL_CONVO_ALIGN-1);
+          if (imp_len>0)
+            WDL_CONVO_Brute(m_impulse[ch*2+out].WDL_CONVO_GETALIGNED(),imp_len,
+                            m_inring->Get(InputChannel(ch),m_inring_pos[ch]+done-(imp_len-1))+imp_len-1,pout,n,true);
         }
+        done+=n;
       }
-      
-      int sz=0;
-      if (x<nch) sz=nblocks*m_fft_size;
-
-      memset(m_samplehist_zflag[x].Resize(nblocks),0,nblocks);
-      m_samplehist[x].Resize(sz>0 ? sz*2+WDL_CONVO_ALIGN-1 : 0);
-      m_overlaphist[x].Resize(x<nch ? m_fft_size/2 : 0);
-      memset(m_samplehist[x].Get(),0,m_samplehist[x].GetSize()*sizeof(WDL_FFT_REAL));
-      memset(m_overlaphist[x].Get(),0,m_overlaphist[x].GetSize()*sizeof(WDL_FFT_REAL));
+      if (m_outring) m_outring_pos[out]+=len;
+    }
+    if (len>0)
+    {
+      InputAdvance(0,len);
+      InputAdvance(1,len);
     }
+    return;
   }
 
-  int ch;
-  if (m_impulse_len<1||!nblocks) 
+  const int impchunksize=m_fft_size/2;
+  const bool passthrough = m_fft_size>0 && (m_impulse_len<1 || !((m_impulse_len+impchunksize-1)/impchunksize));
+  if (m_fft_size>0 && !passthrough) return; // Avail() reads the ring
+
+  for (ch = 0; ch < nch; ch ++)
   {
-    for (ch = 0; ch < nch; ch ++)
+    const int len=InputAvailable(ch);
+    if (len<1) continue;
+
+    int imp_len=0;
+    WDL_CONVO_IMPULSEBUFf *imp=NULL;
+    if (!passthrough)
     {
-      if (bufs && bufs[ch])
-        m_samplesout[ch].Add(bufs[ch],len*sizeof(WDL_FFT_REAL));
+      int wch=ch;
+      if (wch >=m_impulse_nch) wch%=m_impulse_nch; // JF: was -=, wrong for more than 2x the impulse channels
+      imp=m_impulse[wch].WDL_CONVO_GETALIGNED();
+      imp_len = m_impulse[wch].GetSize()-(WDL_CONVO_ALIGN-1);
+    }
+
+    if (m_outring)
+    {
+      int done=0;
+      while (done<len) // each contiguous span of the output ring
+      {
+        int n=len-done;
+        WDL_FFT_REAL *pout=m_outring->GetSpan(ch,m_outring_pos[ch]+done,&n);
+        if (imp_len>0)
+          WDL_CONVO_Brute(imp,imp_len,m_inring->Get(InputChannel(ch),m_inring_pos[ch]+done-(imp_len-1))+imp_len-1,pout,n,true);
+        else
+          WDL_CONVO_Accumulate(pout,m_inring->Get(InputChannel(ch),m_inring_pos[ch]+done),n);
+        done+=n;
+      }
+      m_outring_pos[ch]+=len;
+    }
+    else
+    {
+      WDL_FFT_REAL *pout=(WDL_FFT_REAL*)m_samplesout[ch].Add(NULL,len*sizeof(WDL_FFT_REAL));
+      if (imp_len>0)
+        WDL_CONVO_Brute(imp,imp_len,m_inring->Get(InputChannel(ch),m_inring_pos[ch]-(imp_len-1))+imp_len-1,pout,len,false);
       else
-        memset(m_samplesout[ch].Add(NULL,len*sizeof(WDL_FFT_REAL)),0,len*sizeof(WDL_FFT_REAL));
+        memcpy(pout,m_inring->Get(InputChannel(ch),m_inring_pos[ch]),len*sizeof(WDL_FFT_REAL));
+    }
+
+    InputAdvance(ch,len);
+  }
+}
+
+void WDL_ConvolutionEngine::SetOutputRing(WDL_ConvolutionOutputRing *ring, WDL_INT64 pos)
+{
+  m_outring=ring;
+  int x;
+  for (x = 0; x < WDL_CONVO_MAX_PROC_NCH; x ++) m_outring_pos[x]=pos;
+}
+
+void WDL_ConvolutionEngine::Output(int ch, const WDL_FFT_REAL *buf, int len)
+{
+  if (m_outring)
+  {
+    m_outring->Accumulate(ch,m_outring_pos[ch],buf,len);
+    m_outring_pos[ch]+=len;
+  }
+  else m_samplesout[ch].Add(buf,len*sizeof(WDL_FFT_REAL));
+}
+
+void WDL_ConvolutionEngine::SetInputRing(WDL_ConvolutionInputRing *ring, WDL_INT64 pos, bool mono_input)
+{
+  m_inring=ring;
+  m_inring_mono=mono_input;
+  int x;
+  for (x = 0; x < WDL_CONVO_MAX_PROC_NCH; x ++) m_inring_pos[x]=pos;
+}
+
+WDL_INT64 WDL_ConvolutionEngine::GetInputRingPos() const
+{
+  WDL_INT64 pos=m_inring_pos[0];
+  int x;
+  for (x = 1; x < m_proc_nch; x ++) if (m_inring_pos[x]<pos) pos=m_inring_pos[x];
+  return pos-GetInputHistory();
+}
+
+int WDL_ConvolutionEngine::GetInputHistory() const
+{
+  int hist=0;
+  if (m_fft_size<1)
+  {
+    int x;
+    for (x = 0; x < m_impulse_nch; x ++)
+    {
+      const int imp_len=m_impulse[x].GetSize()-(WDL_CONVO_ALIGN-1);
+      if (imp_len-1 > hist) hist=imp_len-1;
+    }
+  }
+  return hist;
+}
+
+int WDL_ConvolutionEngine::InputAvailable(int ch) const
+{
+  if (m_inring) return (int)(m_inring->GetWritePos()-m_inring_pos[ch]);
+  return m_samplesin[ch].Available()/(int)sizeof(WDL_FFT_REAL);
+}
+
+void WDL_ConvolutionEngine::InputGetToBuf(int ch, WDL_FFT_REAL *buf, int len) const
+{
+  if (m_inring) memcpy(buf,m_inring->Get(InputChannel(ch),m_inring_pos[ch]),len*sizeof(WDL_FFT_REAL));
+  else m_samplesin[ch].GetToBuf(0,buf,len*sizeof(WDL_FFT_REAL));
+}
+
+void WDL_ConvolutionEngine::InputAdvance(int ch, int len)
+{
+  if (m_inring) m_inring_pos[ch]+=len;
+  else m_samplesin[ch].Advance(len*sizeof(WDL_FFT_REAL));
+}
+
+bool WDL_ConvolutionEngine::InputDiffers(int ch, const WDL_FFT_REAL *buf, int len) const
+{
+  if (!m_inring) return CompareQueueToBuf(&m_samplesin[ch],buf,len*sizeof(WDL_FFT_REAL));
+
+  if (InputAvailable(ch)<len) return true; // not enough data = not equal!
+  const WDL_FFT_REAL *in=m_inring->Get(InputChannel(ch),m_inring_pos[ch]);
+  while (len--)
+  {
+    if (fabs(*in-*buf)>CONVOENGINE_SILENCE_THRESH) return true;
+    in++;
+    buf++;
+  }
+  return false;
+}
+
+void WDL_ConvolutionEngine::Prepare(int nch, int maxblocklen)
+{
+  if (nch<1) return;
+  if (nch>WDL_CONVO_MAX_PROC_NCH) nch=WDL_CONVO_MAX_PROC_NCH;
+  if (maxblocklen<1) maxblocklen=1;
+
+  int x;
+  if (m_fft_size<1)
+  {
+    m_proc_nch=nch;
+    for (x = 0; x < WDL_CONVO_MAX_PROC_NCH; x ++)
+    {
+      m_samplesin2[x].Clear();
+      m_samplesout[x].Clear();
+      if (x>=nch) continue;
+
+      int wch=x;
+      if (wch >=m_impulse_nch) wch%=m_impulse_nch; // JF: was -=, wrong for more than 2x the impulse channels
+      const int imp_len = m_impulse[wch].GetSize() > 0 ? m_impulse[wch].GetSize()-(WDL_CONVO_ALIGN-1) : 0;
+
+      // queues only compact once over half consumed, hence the 2x
+      int sz=2*(imp_len+maxblocklen)*(int)sizeof(WDL_FFT_REAL);
+      if (!m_inring)
+      {
+        memset(m_samplesin2[x].Add(NULL,sz),0,sz);
+        m_samplesin2[x].Clear();
+      }
+      if (m_outring) continue;
+      sz=2*(maxblocklen+m_zl_delaypos)*(int)sizeof(WDL_FFT_REAL);
+      memset(m_samplesout[x].Add(NULL,sz),0,sz);
+      m_samplesout[x].Clear();
     }
-    // pass through
     return;
   }
 
-  for (ch = 0; ch < nch; ch ++)
+  if (m_proc_nch != nch) SetProcChannels(nch);
+  Reset();
+
+  m_combinebuf.Resize(m_fft_size*4+WDL_CONVO_ALIGN-1);
+  memset(m_combinebuf.Get(),0,m_combinebuf.GetSize()*sizeof(WDL_FFT_REAL));
+
+  for (x = 0; x < nch; x ++)
   {
-    if (m_samplehist[ch].GetSize()<WDL_CONVO_ALIGN || !m_overlaphist[ch].GetSize()) continue;
+    int sz=(m_fft_size+maxblocklen)*(int)sizeof(WDL_FFT_REAL);
+    if (!m_inring)
+    {
+      m_samplesin[x].Add(NULL,sz); // FastQueue zeroes, and keeps the block on Clear()
+      m_samplesin[x].Clear();
+    }
 
-    m_samplesin[ch].Add(bufs ? bufs[ch] : NULL,len*sizeof(WDL_FFT_REAL));
+    if (m_outring) continue;
+    sz=2*(m_fft_size+maxblocklen+m_zl_delaypos)*(int)sizeof(WDL_FFT_REAL);
+    memset(m_samplesout[x].Add(NULL,sz),0,sz);
+    m_samplesout[x].Clear();
+  }
+}
 
+void WDL_ConvolutionEngine::EnumBuffers(void (*func)(void *ctx, void *buf, int bytes), void *ctx)
+{
+  int x;
+  for (x = 0; x < WDL_CONVO_MAX_IMPULSE_NCH; x ++)
+  {
+    if (m_impulse[x].GetSize()) func(ctx,m_impulse[x].Get(),m_impulse[x].GetSize()*(int)sizeof(WDL_CONVO_IMPULSEBUFf));
+    if (m_impulse_zflag[x].GetSize()) func(ctx,m_impulse_zflag[x].Get(),m_impulse_zflag[x].GetSize());
+    if (m_samplehist_zflag[x].GetSize()) func(ctx,m_samplehist_zflag[x].Get(),m_samplehist_zflag[x].GetSize());
+  }
+  for (x = 0; x < WDL_CONVO_MAX_PROC_NCH; x ++)
+  {
+    if (m_samplehist[x].GetSize()) func(ctx,m_samplehist[x].Get(),m_samplehist[x].GetSize()*(int)sizeof(WDL_FFT_REAL));
+    if (m_overlaphist[x].GetSize()) func(ctx,m_overlaphist[x].Get(),m_overlaphist[x].GetSize()*(int)sizeof(WDL_FFT_REAL));
   }
+  if (m_combinebuf.GetSize()) func(ctx,m_combinebuf.Get(),m_combinebuf.GetSize()*(int)sizeof(WDL_FFT_REAL));
 }
 
 void WDL_ConvolutionEngine::AddSilenceToOutput(int len, int nch)
@@ -609,6 +1126,8 @@ int WDL_ConvolutionEngine::Avail(int want)
   m_combinebuf.Resize(m_fft_size*4+WDL_CONVO_ALIGN-1); // temp space
   WDL_FFT_REAL *workbuf2 = m_combinebuf.WDL_CONVO_GETALIGNED();
 
+  if (IsTrueStereo()) return AvailTrueStereo(want,workbuf2);
+
   int ch;
 
   for (ch = 0; ch < m_proc_nch; ch ++)
@@ -622,8 +1141,8 @@ int WDL_ConvolutionEngine::Avail(int want)
 
     if (m_impulse_nch==1 && ch<m_proc_nch-1 && 
         m_samplehist[ch+1].GetSize()>=WDL_CONVO_ALIGN && m_overlaphist[ch+1].GetSize() &&
-        m_samplesin[ch].Available()==m_samplesin[ch+1].Available() &&
-        m_samplesout[ch].Available()==m_samplesout[ch+1].Available()
+        InputAvailable(ch)==InputAvailable(ch+1) &&
+        (m_outring ? m_outring_pos[ch]==m_outring_pos[ch+1] : m_samplesout[ch].Available()==m_samplesout[ch+1].Available())
         )
     { // 2x processing mode
       mono_impulse_mode=true;
@@ -635,8 +1154,8 @@ int WDL_ConvolutionEngine::Avail(int want)
 
     // useSilentList[x] = 1 for mono signal, 2 for stereo, 0 for silent
     char *useSilentList=m_samplehist_zflag[ch].GetSize()==nblocks ? m_samplehist_zflag[ch].Get() : NULL;
-    while (m_samplesin[ch].Available()/(int)sizeof(WDL_FFT_REAL) >= sz && 
-           m_samplesout[ch].Available() < want*(int)sizeof(WDL_FFT_REAL))
+    int blocksrun=0;
+    while (InputAvailable(ch) >= sz && OutputWanted(ch,want) && (!m_block_limit || blocksrun++ < m_block_limit))
     {
       int histpos;
       if ((histpos=++m_hist_pos[ch]) >= nblocks) histpos=m_hist_pos[ch]=0;
@@ -644,8 +1163,8 @@ int WDL_ConvolutionEngine::Avail(int want)
       // get samples from input, to history
       WDL_FFT_REAL *optr = m_samplehist[ch].WDL_CONVO_GETALIGNED()+histpos*m_fft_size*2;
 
-      m_samplesin[ch].GetToBuf(0,optr+sz,in_needed*sizeof(WDL_FFT_REAL));
-      m_samplesin[ch].Advance(in_needed*sizeof(WDL_FFT_REAL));
+      InputGetToBuf(ch,optr+sz,in_needed);
+      InputAdvance(ch,in_needed);
 
 
       bool mono_input_mode=false;
@@ -654,8 +1173,8 @@ int WDL_ConvolutionEngine::Avail(int want)
       if (mono_impulse_mode)
       {
         if (++m_hist_pos[ch+1] >= nblocks) m_hist_pos[ch+1]=0;
-        m_samplesin[ch+1].GetToBuf(0,workbuf2,sz*sizeof(WDL_FFT_REAL));
-        m_samplesin[ch+1].Advance(sz*sizeof(WDL_FFT_REAL));
+        InputGetToBuf(ch+1,workbuf2,sz);
+        InputAdvance(ch+1,sz);
         int i;
         for (i = 0; i < sz; i ++) // unpack samples
         {
@@ -670,7 +1189,7 @@ int WDL_ConvolutionEngine::Avail(int want)
         if (allow_mono_input_mode && 
           ch < m_proc_nch-1 && 
           srcc<m_impulse_nch-1 && 
-          !CompareQueueToBuf(&m_samplesin[ch+1],optr+sz,sz*sizeof(WDL_FFT_REAL))
+          (m_inring_mono || !InputDiffers(ch+1,optr+sz,sz)) // JF: no need to compare if we've been told
           )
         {
           mono_input_mode=true;
@@ -700,11 +1219,9 @@ int WDL_ConvolutionEngine::Avail(int want)
       if (nonzflag||!useSilentList) memset(optr+sz*2,0,sz*2*sizeof(WDL_FFT_REAL));
 
 
-#ifdef WDLCONVO_ZL_ACCOUNTING
       m_zl_fftcnt++;
-#endif
 
-      if (nonzflag) WDL_fft((WDL_FFT_COMPLEX*)optr,m_fft_size,0);
+      if (nonzflag) m_fft->FFT((WDL_FFT_COMPLEX*)optr,m_fft_size,0);
 
       if (useSilentList) useSilentList[histpos]=nonzflag ? (mono_input_mode ? 1 : 2) : 0;
     
@@ -713,12 +1230,15 @@ int WDL_ConvolutionEngine::Avail(int want)
       {
         mzfl=1;
 
-        m_samplesin[ch+1].Advance(sz*sizeof(WDL_FFT_REAL));
+        InputAdvance(ch+1,sz);
 
         // save a valid copy in sample hist incase we switch from mono to stereo
         if (++m_hist_pos[ch+1] >= nblocks) m_hist_pos[ch+1]=0;
-        WDL_FFT_REAL *optr2 = m_samplehist[ch+1].WDL_CONVO_GETALIGNED()+m_hist_pos[ch+1]*m_fft_size*2;
-        memcpy(optr2,optr,m_fft_size*2*sizeof(WDL_FFT_REAL));
+        if (!m_inring_mono) // JF: can't switch when the input really is mono
+        {
+          WDL_FFT_REAL *optr2 = m_samplehist[ch+1].WDL_CONVO_GETALIGNED()+m_hist_pos[ch+1]*m_fft_size*2;
+          memcpy(optr2,optr,m_fft_size*2*sizeof(WDL_FFT_REAL));
+        }
       }
 
       int applycnt=0;
@@ -744,7 +1264,7 @@ int WDL_ConvolutionEngine::Avail(int want)
       if (!applycnt)
         memset(workbuf2,0,m_fft_size*2*sizeof(WDL_FFT_REAL));
       else
-        WDL_fft((WDL_FFT_COMPLEX*)workbuf2,m_fft_size,1);
+        m_fft->FFT((WDL_FFT_COMPLEX*)workbuf2,m_fft_size,1);
 
       WDL_FFT_REAL *olhist=m_overlaphist[ch].Get(); // errors from last time
       WDL_FFT_REAL *p1=workbuf2,*p3=workbuf2+m_fft_size,*p1o=workbuf2;
@@ -774,8 +1294,8 @@ int WDL_ConvolutionEngine::Avail(int want)
           olhist2+=2;
         }
         // add samples to output
-        m_samplesout[ch].Add(workbuf2,sz*sizeof(WDL_FFT_REAL));
-        m_samplesout[ch+1].Add(workbuf2+m_fft_size*2,sz*sizeof(WDL_FFT_REAL));
+        Output(ch,workbuf2,sz);
+        Output(ch+1,workbuf2+m_fft_size*2,sz);
       }
       else
       {
@@ -794,7 +1314,7 @@ int WDL_ConvolutionEngine::Avail(int want)
           olhist+=2;
         }
         // add samples to output
-        m_samplesout[ch].Add(workbuf2,sz*sizeof(WDL_FFT_REAL));
+        Output(ch,workbuf2,sz);
       }
     } // while available
 
@@ -810,6 +1330,129 @@ int WDL_ConvolutionEngine::Avail(int want)
   return mv;
 }
 
+// JF: true stereo, 2 inputs and a 4 channel impulse [LL, LR, RL, RR]. SetImpulse() packs the impulse
+// channels in pairs (LL+jLR, RL+jRR), so each input's spectrum times its pair holds both of its outputs.
+// The two products are summed in the frequency domain and one IFFT gives L (real) and R (imaginary).
+int WDL_ConvolutionEngine::AvailTrueStereo(int want, WDL_FFT_REAL *workbuf2)
+{
+  const int sz=m_fft_size/2;
+  const int nblocks=(m_impulse_len+sz-1)/sz;
+  int ch, i;
+
+  int blocksrun=0;
+  while (InputAvailable(0) >= sz && InputAvailable(1) >= sz && OutputWanted(0,want) && (!m_block_limit || blocksrun++ < m_block_limit))
+  {
+    int histpos;
+    if ((histpos=++m_hist_pos[0]) >= nblocks) histpos=m_hist_pos[0]=0;
+    m_hist_pos[1]=histpos;
+
+    for (ch = 0; ch < 2; ch ++) // each input FFT'd once
+    {
+      char *useSilentList=m_samplehist_zflag[ch].GetSize()==nblocks ? m_samplehist_zflag[ch].Get() : NULL;
+      WDL_FFT_REAL *optr = m_samplehist[ch].WDL_CONVO_GETALIGNED()+histpos*m_fft_size*2;
+
+      InputGetToBuf(ch,optr+sz,sz);
+      InputAdvance(ch,sz);
+
+      bool nonzflag=false;
+      for (i = 0; i < sz; i ++) // unpack samples
+      {
+        WDL_FFT_REAL f=optr[i*2]=denormal_filter_aggressive(optr[sz+i]);
+        optr[i*2+1]=0.0;
+        if (!nonzflag && (f<-CONVOENGINE_SILENCE_THRESH || f>CONVOENGINE_SILENCE_THRESH)) nonzflag=true;
+      }
+
+      if (nonzflag||!useSilentList) memset(optr+sz*2,0,sz*2*sizeof(WDL_FFT_REAL));
+
+      m_zl_fftcnt++;
+
+      if (nonzflag) m_fft->FFT((WDL_FFT_COMPLEX*)optr,m_fft_size,0);
+
+      if (useSilentList) useSilentList[histpos]=nonzflag ? 1 : 0;
+    }
+
+    int applycnt=0;
+    for (ch = 0; ch < 2; ch ++) // input ch against impulse pair ch*2, ch*2+1
+    {
+      char *useSilentList=m_samplehist_zflag[ch].GetSize()==nblocks ? m_samplehist_zflag[ch].Get() : NULL;
+      char *useImpSilentList=m_impulse_zflag[ch*2].GetSize() == nblocks ? m_impulse_zflag[ch*2].Get() : NULL;
+
+      WDL_CONVO_IMPULSEBUFf *impulseptr=m_impulse[ch*2].WDL_CONVO_GETALIGNED();
+      for (i = 0; i < nblocks; i ++, impulseptr+=m_fft_size*2)
+      {
+        int srchistpos = histpos-i;
+        if (srchistpos < 0) srchistpos += nblocks;
+
+        if (useImpSilentList && !useImpSilentList[i]) continue;
+        if (useSilentList && !useSilentList[srchistpos]) continue; // silent block
+
+        WDL_FFT_REAL *samplehist=m_samplehist[ch].WDL_CONVO_GETALIGNED() + m_fft_size*srchistpos*2;
+
+        if (applycnt++) // add to output
+          WDL_CONVO_CplxMul3((WDL_FFT_COMPLEX*)workbuf2,(WDL_FFT_COMPLEX*)samplehist,(WDL_CONVO_IMPULSEBUFCPLXf*)impulseptr,m_fft_size);   
+        else // replace output
+          WDL_CONVO_CplxMul2((WDL_FFT_COMPLEX*)workbuf2,(WDL_FFT_COMPLEX*)samplehist,(WDL_CONVO_IMPULSEBUFCPLXf*)impulseptr,m_fft_size);  
+      }
+    }
+    if (!applycnt)
+      memset(workbuf2,0,m_fft_size*2*sizeof(WDL_FFT_REAL));
+    else
+      m_fft->FFT((WDL_FFT_COMPLEX*)workbuf2,m_fft_size,1);
+
+    WDL_FFT_REAL *olhist=m_overlaphist[0].Get(); // errors from last time
+    WDL_FFT_REAL *olhist2=m_overlaphist[1].Get();
+    WDL_FFT_REAL *p1=workbuf2,*p3=workbuf2+m_fft_size,*p1o=workbuf2;
+    WDL_FFT_REAL *p2o=workbuf2+m_fft_size*2;
+    int s=sz/2;
+    while (s--)
+    {
+      p2o[0] = p1[1]+olhist2[0];
+      p2o[1] = p1[3]+olhist2[1];
+      p1o[0] = p1[0]+olhist[0];
+      p1o[1] = p1[2]+olhist[1];
+      p1o+=2;
+      p2o+=2;
+      p1+=4;
+
+      olhist[0]=p3[0];
+      olhist[1]=p3[2];
+      olhist2[0]=p3[1];
+      olhist2[1]=p3[3];
+      p3+=4;
+
+      olhist+=2;
+      olhist2+=2;
+    }
+    // add samples to output
+    Output(0,workbuf2,sz);
+    Output(1,workbuf2+m_fft_size*2,sz);
+  }
+
+  int mv=m_samplesout[0].Available()/sizeof(WDL_FFT_REAL);
+  int v=m_samplesout[1].Available()/sizeof(WDL_FFT_REAL);
+  if (v<mv) mv=v;
+  return mv<want ? mv : want;
+}
+
+void WDL_ConvolutionEngine::RunBlocks(int maxblocks)
+{
+  if (m_fft_size<1 || maxblocks<1) return;
+  m_block_limit=maxblocks;
+  Avail(GetOutputQueued()+maxblocks*(m_fft_size/2)); // in outring mode the limit is all that stops it
+  m_block_limit=0;
+}
+
+double WDL_ConvolutionEngine::GetBlockCost() const
+{
+  if (m_fft_size<1) return 0.0;
+  const int sz=m_fft_size/2;
+  const int nblocks=(m_impulse_len+sz-1)/sz;
+  int lg=0;
+  while ((2<<lg) <= m_fft_size) lg++;
+  // forward and inverse FFT at ~5 n log2(n) each, a complex multiply-add per bin per impulse block
+  return m_fft_size*(10.0*lg+8.0*nblocks);
+}
+
 WDL_FFT_REAL **WDL_ConvolutionEngine::Get() 
 {
   int x;
@@ -843,29 +1486,58 @@ WDL_ConvolutionEngine_Div::WDL_ConvolutionEngine_Div()
 #endif
   m_proc_nch=2;
   m_need_feedsilence=true;
+  m_mono_input=false;
+  m_true_stereo=false;
+  m_brute_size=WDL_CONVO_DEFAULT_BRUTE_SIZE;
+  m_segment_blocks=WDL_CONVO_DEFAULT_SEGMENT_BLOCKS;
+  m_load_balance=false;
+  m_balanced=false;
+  m_lb_cost=0.0;
+  m_lb_samples=0;
+  m_lb_peak=0.0;
+  ResetAccounting();
+  m_small=false;
+  m_small_maxblock=0;
+  m_small_lead=0;
+  m_small_inpos=0;
 }
 
 int WDL_ConvolutionEngine_Div::SetImpulse(WDL_ImpulseBuffer *impulse, int maxfft_size, int known_blocksize, int max_imp_size, int impulse_offset, int latency_allowed)
 {
   m_need_feedsilence=true;
+  m_small=false; // until Prepare()
+  m_balanced=m_load_balance;
+  m_lb_cost=0.0;
+  m_lb_samples=0;
+  m_lb_peak=0.0;
 
   m_engines.Empty(true);
   if (maxfft_size<0)maxfft_size=-maxfft_size;
   maxfft_size*=2;
-  if (!maxfft_size || maxfft_size>32768) maxfft_size=32768;
-
+  // JF: was clamped to 32768. Up to WDL_FFT_MAX_SIZE now, fewer partitions & multiplies in the tail of long
+  // impulses but a bigger FFT each time one's due: for offline, or where latency allows. Powers of two only.
+  if (!maxfft_size) maxfft_size=32768;
+  else if (maxfft_size>WDL_FFT_MAX_SIZE) maxfft_size=WDL_FFT_MAX_SIZE;
+  while (maxfft_size&(maxfft_size-1)) maxfft_size&=maxfft_size-1;
 
-  const int MAX_SIZE_FOR_BRUTE=64;
+  const int MAX_SIZE_FOR_BRUTE=m_brute_size; // JF: was fixed at 64, see SetBruteSize()
 
   int fftsize = MAX_SIZE_FOR_BRUTE;
   int impulsechunksize = MAX_SIZE_FOR_BRUTE;
-
-  if (known_blocksize && !(known_blocksize&(known_blocksize-1)) && known_blocksize>MAX_SIZE_FOR_BRUTE*2)
+  int max_mixed_fftsize = 0;
+
+  // JF: was powers of two only. Block sizes made of 2s, 3s & 5s (480, 960, 1440) get mixed radix FFTs for
+  // the partitions that run every block, so they line up with it. Bigger ones don't and are faster as
+  // powers of two (mixed radix FFTs cost ~1.3x per point).
+  if (known_blocksize && known_blocksize>MAX_SIZE_FOR_BRUTE*2 &&
+      (!(known_blocksize&(known_blocksize-1)) ||
+       (!(known_blocksize&7) && ChooseFFTBackend(known_blocksize/2) && ChooseFFTBackend(known_blocksize))))
   {
     fftsize=known_blocksize/2;
     impulsechunksize=known_blocksize/2;
+    max_mixed_fftsize=known_blocksize*2;
   }
-  if (latency_allowed*2 > fftsize)
+  if (latency_allowed>0) // JF: was latency_allowed*2 > fftsize, a tuned brute size could overrun the latency
   {
     int x = 16;
     while (x <= latency_allowed) x*=2;
@@ -874,6 +1546,7 @@ int WDL_ConvolutionEngine_Div::SetImpulse(WDL_ImpulseBuffer *impulse, int maxfft
   }
 
   int offs=0;
+  int fftengines=0;
   int samplesleft=impulse->impulses[0].GetSize()-impulse_offset;
   if (max_imp_size>0 && samplesleft>max_imp_size) samplesleft=max_imp_size;
 
@@ -885,10 +1558,15 @@ int WDL_ConvolutionEngine_Div::SetImpulse(WDL_ImpulseBuffer *impulse, int maxfft
     if (impulsechunksize*(wantBrute ? 2 : 3) >= samplesleft) impulsechunksize=samplesleft; // early-out, no point going to a larger FFT (since if we did this, we wouldnt have enough samples for a complete next pass)
     if (fftsize>=maxfft_size) { impulsechunksize=samplesleft; fftsize=maxfft_size; } // if FFTs are as large as possible, finish up
 
+    eng->m_zl_truestereo=m_true_stereo;
+    if (!wantBrute) eng->SetFFTBackend(ChooseFFTBackend(fftsize));
     eng->SetImpulse(impulse,fftsize,offs+impulse_offset,impulsechunksize, wantBrute);
     eng->m_zl_delaypos = offs;
     eng->m_zl_dumpage=0;
+    eng->SetInputRing(&m_inring,0,m_mono_input);
     m_engines.Add(eng);
+    if (!wantBrute) fftengines++;
+    if (eng->GetBlockCost() > m_lb_peak) m_lb_peak=eng->GetBlockCost();
 
 #ifdef WDLCONVO_ZL_ACCOUNTING
     char buf[512];
@@ -900,8 +1578,15 @@ int WDL_ConvolutionEngine_Div::SetImpulse(WDL_ImpulseBuffer *impulse, int maxfft
     offs+=impulsechunksize;
 
 #if 1 // this seems about 10% faster (maybe due to better cache use from less sized ffts used?)
-    impulsechunksize=offs*3;
+    impulsechunksize=offs*m_segment_blocks; // JF: was offs*3, see SetSegmentBlocks()
     fftsize=offs*2;
+    if (m_balanced && fftengines) fftsize=offs; // JF: a block of slack, see SetLoadBalance()
+    if ((fftsize&(fftsize-1)) && fftsize>max_mixed_fftsize) // JF: largest power of two within the latency
+    {
+      int x=32;
+      while (x*2 <= fftsize) x*=2;
+      fftsize=x;
+    }
 #else
     impulsechunksize=fftsize;
 
@@ -913,6 +1598,53 @@ int WDL_ConvolutionEngine_Div::SetImpulse(WDL_ImpulseBuffer *impulse, int maxfft
   return GetLatency();
 }
 
+void WDL_ConvolutionEngine_Div::SetMonoInput(bool mono)
+{
+  if (mono == m_mono_input) return;
+  m_mono_input=mono;
+
+  int x;
+  for (x = 0; x < m_engines.GetSize(); x ++) m_engines.Get(x)->SetInputRing(&m_inring,0,m_mono_input);
+  Reset();
+}
+
+void WDL_ConvolutionEngine_Div::SetSegmentBlocks(int blocks)
+{
+  m_segment_blocks=blocks<1 ? 1 : blocks>WDL_CONVO_MAX_SEGMENT_BLOCKS ? WDL_CONVO_MAX_SEGMENT_BLOCKS : blocks;
+}
+
+void WDL_ConvolutionEngine_Div::SetFFTBackends(WDL_ConvolutionFFTBackend * const *list, int n)
+{
+  m_fft_backends.Empty();
+  int x;
+  for (x = 0; x < n; x ++) if (list[x]) m_fft_backends.Add(list[x]);
+}
+
+WDL_ConvolutionFFTBackend *WDL_ConvolutionEngine_Div::GetFFTBackend(int index) const
+{
+  WDL_ConvolutionEngine *eng=m_engines.Get(index);
+  return eng && eng->GetFFTSize() ? eng->GetFFTBackend() : NULL;
+}
+
+WDL_ConvolutionFFTBackend *WDL_ConvolutionEngine_Div::ChooseFFTBackend(int len)
+{
+  int x;
+  for (x = 0; x < m_fft_backends.GetSize(); x ++)
+  {
+    WDL_ConvolutionFFTBackend *fft=m_fft_backends.Get(x);
+    if (fft->SupportsSize(len) && fft->PrepareSize(len)) return fft;
+  }
+  WDL_ConvolutionFFTBackend *fft=WDL_ConvolutionFFTBackend::GetDefault();
+  return fft->PrepareSize(len) ? fft : NULL;
+}
+
+void WDL_ConvolutionEngine_Div::SetBruteSize(int size)
+{
+  int x = WDL_CONVO_MIN_BRUTE_SIZE;
+  while (x < size && x < WDL_CONVO_MAX_BRUTE_SIZE) x*=2;
+  m_brute_size=x;
+}
+
 int WDL_ConvolutionEngine_Div::GetLatency()
 {
   return m_engines.GetSize() ? m_engines.Get(0)->GetLatency() : 0;
@@ -945,29 +1677,221 @@ WDL_ConvolutionEngine_Div::~WDL_ConvolutionEngine_Div()
 
 void WDL_ConvolutionEngine_Div::Add(WDL_FFT_REAL **bufs, int len, int nch)
 {
+  const bool nch_changed = nch!=m_proc_nch;
   m_proc_nch=nch;
 
+  if (m_small && nch>m_outring.GetNumChannels()) // not prepared for this, back to queueing
+  {
+    m_small=false;
+    Reset();
+  }
+
   bool ns=m_need_feedsilence;
   m_need_feedsilence=false;
 
+  if (ns) FeedSilence();
+
+  const int in_nch=m_mono_input ? 1 : nch;
+  if (m_small && !nch_changed && !ns && in_nch<=m_inring.GetNumChannels())
+  {
+    // JF: the rings were sized by Prepare() for this much input between reads, only check beyond that
+    const WDL_INT64 unread=m_inring.GetWritePos()+len-m_small_inpos-m_outring.GetReadPos();
+    if (unread<=m_small_maxblock)
+    {
+      m_inring.Add(bufs,len,in_nch);
+      m_engines.Get(0)->Add(NULL,len,nch); // the head, straight into the output ring
+      return;
+    }
+    m_outring.Grow((int)unread+m_small_lead);
+  }
+
+  // JF: the input goes into the ring once, and every engine reads it from there. The ring has to reach back
+  // to the slowest engine's read position, so grows here if Prepare() didn't size it for this block.
+  WDL_INT64 oldest=m_inring.GetWritePos();
   int x;
+  for (x = 0; x < m_engines.GetSize(); x ++)
+  {
+    const WDL_INT64 pos=m_engines.Get(x)->GetInputRingPos();
+    if (pos<oldest) oldest=pos;
+  }
+  const WDL_INT64 need=m_inring.GetWritePos()+len-oldest;
+  if (need>m_inring.GetSize() || in_nch>m_inring.GetNumChannels()) m_inring.Grow((int)need,in_nch,oldest);
+
+  m_inring.Add(bufs,len,in_nch);
+
   for (x = 0; x < m_engines.GetSize(); x ++)
   {
     WDL_ConvolutionEngine *eng=m_engines.Get(x);
-    if (ns)
-    {
-      eng->m_zl_dumpage = (x>0 && x < m_engines.GetSize()-1) ? (eng->GetLatency()/4) : 0; // reduce max number of ffts per block by staggering them
+    eng->Add(NULL,len,nch);
+
+    if (ns && !m_small) eng->AddSilenceToOutput(eng->m_zl_delaypos,nch); // add silence to output (to delay output to its correct time)
+  }
+}
 
-      if (eng->m_zl_dumpage>0)
-        eng->Add(NULL,eng->m_zl_dumpage,nch); // added silence to input (to control when fft happens)
+void WDL_ConvolutionEngine_Div::FeedSilence()
+{
+  // JF: rather than feeding each engine its own silence, the ring starts with enough of it for the largest
+  // stagger and each engine starts reading that far back
+  int x, prefill=0;
+  for (x = 0; x < m_engines.GetSize(); x ++)
+  {
+    WDL_ConvolutionEngine *eng=m_engines.Get(x);
+    eng->m_zl_dumpage = (x>0 && x < m_engines.GetSize()-1) ? (eng->GetLatency()/4) : 0; // reduce max number of ffts per block by staggering them
+    if (eng->m_zl_dumpage>prefill) prefill=eng->m_zl_dumpage;
+  }
+
+  m_inring.Clear(prefill);
+  m_small_inpos=prefill;
+  if (m_small) m_outring.Clear();
+  for (x = 0; x < m_engines.GetSize(); x ++)
+  {
+    WDL_ConvolutionEngine *eng=m_engines.Get(x);
+    eng->SetInputRing(&m_inring,prefill-eng->m_zl_dumpage,m_mono_input); // added silence to input (to control when fft happens)
+
+    // in small block mode each engine's output goes straight to the time it's due, instead of being
+    // delayed with silence & its stagger dumped from the front of its queue
+    eng->SetOutputRing(m_small ? &m_outring : NULL,eng->m_zl_delaypos-eng->m_zl_dumpage);
+  }
+}
+
+int WDL_ConvolutionEngine_Div::SmallProcess()
+{
+  // the FFT engines' partitions are at least as long as their delay, so once each has processed every
+  // complete block of input their output is always ready up to where the head's is. Load balanced, only
+  // the blocks needed to get there run now, EndCall() spreads the rest.
+  BeginCall();
+  const WDL_INT64 due=m_engines.Get(0)->GetOutputRingPos();
+  int x;
+  for (x = 1; x < m_engines.GetSize(); x ++)
+  {
+    WDL_ConvolutionEngine *eng=m_engines.Get(x);
+    if (!m_balanced) { if (eng->IsBlockDue()) eng->Avail(0); }
+    else while (eng->GetOutputRingPos()<due && eng->GetBlocksDue()) eng->RunBlocks(1);
+  }
+  const int n=(int)(due-m_outring.GetReadPos());
+  EndCall(n);
+  return n;
+}
+
+void WDL_ConvolutionEngine_Div::ResetAccounting()
+{
+  memset(&m_accounting,0,sizeof(m_accounting));
+}
+
+void WDL_ConvolutionEngine_Div::BeginCall()
+{
+  int x;
+  for (x = 0; x < m_engines.GetSize(); x ++) m_engines.Get(x)->m_zl_fftcnt=0;
+}
+
+int WDL_ConvolutionEngine_Div::EngineSlack(int x) const
+{
+  WDL_ConvolutionEngine *eng=m_engines.Get(x);
+  if (m_small) return (int)(eng->GetOutputRingPos()-m_engines.Get(0)->GetOutputRingPos());
+  return eng->GetOutputQueued()-eng->m_zl_dumpage;
+}
+
+void WDL_ConvolutionEngine_Div::EndCall(int len)
+{
+  if (len<1) return;
+  int x;
+
+  if (m_balanced)
+  {
+    // waiting blocks, soonest due first, while this call's work is within the average per call. The
+    // biggest single block has to fit in some call, so the budget is never less than that.
+    double spent=0.0;
+    for (x = 1; x < m_engines.GetSize(); x ++) spent+=m_engines.Get(x)->m_zl_fftcnt*m_engines.Get(x)->GetBlockCost();
+    double budget=m_lb_samples>0 ? m_lb_cost*len/(double)m_lb_samples : 0.0;
+    if (budget<m_lb_peak*m_proc_nch) budget=m_lb_peak*m_proc_nch;
+    for (;;)
+    {
+      int best=-1, bestslack=0;
+      for (x = 1; x < m_engines.GetSize(); x ++)
+      {
+        if (!m_engines.Get(x)->GetBlocksDue()) continue;
+        const int slack=EngineSlack(x);
+        if (best<0 || slack<bestslack) { best=x; bestslack=slack; }
+      }
+      if (best<0) break;
+
+      WDL_ConvolutionEngine *eng=m_engines.Get(best);
+      const int before=eng->m_zl_fftcnt;
+      if (spent+eng->GetBlockCost()*m_proc_nch>budget) break; // none later jumps the queue
+      eng->RunBlocks(1);
+      if (eng->m_zl_fftcnt==before) break;
+      spent+=(eng->m_zl_fftcnt-before)*eng->GetBlockCost();
     }
+  }
+
+  int engines=0, blocks=0;
+  double cost=0.0;
+  for (x = 1; x < m_engines.GetSize(); x ++)
+  {
+    WDL_ConvolutionEngine *eng=m_engines.Get(x);
+    if (!eng->m_zl_fftcnt) continue;
+    engines++;
+    blocks+=eng->m_zl_fftcnt;
+    cost+=eng->m_zl_fftcnt*eng->GetBlockCost();
+  }
+  m_lb_cost+=cost;
+  m_lb_samples+=len;
+
+  m_accounting.calls++;
+  if (engines>m_accounting.max_engines) m_accounting.max_engines=engines;
+  if (blocks>m_accounting.max_blocks) m_accounting.max_blocks=blocks;
+  if (cost>m_accounting.max_cost) m_accounting.max_cost=cost;
+  m_accounting.total_cost+=cost;
+  m_accounting.total_samples+=len;
+}
+
+void WDL_ConvolutionEngine_Div::Prepare(int nch, int maxblocklen)
+{
+  if (nch<1) return;
+  if (nch>WDL_CONVO_MAX_PROC_NCH) nch=WDL_CONVO_MAX_PROC_NCH;
+  if (maxblocklen<1) maxblocklen=1;
 
-    eng->Add(bufs,len,nch);
+  // the ring has to hold each engine's backlog: its stagger, plus the input held back while its output
+  // delay drains, plus a part-filled FFT block, plus the brute force history
+  m_small = maxblocklen<=WDL_CONVO_SMALL_BLOCK_MAX && m_engines.GetSize() && m_engines.Get(0)->GetFFTSize()<1;
+  m_small_maxblock=maxblocklen;
+  m_small_lead=0;
 
-    if (ns) eng->AddSilenceToOutput(eng->m_zl_delaypos,nch); // add silence to output (to delay output to its correct time)
+  int x, ringsize=0;
+  for (x = 0; x < m_engines.GetSize(); x ++)
+  {
+    WDL_ConvolutionEngine *eng=m_engines.Get(x);
+    eng->SetOutputRing(m_small ? &m_outring : NULL,0); // positions are set by FeedSilence()
+    // allow for the staggering silence added in Add(), and blocks run early when load balanced
+    eng->Prepare(nch,maxblocklen+eng->GetLatency()/4+(m_balanced ? eng->m_zl_delaypos : 0));
+    if (eng->m_zl_delaypos>m_small_lead) m_small_lead=eng->m_zl_delaypos;
 
+    const int backlog=eng->GetLatency()/4+eng->m_zl_delaypos+eng->GetFFTSize()/2+eng->GetInputHistory();
+    if (backlog>ringsize) ringsize=backlog;
   }
+  m_inring.Resize(ringsize+2*maxblocklen,m_mono_input ? 1 : nch);
+  if (m_small) m_outring.Resize(m_small_lead+2*maxblocklen,nch);
+  else m_outring.Resize(0,0);
+  for (x = 0; x < WDL_CONVO_MAX_PROC_NCH; x ++)
+  {
+    m_samplesout[x].Clear();
+    if (x>=nch) continue;
+    const int sz=2*maxblocklen*(int)sizeof(WDL_FFT_REAL);
+    memset(m_samplesout[x].Add(NULL,sz),0,sz);
+    m_samplesout[x].Clear();
+  }
+  m_proc_nch=nch;
+  m_need_feedsilence=true;
+}
+
+void WDL_ConvolutionEngine_Div::EnumBuffers(void (*func)(void *ctx, void *buf, int bytes), void *ctx)
+{
+  int x;
+  for (x = 0; x < m_engines.GetSize(); x ++) m_engines.Get(x)->EnumBuffers(func,ctx);
+  m_inring.EnumBuffers(func,ctx);
+  m_outring.EnumBuffers(func,ctx);
 }
+
 WDL_FFT_REAL **WDL_ConvolutionEngine_Div::Get() 
 {
   int x;
@@ -995,48 +1919,36 @@ int WDL_ConvolutionEngine_Div::Avail(int wantSamples)
 #endif
   int wso=wantSamples;
   int x;
-#ifdef WDLCONVO_ZL_ACCOUNTING
-  int cnt=0;
-  static int maxcnt=-1;
-  int h=0;
-#endif
-  for (x = 0; x < m_engines.GetSize(); x ++)
-  {
-    WDL_ConvolutionEngine *eng=m_engines.Get(x);
-#ifdef WDLCONVO_ZL_ACCOUNTING
-    eng->m_zl_fftcnt=0;
-#endif
-    int a=eng->Avail(wso+eng->m_zl_dumpage) - eng->m_zl_dumpage;
-#ifdef WDLCONVO_ZL_ACCOUNTING
-    cnt += !!eng->m_zl_fftcnt;
 
-#if 0
-    if (eng->m_zl_fftcnt)
-      h|=1<<x;
-    
-    if (eng->m_zl_fftcnt && x==m_engines.GetSize()-1 && cnt>1)
+  if (m_small) // JF: queue just what's asked for, for Get()/Advance()
+  {
+    int have=m_samplesout[0].Available()/(int)sizeof(WDL_FFT_REAL);
+    if (have<wantSamples)
     {
-      char buf[512];
-      wsprintf(buf,"fft flags=%08x (%08x=max)\n",h,1<<x);
-      OutputDebugString(buf);
+      int n=SmallProcess();
+      if (n>wantSamples-have) n=wantSamples-have;
+      if (n>0)
+      {
+        WDL_FFT_REAL *tp[WDL_CONVO_MAX_PROC_NCH];
+        for (x = 0; x < m_proc_nch; x ++) tp[x]=(WDL_FFT_REAL*)m_samplesout[x].Add(NULL,n*sizeof(WDL_FFT_REAL));
+        m_outring.Read(tp,m_proc_nch,n);
+        have+=n;
+      }
     }
+#ifdef TIMING
+    timingLeave(1);
 #endif
-#endif
-    if (a < wantSamples) wantSamples=a;
+    return have>wantSamples ? wantSamples : have;
   }
 
-#ifdef WDLCONVO_ZL_ACCOUNTING
-  static DWORD lastt=0;
-  if (cnt>maxcnt)maxcnt=cnt;
-  if (GetTickCount()>lastt+1000)
+  BeginCall();
+  for (x = 0; x < m_engines.GetSize(); x ++)
   {
-    lastt=GetTickCount();
-    char buf[512];
-    wsprintf(buf,"maxcnt=%d\n",maxcnt);
-    OutputDebugString(buf);
-    maxcnt=-1;
+    WDL_ConvolutionEngine *eng=m_engines.Get(x);
+    int a=eng->Avail(wso+eng->m_zl_dumpage) - eng->m_zl_dumpage;
+    if (a < wantSamples) wantSamples=a;
   }
-#endif
+
   if (wantSamples>0)
   {
     WDL_FFT_REAL *tp[WDL_CONVO_MAX_PROC_NCH];
@@ -1054,17 +1966,12 @@ int WDL_ConvolutionEngine_Div::Avail(int wantSamples)
       if (p)
       {
         int i;
-        for (i =0; i < m_proc_nch; i ++)
-        {
-          WDL_FFT_REAL *o=tp[i];
-          WDL_FFT_REAL *in=p[i];
-          int j=wantSamples;
-          while (j-->0) *o++ += *in++;
-        }
+        for (i =0; i < m_proc_nch; i ++) WDL_CONVO_Accumulate(tp[i],p[i],wantSamples);
       }
       eng->Advance(wantSamples);
     }
   }
+  EndCall(wantSamples);
 #ifdef TIMING
   timingLeave(1);
 #endif
@@ -1073,6 +1980,83 @@ int WDL_ConvolutionEngine_Div::Avail(int wantSamples)
   return av>wso ? wso : av;
 }
 
+int WDL_ConvolutionEngine_Div::AvailTo(WDL_FFT_REAL **dest, int nch, int len)
+{
+  int x, ch;
+  int done=0;
+
+  // anything a previous Avail() queued comes first
+  int queued=m_samplesout[0].Available()/(int)sizeof(WDL_FFT_REAL);
+  if (queued>0)
+  {
+    if (queued>len) queued=len;
+    for (ch = 0; ch < nch; ch ++)
+    {
+      if (ch < m_proc_nch) memcpy(dest[ch],m_samplesout[ch].Get(),queued*sizeof(WDL_FFT_REAL));
+      else memset(dest[ch],0,queued*sizeof(WDL_FFT_REAL));
+    }
+    for (ch = 0; ch < m_proc_nch; ch ++)
+    {
+      m_samplesout[ch].Advance(queued*sizeof(WDL_FFT_REAL));
+      m_samplesout[ch].Compact();
+    }
+    done=queued;
+  }
+
+  int want=len-done;
+  if (m_small) // JF: every engine has already added into the output ring, just read it
+  {
+    int n=want>0 ? SmallProcess() : 0;
+    if (n>want) n=want;
+    if (n>0)
+    {
+      WDL_FFT_REAL *tp[WDL_CONVO_MAX_PROC_NCH];
+      for (ch = 0; ch < nch; ch ++) tp[ch]=dest[ch]+done;
+      m_outring.Read(tp,nch,n);
+      done+=n;
+    }
+    for (ch = 0; ch < nch && done<len; ch ++) memset(dest[ch]+done,0,(len-done)*sizeof(WDL_FFT_REAL));
+    return done;
+  }
+
+  if (want>0) BeginCall();
+  for (x = 0; x < m_engines.GetSize() && want>0; x ++)
+  {
+    WDL_ConvolutionEngine *eng=m_engines.Get(x);
+    int a=eng->Avail(want+eng->m_zl_dumpage) - eng->m_zl_dumpage;
+    if (a < want) want=a;
+  }
+
+  if (want>0)
+  {
+    bool written=false; // first engine copies, the rest accumulate
+    for (x = 0; x < m_engines.GetSize(); x ++)
+    {
+      WDL_ConvolutionEngine *eng=m_engines.Get(x);
+      if (eng->m_zl_dumpage>0) { eng->Advance(eng->m_zl_dumpage); eng->m_zl_dumpage=0; }
+
+      WDL_FFT_REAL **p=eng->Get();
+      if (p)
+      {
+        for (ch = 0; ch < nch && ch < m_proc_nch; ch ++)
+        {
+          if (written) WDL_CONVO_Accumulate(dest[ch]+done,p[ch],want);
+          else memcpy(dest[ch]+done,p[ch],want*sizeof(WDL_FFT_REAL));
+        }
+        written=true;
+      }
+      eng->Advance(want);
+    }
+    for (ch = written ? m_proc_nch : 0; ch < nch; ch ++) memset(dest[ch]+done,0,want*sizeof(WDL_FFT_REAL));
+    done+=want;
+    EndCall(want);
+  }
+  else want=0;
+
+  for (ch = 0; ch < nch && done<len; ch ++) memset(dest[ch]+done,0,(len-done)*sizeof(WDL_FFT_REAL));
+  return done;
+}
+
 
 
 /****************************************************************
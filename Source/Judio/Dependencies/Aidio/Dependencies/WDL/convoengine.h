@@ -64,6 +64,20 @@ typedef WDL_TypedBuf<WDL_FFT_REAL> WDL_CONVO_IMPULSE_TYPED_BUF;
 #define WDL_CONVO_MAX_PROC_NCH 4    // JF: change from 2 to 4
 #endif
 
+// JF: length of WDL_ConvolutionEngine_Div's zero latency brute force head, see SetBruteSize()
+#define WDL_CONVO_DEFAULT_BRUTE_SIZE 64
+#define WDL_CONVO_MIN_BRUTE_SIZE 16
+#define WDL_CONVO_MAX_BRUTE_SIZE 2048
+
+// JF: FFT blocks per partition after the head, see WDL_ConvolutionEngine_Div::SetSegmentBlocks()
+#define WDL_CONVO_DEFAULT_SEGMENT_BLOCKS 3
+#define WDL_CONVO_MAX_SEGMENT_BLOCKS 16
+
+// JF: WDL_ConvolutionEngine_Div::Prepare() for blocks up to this many samples switches to small block mode
+#ifndef WDL_CONVO_SMALL_BLOCK_MAX
+#define WDL_CONVO_SMALL_BLOCK_MAX 64
+#endif
+
 //#define WDL_CONVO_WANT_FULLPRECISION_IMPULSE_STORAGE // define this for slowerness with -138dB error difference in resulting output (+-1 LSB at 24 bit)
 
 #ifdef WDL_CONVO_WANT_FULLPRECISION_IMPULSE_STORAGE 
@@ -104,6 +118,82 @@ private:
 
 };
 
+// JF: input history shared by the engines of a WDL_ConvolutionEngine_Div, written once per block and read
+// by every engine at its own position. Mirrored: each sample is stored at pos%size and pos%size+size, so any
+// span of up to size samples is contiguous at Get().
+class WDL_ConvolutionInputRing
+{
+public:
+  WDL_ConvolutionInputRing() { m_size=0; m_nch=0; m_wpos=0; }
+  ~WDL_ConvolutionInputRing() { }
+
+  void Resize(int size, int nch); // rounds up to a power of 2, clears
+  void Grow(int size, int nch, WDL_INT64 keepfrom); // as Resize(), but keeps samples from keepfrom onwards
+  void Clear(int prefill); // zeroes, and writes from prefill on, so readers can start up to prefill samples back
+  int GetSize() const { return m_size; }
+  int GetNumChannels() const { return m_nch; }
+
+  void Add(WDL_FFT_REAL **bufs, int len, int nch); // NULL bufs adds silence
+  WDL_INT64 GetWritePos() const { return m_wpos; }
+  const WDL_FFT_REAL *Get(int ch, WDL_INT64 pos) const { return m_buf[ch].Get()+(int)(pos&(m_size-1)); }
+
+  void EnumBuffers(void (*func)(void *ctx, void *buf, int bytes), void *ctx);
+
+private:
+  void Write(int ch, WDL_INT64 pos, const WDL_FFT_REAL *src, int len);
+
+  WDL_TypedBuf<WDL_FFT_REAL> m_buf[WDL_CONVO_MAX_PROC_NCH];
+  int m_size;
+  int m_nch;
+  WDL_INT64 m_wpos;
+};
+
+// JF: summed output of a WDL_ConvolutionEngine_Div's engines in small block mode. Each engine adds its output
+// at the absolute time it's due (so no per-engine queues or delay padding), the reader copies it out and
+// zeroes it behind itself. Not mirrored, spans wrap.
+class WDL_ConvolutionOutputRing
+{
+public:
+  WDL_ConvolutionOutputRing() { m_size=0; m_nch=0; m_rpos=0; }
+  ~WDL_ConvolutionOutputRing() { }
+
+  void Resize(int size, int nch); // rounds up to a power of 2, clears
+  void Grow(int size); // as Resize(), but keeps everything not read yet
+  void Clear(); // zeroes, and reads from 0
+  int GetSize() const { return m_size; }
+  int GetNumChannels() const { return m_nch; }
+
+  void Accumulate(int ch, WDL_INT64 pos, const WDL_FFT_REAL *src, int len); // NULL src does nothing
+  WDL_FFT_REAL *GetSpan(int ch, WDL_INT64 pos, int *len); // contiguous part from pos, len is clipped to it
+  WDL_INT64 GetReadPos() const { return m_rpos; }
+  void Read(WDL_FFT_REAL **dest, int nch, int len); // copies out & zeroes, channels past GetNumChannels() get 0s
+
+  void EnumBuffers(void (*func)(void *ctx, void *buf, int bytes), void *ctx);
+
+private:
+  WDL_TypedBuf<WDL_FFT_REAL> m_buf[WDL_CONVO_MAX_PROC_NCH];
+  int m_size;
+  int m_nch;
+  WDL_INT64 m_rpos;
+};
+
+// JF: the FFT the engines run, WDL_fft() by default (GetDefault()), see WDL_ConvolutionEngine::SetFFTBackend()
+// and WDL_ConvolutionEngine_Div::SetFFTBackends(). FFT() is complex, in place and unscaled (the engine scales
+// its input), and may leave the bins in any order its inverse undoes, they're only multiplied pointwise.
+// An engine's impulse spectra are made by the backend it runs, so it's only switched by SetImpulse().
+class WDL_ConvolutionFFTBackend
+{
+public:
+  virtual ~WDL_ConvolutionFFTBackend() { }
+
+  virtual const char *GetName() const = 0;
+  virtual bool SupportsSize(int len) const = 0;
+  virtual bool PrepareSize(int len) = 0; // makes len's tables, thread safe, not on the audio thread. false if unsupported
+  virtual void FFT(WDL_FFT_COMPLEX *buf, int len, int isInverse) = 0; // audio thread: no locks or allocation
+
+  static WDL_ConvolutionFFTBackend *GetDefault();
+};
+
 class WDL_ConvolutionEngine
 {
 public:
@@ -114,6 +204,11 @@ public:
  
   int GetFFTSize() { return m_fft_size; }
   int GetLatency() { return m_fft_size/2; }
+
+  // JF: the FFT for the next SetImpulse(), NULL for the default. Falls back to the default if it can't do
+  // the size. GetFFTBackend() is the one in use.
+  void SetFFTBackend(WDL_ConvolutionFFTBackend *fft) { m_fft_pref=fft; }
+  WDL_ConvolutionFFTBackend *GetFFTBackend() const { return m_fft; }
   
   void Reset(); // clears out any latent samples
 
@@ -123,7 +218,47 @@ public:
   WDL_FFT_REAL **Get(); // returns length valid
   void Advance(int len);
 
+  // JF: allocates and touches the channel histories and queue storage that Add()/Avail() would otherwise
+  // allocate on the first blocks, for nch channels and blocks of up to maxblocklen. Also resets the engine.
+  void Prepare(int nch, int maxblocklen);
+  // JF: calls func for each impulse spectrum/history buffer owned by the engine (e.g. to mlock them)
+  void EnumBuffers(void (*func)(void *ctx, void *buf, int bytes), void *ctx);
+
+  // JF: read input from a shared ring (see WDL_ConvolutionEngine_Div) instead of queueing it in Add(),
+  // starting at pos. Add() then only takes note of the samples already written to the ring. With mono_input
+  // the ring has one channel, read for every output channel, and is always treated as mono (no comparing).
+  void SetInputRing(WDL_ConvolutionInputRing *ring, WDL_INT64 pos, bool mono_input=false);
+  WDL_INT64 GetInputRingPos() const; // oldest sample still needed, including the history below
+  int GetInputHistory() const; // samples before its read position the brute force head looks back at
+
+  // JF: add output into a shared ring at pos onwards instead of queueing it (see WDL_ConvolutionEngine_Div's
+  // small block mode). Avail() then processes every complete block of input, whatever it's asked for.
+  void SetOutputRing(WDL_ConvolutionOutputRing *ring, WDL_INT64 pos);
+  WDL_INT64 GetOutputRingPos() const { return m_outring_pos[0]; } // end of the output added so far
+  bool IsBlockDue() const { return m_fft_size<1 || InputAvailable(0) >= m_fft_size/2; } // Avail() has work
+
+  // JF: complete blocks of input not processed yet. RunBlocks() processes up to maxblocks of them for each
+  // channel whether their output is wanted yet or not, see WDL_ConvolutionEngine_Div::SetLoadBalance().
+  int GetBlocksDue() const { return m_fft_size<1 ? 0 : InputAvailable(0)/(m_fft_size/2); }
+  void RunBlocks(int maxblocks);
+  int GetOutputQueued() const { return m_samplesout[0].Available()/(int)sizeof(WDL_FFT_REAL); }
+  double GetBlockCost() const; // estimated work (~flops) a block takes for one channel
+
 private:
+  void SetProcChannels(int nch);
+
+  bool IsTrueStereo() const { return m_zl_truestereo && m_impulse_nch==4 && m_proc_nch==2; }
+  int AvailTrueStereo(int want, WDL_FFT_REAL *workbuf2);
+
+  int InputChannel(int ch) const { return m_inring_mono ? 0 : ch; }
+  int InputAvailable(int ch) const;
+  void InputGetToBuf(int ch, WDL_FFT_REAL *buf, int len) const;
+  void InputAdvance(int ch, int len);
+  bool InputDiffers(int ch, const WDL_FFT_REAL *buf, int len) const;
+  void AddFromRing(int nch);
+  bool OutputWanted(int ch, int want) const { return m_outring || m_samplesout[ch].Available() < want*(int)sizeof(WDL_FFT_REAL); }
+  void Output(int ch, const WDL_FFT_REAL *buf, int len);
+
   WDL_TypedBuf<WDL_CONVO_IMPULSEBUFf> m_impulse[WDL_CONVO_MAX_IMPULSE_NCH]; // FFT'd data blocks per channel
   WDL_TypedBuf<char> m_impulse_zflag[WDL_CONVO_MAX_IMPULSE_NCH]; // FFT'd data blocks per channel
 
@@ -145,21 +280,45 @@ private:
 
   WDL_FFT_REAL *m_get_tmpptrs[WDL_CONVO_MAX_PROC_NCH];
 
+  WDL_ConvolutionInputRing *m_inring;
+  bool m_inring_mono;
+  WDL_INT64 m_inring_pos[WDL_CONVO_MAX_PROC_NCH];
+
+  WDL_ConvolutionOutputRing *m_outring;
+  WDL_INT64 m_outring_pos[WDL_CONVO_MAX_PROC_NCH];
+
+  WDL_ConvolutionFFTBackend *m_fft_pref;
+  WDL_ConvolutionFFTBackend *m_fft;
+
+  int m_block_limit; // per channel per Avail(), 0 for no limit, see RunBlocks()
+
 public:
 
   // _div stuff
   int m_zl_delaypos;
   int m_zl_dumpage;
+  bool m_zl_truestereo; // JF: see WDL_ConvolutionEngine_Div::SetTrueStereo(), set before SetImpulse()
 
 //#define WDLCONVO_ZL_ACCOUNTING
-#ifdef WDLCONVO_ZL_ACCOUNTING
-  int m_zl_fftcnt;//removeme (testing of benchmarks)
-#endif
+  int m_zl_fftcnt; // JF: blocks processed (per channel), was WDLCONVO_ZL_ACCOUNTING only, see WDL_ConvolutionAccounting
   void AddSilenceToOutput(int len, int nch);
 
 } WDL_FIXALIGN;
 
 // low latency version
+// JF: what a WDL_ConvolutionEngine_Div's FFT partitions did in each call of Avail()/AvailTo() since
+// ResetAccounting(). Work is estimated (WDL_ConvolutionEngine::GetBlockCost()), not timed. Replaces the
+// Windows only WDLCONVO_ZL_ACCOUNTING debug output.
+struct WDL_ConvolutionAccounting
+{
+  int calls;
+  int max_engines; // most partitions that processed a block in one call
+  int max_blocks; // most blocks (per channel) in one call
+  double max_cost; // most work in one call
+  double total_cost;
+  WDL_INT64 total_samples;
+};
+
 class WDL_ConvolutionEngine_Div
 {
 public:
@@ -177,14 +336,102 @@ public:
   WDL_FFT_REAL **Get(); // returns length valid
   void Advance(int len);
 
+  // JF: Avail()+Get()+Advance() in one, without the output queue: sums the engines' output straight into
+  // dest[0..nch-1] (which may be the buffers just passed to Add()). Returns samples written, any shortfall
+  // up to len is zeroed.
+  int AvailTo(WDL_FFT_REAL **dest, int nch, int len);
+
+  // JF: mono source into a multichannel impulse: Add() reads only bufs[0], and nch is the number of outputs.
+  // Each input block is FFT'd once and multiplied against impulse channel pairs. Resets the engine.
+  void SetMonoInput(bool mono);
+  bool GetMonoInput() const { return m_mono_input; }
+
+  // JF: true stereo: 2 channels in and out, with a 4 channel impulse [LL, LR, RL, RR], i.e.
+  // L out = L*LL + R*RL, R out = L*LR + R*RR. Each input is FFT'd once per partition and the products are
+  // summed in the frequency domain, so only one IFFT per partition. Without a 4 channel impulse, or with
+  // other than 2 channels, processing is as normal.
+  // isn't actually enabled/disabled until next SetImpulse() call
+  void SetTrueStereo(bool enable) { m_true_stereo = enable; }
+  bool GetTrueStereo() const { return m_true_stereo; }
+
+  // JF: zero latency head length, direct form (vectorised), was fixed at 64. The FFT partitions that follow
+  // start at twice this, so a longer head replaces the smallest FFT stages, cheaper when the FIR kernel is
+  // fast and host blocks are small. Rounded up to a power of 2, WDL_CONVO_MIN/MAX_BRUTE_SIZE.
+  // isn't actually enabled/disabled until next SetImpulse() call
+  void SetBruteSize(int size);
+  int GetBruteSize() const { return m_brute_size; }
+
+  // JF: how fast the partitions grow, was fixed at 3: each partition after the first is this many blocks of
+  // the FFT size the latency allows there, so the FFT sizes go up (blocks+1)x at a time. 1 doubles them
+  // (more, smaller FFTs), bigger values hold each size longer (fewer sizes, more multiply-accumulate).
+  // Clamped to 1..WDL_CONVO_MAX_SEGMENT_BLOCKS.
+  // isn't actually enabled/disabled until next SetImpulse() call
+  void SetSegmentBlocks(int blocks);
+  int GetSegmentBlocks() const { return m_segment_blocks; }
+
+  // JF: FFT backends in order of preference, each partition runs the first that supports its size, the
+  // default otherwise (see WDL_ConvolutionFFTBackend). Not owned. GetFFTBackend() is the one partition
+  // index runs, NULL for the brute force head.
+  // isn't actually enabled/disabled until next SetImpulse() call
+  void SetFFTBackends(WDL_ConvolutionFFTBackend * const *list, int n);
+  WDL_ConvolutionFFTBackend *GetFFTBackend(int index) const;
+
+  // JF: load balancing. Was: every partition ran as soon as a block of its input was complete, and however
+  // they're staggered, several can complete in the same call, a periodic spike. With it the partitions
+  // after the first get half the FFT size the latency allows, so a block's output isn't due until a block
+  // after its input is complete. Each call runs what's due, then the waiting blocks due soonest while the
+  // call's work stays within the average per call (or the biggest single block, if that's more). Costs
+  // more on average (twice the multiply-accumulates in those partitions), flattens the worst call.
+  // isn't actually enabled/disabled until next SetImpulse() call
+  void SetLoadBalance(bool enable) { m_load_balance=enable; }
+  bool GetLoadBalance() const { return m_load_balance; }
+
+  // JF: see WDL_ConvolutionAccounting
+  const WDL_ConvolutionAccounting &GetAccounting() const { return m_accounting; }
+  void ResetAccounting();
+
+  // JF: see WDL_ConvolutionEngine::Prepare()/EnumBuffers(), call after SetImpulse()
+  // Blocks of up to WDL_CONVO_SMALL_BLOCK_MAX switch to small block mode: the engines add their output
+  // straight into one output ring at the time it's due, the brute force head runs inline on each Add(), and
+  // the FFT engines are only called on the blocks where one of their partitions fills up. Until the next
+  // SetImpulse().
+  void Prepare(int nch, int maxblocklen);
+  bool GetSmallBlockMode() const { return m_small; }
+  void EnumBuffers(void (*func)(void *ctx, void *buf, int bytes), void *ctx);
+
 private:
+  void FeedSilence();
+  int SmallProcess(); // runs the engines that are due, returns samples ready in m_outring
+  WDL_ConvolutionFFTBackend *ChooseFFTBackend(int len); // prepared for len, NULL if no backend does it
+  void BeginCall(); // clears the engines' block counts
+  void EndCall(int len); // runs waiting blocks if load balancing, accounts for the call
+  int EngineSlack(int x) const; // samples of engine x's output ahead of what's been asked for
+
   WDL_PtrList<WDL_ConvolutionEngine> m_engines;
+  WDL_ConvolutionInputRing m_inring; // JF: the engines' input, see WDL_ConvolutionEngine::SetInputRing()
+  WDL_ConvolutionOutputRing m_outring; // JF: and their output in small block mode
 
   WDL_Queue m_samplesout[WDL_CONVO_MAX_PROC_NCH];
   WDL_FFT_REAL *m_get_tmpptrs[WDL_CONVO_MAX_PROC_NCH];
 
   int m_proc_nch;
   bool m_need_feedsilence;
+  bool m_mono_input;
+  bool m_true_stereo;
+  int m_brute_size;
+  int m_segment_blocks;
+  bool m_load_balance;
+  bool m_balanced; // as of SetImpulse()
+  double m_lb_cost; // work & samples so far, for the average per call
+  WDL_INT64 m_lb_samples;
+  double m_lb_peak; // biggest single block, one channel
+  WDL_ConvolutionAccounting m_accounting;
+  WDL_PtrList<WDL_ConvolutionFFTBackend> m_fft_backends;
+
+  bool m_small; // JF: small block mode, see Prepare()
+  int m_small_maxblock;
+  int m_small_lead; // furthest ahead of the input an engine writes output
+  WDL_INT64 m_small_inpos; // ring write pos of input time 0
 
 } WDL_FIXALIGN;
 
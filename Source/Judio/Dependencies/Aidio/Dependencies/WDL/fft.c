@@ -32,8 +32,16 @@
 // this is based on djbfft
 
 #include <math.h>
+#include <stdlib.h>
 #include "fft.h"
 
+// JF: one-time table init and mixed radix plan registration are thread safe
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
 
 #define FFT_MAXBITLEN 15
 
@@ -55,6 +63,9 @@ static WDL_FFT_COMPLEX d4096[511];
 static WDL_FFT_COMPLEX d8192[1023];
 static WDL_FFT_COMPLEX d16384[2047];
 static WDL_FFT_COMPLEX d32768[4095];
+static WDL_FFT_COMPLEX d65536[8191]; // JF: up to WDL_FFT_MAX_SIZE, for the far tail of long impulses
+static WDL_FFT_COMPLEX d131072[16383];
+static WDL_FFT_COMPLEX d262144[32767];
 
 
 #define sqrthalf (d16[1].re)
@@ -575,6 +586,30 @@ static void c32768(register WDL_FFT_COMPLEX *a)
   c16384(a);
 }
 
+static void c65536(register WDL_FFT_COMPLEX *a)
+{
+  cpassbig(a,d65536,8192);
+  c16384(a + 32768 + 16384);
+  c16384(a + 32768);
+  c32768(a);
+}
+
+static void c131072(register WDL_FFT_COMPLEX *a)
+{
+  cpassbig(a,d131072,16384);
+  c32768(a + 65536 + 32768);
+  c32768(a + 65536);
+  c65536(a);
+}
+
+static void c262144(register WDL_FFT_COMPLEX *a)
+{
+  cpassbig(a,d262144,32768);
+  c65536(a + 131072 + 65536);
+  c65536(a + 131072);
+  c131072(a);
+}
+
 
 /* n even, n > 0 */
 void WDL_fft_complexmul(WDL_FFT_COMPLEX *a,WDL_FFT_COMPLEX *b,int n)
@@ -962,6 +997,30 @@ static void u32768(register WDL_FFT_COMPLEX *a)
   upassbig(a,d32768,4096);
 }
 
+static void u65536(register WDL_FFT_COMPLEX *a)
+{
+  u32768(a);
+  u16384(a + 32768);
+  u16384(a + 32768 + 16384);
+  upassbig(a,d65536,8192);
+}
+
+static void u131072(register WDL_FFT_COMPLEX *a)
+{
+  u65536(a);
+  u32768(a + 65536);
+  u32768(a + 65536 + 32768);
+  upassbig(a,d131072,16384);
+}
+
+static void u262144(register WDL_FFT_COMPLEX *a)
+{
+  u131072(a);
+  u65536(a + 131072);
+  u65536(a + 131072 + 65536);
+  upassbig(a,d262144,32768);
+}
+
 
 static void __fft_gen(WDL_FFT_COMPLEX *buf, const WDL_FFT_COMPLEX *buf2, int sz, int isfull)
 {
@@ -1027,13 +1086,10 @@ int *WDL_fft_permute_tab(int fftsize)
 
 #endif
 
-void WDL_fft_init()
+static void fft_init_tables(void)
 {
-  static int ffttabinit;
-  if (!ffttabinit)
   {
     int i, offs;
-  	ffttabinit=1;
 
 #define fft_gen(x,y,z) __fft_gen(x,y,sizeof(x)/sizeof(x[0]),z)
     fft_gen(d16,0,1);
@@ -1048,6 +1104,9 @@ void WDL_fft_init()
     fft_gen(d8192,d4096,0);
     fft_gen(d16384,d8192,0);
     fft_gen(d32768,d16384,0);
+    fft_gen(d65536,d32768,0);
+    fft_gen(d131072,d65536,0);
+    fft_gen(d262144,d131072,0);
 #undef fft_gen
 
 #ifndef WDL_FFT_NO_PERMUTE
@@ -1062,6 +1121,239 @@ void WDL_fft_init()
   }
 }
 
+// JF: was a static flag, so two threads could both build the tables or one could use them half built
+#ifdef _WIN32
+static BOOL CALLBACK fft_init_once_cb(PINIT_ONCE once, PVOID param, PVOID *ctx)
+{
+  fft_init_tables();
+  return TRUE;
+}
+
+void WDL_fft_init()
+{
+  static INIT_ONCE once = INIT_ONCE_STATIC_INIT;
+  InitOnceExecuteOnce(&once,fft_init_once_cb,NULL,NULL);
+}
+#else
+void WDL_fft_init()
+{
+  static pthread_once_t once = PTHREAD_ONCE_INIT;
+  pthread_once(&once,fft_init_tables);
+}
+#endif
+
+// JF: mixed radix (2, 3, 4, 5) transforms for the sizes that aren't powers of two, e.g. 960 = 4*4*4*3*5,
+// so FFT partitions can match 480/960/1440 sample host blocks. Decimation in frequency in place, the
+// output is in digit reversed order (like the permuted power of two output, fine for convolution), and
+// the inverse undoes it exactly, unscaled. Twiddles are made per size by WDL_fft_init_size().
+
+#define MIXED_MAX_FACTORS 32
+#define MIXED_MAX_SIZES 64
+
+typedef struct
+{
+  int len;
+  int nfactors;
+  int factors[MIXED_MAX_FACTORS];   // outermost pass first
+  WDL_FFT_COMPLEX *tw;              // exp(-2*pi*i*k/len)
+} mixed_plan;
+
+static mixed_plan *mixed_plans[MIXED_MAX_SIZES];
+static volatile int mixed_nplans;
+
+// registration is serialised, lookups aren't locked: a plan is complete before the count that covers it
+// is published (release), and readers load the count with acquire
+#ifdef _WIN32
+static SRWLOCK mixed_lock = SRWLOCK_INIT;
+#define MIXED_LOCK() AcquireSRWLockExclusive(&mixed_lock)
+#define MIXED_UNLOCK() ReleaseSRWLockExclusive(&mixed_lock)
+#define MIXED_LOAD_COUNT() ((int)InterlockedCompareExchange((volatile LONG *)&mixed_nplans,0,0))
+#define MIXED_PUBLISH_COUNT(n) InterlockedExchange((volatile LONG *)&mixed_nplans,(n))
+#else
+static pthread_mutex_t mixed_lock = PTHREAD_MUTEX_INITIALIZER;
+#define MIXED_LOCK() pthread_mutex_lock(&mixed_lock)
+#define MIXED_UNLOCK() pthread_mutex_unlock(&mixed_lock)
+#define MIXED_LOAD_COUNT() __atomic_load_n(&mixed_nplans,__ATOMIC_ACQUIRE)
+#define MIXED_PUBLISH_COUNT(n) __atomic_store_n(&mixed_nplans,(n),__ATOMIC_RELEASE)
+#endif
+
+static int mixed_factorize(int len, int *factors)
+{
+  int n=0;
+  while (len > 1 && n < MIXED_MAX_FACTORS)
+  {
+    if (len%4 == 0) { factors[n++]=4; len/=4; }
+    else if (len%2 == 0) { factors[n++]=2; len/=2; }
+    else if (len%3 == 0) { factors[n++]=3; len/=3; }
+    else if (len%5 == 0) { factors[n++]=5; len/=5; }
+    else return 0;
+  }
+  return len == 1 ? n : 0;
+}
+
+static const mixed_plan *mixed_find(int len)
+{
+  int x;
+  const int n=MIXED_LOAD_COUNT();
+  for (x = 0; x < n; x ++) if (mixed_plans[x]->len == len) return mixed_plans[x];
+  return NULL;
+}
+
+int WDL_fft_size_supported(int len)
+{
+  int factors[MIXED_MAX_FACTORS];
+  if (!(len&(len-1))) return len >= 2 && len <= WDL_FFT_MAX_SIZE;
+  return len <= 32768 && mixed_factorize(len,factors) > 0;
+}
+
+int WDL_fft_init_size(int len)
+{
+  mixed_plan *plan;
+  int k;
+
+  WDL_fft_init();
+  if (!WDL_fft_size_supported(len)) return 0;
+  if (!(len&(len-1)) || mixed_find(len)) return 1;
+
+  MIXED_LOCK();
+  if (mixed_find(len)) { MIXED_UNLOCK(); return 1; } // another thread got there first
+  if (mixed_nplans >= MIXED_MAX_SIZES) { MIXED_UNLOCK(); return 0; }
+
+  plan=(mixed_plan *)malloc(sizeof(mixed_plan));
+  if (plan) plan->tw=(WDL_FFT_COMPLEX *)malloc(len*sizeof(WDL_FFT_COMPLEX));
+  if (!plan || !plan->tw) { free(plan); MIXED_UNLOCK(); return 0; }
+
+  plan->len=len;
+  plan->nfactors=mixed_factorize(len,plan->factors);
+  for (k = 0; k < len; k ++)
+  {
+    plan->tw[k].re = (WDL_FFT_REAL) cos(2.0*PI*k/len);
+    plan->tw[k].im = (WDL_FFT_REAL) -sin(2.0*PI*k/len);
+  }
+
+  mixed_plans[mixed_nplans]=plan;
+  MIXED_PUBLISH_COUNT(mixed_nplans+1);
+  MIXED_UNLOCK();
+  return 1;
+}
+
+// radix r DFT of x[0], x[m], ..., x[(r-1)*m] in place, sign -1 forward, +1 inverse
+static inline void mixed_butterfly(WDL_FFT_COMPLEX *x, int m, int r, WDL_FFT_REAL sign)
+{
+  WDL_FFT_COMPLEX a0, a1, a2, a3, a4;
+  WDL_FFT_REAL t1r, t1i, t2r, t2i, t3r, t3i, t4r, t4i;
+
+  switch (r)
+  {
+    case 2:
+      a0=x[0]; a1=x[m];
+      x[0].re=a0.re+a1.re; x[0].im=a0.im+a1.im;
+      x[m].re=a0.re-a1.re; x[m].im=a0.im-a1.im;
+    break;
+    case 3:
+    {
+      const WDL_FFT_REAL s=(WDL_FFT_REAL) (sign*0.86602540378443864676);
+      a0=x[0]; a1=x[m]; a2=x[2*m];
+      t1r=a1.re+a2.re; t1i=a1.im+a2.im;
+      t2r=a0.re-0.5f*t1r; t2i=a0.im-0.5f*t1i;
+      t3r=s*(a1.re-a2.re); t3i=s*(a1.im-a2.im); // times sign*sin(2pi/3), i applied below
+      x[0].re=a0.re+t1r; x[0].im=a0.im+t1i;
+      x[m].re=t2r-t3i; x[m].im=t2i+t3r;
+      x[2*m].re=t2r+t3i; x[2*m].im=t2i-t3r;
+    }
+    break;
+    case 4:
+      a0=x[0]; a1=x[m]; a2=x[2*m]; a3=x[3*m];
+      t1r=a0.re+a2.re; t1i=a0.im+a2.im;
+      t2r=a0.re-a2.re; t2i=a0.im-a2.im;
+      t3r=a1.re+a3.re; t3i=a1.im+a3.im;
+      t4r=sign*(a1.re-a3.re); t4i=sign*(a1.im-a3.im); // sign*(a1-a3), times i below
+      x[0].re=t1r+t3r; x[0].im=t1i+t3i;
+      x[2*m].re=t1r-t3r; x[2*m].im=t1i-t3i;
+      x[m].re=t2r-t4i; x[m].im=t2i+t4r;
+      x[3*m].re=t2r+t4i; x[3*m].im=t2i-t4r;
+    break;
+    case 5:
+    {
+      const WDL_FFT_REAL c1=(WDL_FFT_REAL) 0.30901699437494742410, c2=(WDL_FFT_REAL) -0.80901699437494742410;
+      const WDL_FFT_REAL s1=(WDL_FFT_REAL) (sign*0.95105651629515357212), s2=(WDL_FFT_REAL) (sign*0.58778525229247312917);
+      WDL_FFT_REAL b1r, b1i, b2r, b2i;
+      a0=x[0]; a1=x[m]; a2=x[2*m]; a3=x[3*m]; a4=x[4*m];
+      t1r=a1.re+a4.re; t1i=a1.im+a4.im;
+      t2r=a2.re+a3.re; t2i=a2.im+a3.im;
+      t3r=a1.re-a4.re; t3i=a1.im-a4.im;
+      t4r=a2.re-a3.re; t4i=a2.im-a3.im;
+      b1r=s1*t3r+s2*t4r; b1i=s1*t3i+s2*t4i;
+      b2r=s2*t3r-s1*t4r; b2i=s2*t3i-s1*t4i;
+      x[0].re=a0.re+t1r+t2r; x[0].im=a0.im+t1i+t2i;
+      a1.re=a0.re+c1*t1r+c2*t2r; a1.im=a0.im+c1*t1i+c2*t2i;
+      a2.re=a0.re+c2*t1r+c1*t2r; a2.im=a0.im+c2*t1i+c1*t2i;
+      x[m].re=a1.re-b1i; x[m].im=a1.im+b1r;
+      x[4*m].re=a1.re+b1i; x[4*m].im=a1.im-b1r;
+      x[2*m].re=a2.re-b2i; x[2*m].im=a2.im+b2r;
+      x[3*m].re=a2.re+b2i; x[3*m].im=a2.im-b2r;
+    }
+    break;
+  }
+}
+
+static inline void mixed_twiddle(WDL_FFT_COMPLEX *x, const WDL_FFT_COMPLEX *w, WDL_FFT_REAL wsign)
+{
+  const WDL_FFT_REAL wr=w->re, wi=wsign*w->im, xr=x->re;
+  x->re=xr*wr-x->im*wi;
+  x->im=xr*wi+x->im*wr;
+}
+
+// one pass of radix r over blocks of L, forward (DIF: butterfly then twiddle) or inverse (DIT: the reverse)
+static inline void mixed_pass(WDL_FFT_COMPLEX *buf, const mixed_plan *plan, int r, int L, int isInverse)
+{
+  const int n=plan->len, m=L/r, step=n/L;
+  const WDL_FFT_REAL sign=isInverse ? 1.0f : -1.0f;
+  WDL_FFT_COMPLEX *x;
+  int b, j, p;
+
+  for (j = 0; j < m; j ++) // j outermost so the twiddles are read once a pass
+  {
+    const WDL_FFT_COMPLEX *tw=plan->tw+j*step;
+    for (b = j; b < n; b += L)
+    {
+      x=buf+b;
+      if (!isInverse) mixed_butterfly(x,m,r,sign);
+      if (j) for (p = 1; p < r; p ++) mixed_twiddle(x+p*m,tw+(p-1)*j*step,-sign);
+      if (isInverse) mixed_butterfly(x,m,r,sign);
+    }
+  }
+}
+
+static void mixed_pass_r(WDL_FFT_COMPLEX *buf, const mixed_plan *plan, int r, int L, int isInverse)
+{
+  switch (r) // constant radix, so each gets its own loop with the butterfly inlined
+  {
+    case 2: if (isInverse) mixed_pass(buf,plan,2,L,1); else mixed_pass(buf,plan,2,L,0); break;
+    case 3: if (isInverse) mixed_pass(buf,plan,3,L,1); else mixed_pass(buf,plan,3,L,0); break;
+    case 4: if (isInverse) mixed_pass(buf,plan,4,L,1); else mixed_pass(buf,plan,4,L,0); break;
+    case 5: if (isInverse) mixed_pass(buf,plan,5,L,1); else mixed_pass(buf,plan,5,L,0); break;
+  }
+}
+
+static void mixed_fft(WDL_FFT_COMPLEX *buf, const mixed_plan *plan, int isInverse)
+{
+  int f, L;
+  if (!isInverse)
+  {
+    for (f = 0, L = plan->len; f < plan->nfactors; L /= plan->factors[f], f ++)
+      mixed_pass_r(buf,plan,plan->factors[f],L,0);
+  }
+  else
+  {
+    for (f = plan->nfactors-1, L = 1; f >= 0; f --)
+    {
+      L *= plan->factors[f];
+      mixed_pass_r(buf,plan,plan->factors[f],L,1);
+    }
+  }
+}
+
 void WDL_fft(WDL_FFT_COMPLEX *buf, int len, int isInverse)
 {
   switch (len)
@@ -1082,7 +1374,16 @@ void WDL_fft(WDL_FFT_COMPLEX *buf, int len, int isInverse)
     TMP(8192)
     TMP(16384)
     TMP(32768)
+    TMP(65536)
+    TMP(131072)
+    TMP(262144)
 #undef TMP
+    default:
+    {
+      const mixed_plan *plan=mixed_find(len); // JF: see WDL_fft_init_size()
+      if (plan) mixed_fft(buf,plan,isInverse);
+    }
+    break;
   }
 }
 
@@ -51,6 +51,7 @@ typedef struct {
   WDL_FFT_REAL im;
 } WDL_FFT_COMPLEX;
 
+/* JF: safe to call from any thread, the tables are built exactly once. */
 extern void WDL_fft_init();
 
 extern void WDL_fft_complexmul(WDL_FFT_COMPLEX *dest, WDL_FFT_COMPLEX *src, int len);
@@ -61,6 +62,17 @@ extern void WDL_fft_complexmul3(WDL_FFT_COMPLEX *destAdd, WDL_FFT_COMPLEX *src,
 WDL_FFT_COMPLEX output[0..len-1] order by WDL_fft_permute(len). */
 extern void WDL_fft(WDL_FFT_COMPLEX *, int len, int isInverse);
 
+/* JF: WDL_fft() goes up to this, WDL_real_fft() and WDL_fft_permute() still
+stop at 32768. */
+#define WDL_FFT_MAX_SIZE 262144
+
+/* JF: WDL_fft() also takes sizes that are products of 2, 3 and 5 (e.g. 960,
+1440), once WDL_fft_init_size() has made their twiddles (not on the audio
+thread, thread safe). Their output is in digit reversed order, for which there's no
+WDL_fft_permute(). WDL_real_fft() is still powers of two only. */
+extern int WDL_fft_size_supported(int len);
+extern int WDL_fft_init_size(int len); /* returns 0 if unsupported */
+
 /* Expects WDL_FFT_REAL input[0..len-1] scaled by 0.5/len, returns
 WDL_FFT_COMPLEX output[0..len/2-1], for len >= 4 order by
 WDL_fft_permute(len/2). Note that output[len/2].re is stored in
@@ -0,0 +1,132 @@
+//==============================================================================
+/*
+    The MIT License (MIT)
+
+    Copyright (c) 2016 John Flynn
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to
+    deal in the Software without restriction, including without limitation the
+    rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+    sell copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+    IN THE SOFTWARE.
+*/
+
+#ifndef KERNELS_H_INCLUDED
+#define KERNELS_H_INCLUDED
+
+namespace ado
+{
+
+//==============================================================================
+/** Vectorised single channel buffer operations.
+
+    Each has scalar, SSE2, AVX2 (+FMA) and AVX-512 versions. The best the CPU
+    and OS support is picked the first time any of them is called. Pointers
+    needn't be aligned, but ado::Buffer channels are (64 bytes) which is 
+    fastest. Lengths needn't be a multiple of anything.
+
+    @example    ado::vectorScale (buffer.getWriteArray()[0], 0.5f, numSamples);
+*/
+enum class SimdLevel { scalar = 0, sse2, avx2, avx512 };
+
+SimdLevel getHighestSupportedSimdLevel();   // detected once
+SimdLevel getSimdLevel();                   // in use
+void setSimdLevel (SimdLevel level);        // for tests/benchmarks, clamped to supported
+
+//==============================================================================
+/** dest = src. Doesn't handle overlap. */
+void vectorCopy (const float* src, float* dest, int numSamples);
+
+/** data *= gain */
+void vectorScale (float* data, float gain, int numSamples);
+
+/** dest += src */
+void vectorAdd (const float* src, float* dest, int numSamples);
+
+/** dest += src * gain */
+void vectorAddScaled (const float* src, float* dest, float gain, int numSamples);
+
+/** dest = a * gainA + b * gainB. dest may be a or b. */
+void vectorMix (const float* a, float gainA, const float* b, float gainB, float* dest, int numSamples);
+
+/** As vectorMix() but each gain ramps linearly from its start value at the
+    first sample towards its end value, which it reaches at the sample after
+    the block (same as juce::AudioBuffer::applyGainRamp) so consecutive blocks
+    join up. dest may be a or b.
+*/
+void vectorMixRamped (const float* a, float gainAStart, float gainAEnd,
+                      const float* b, float gainBStart, float gainBEnd,
+                      float* dest, int numSamples);
+
+/** dest = src * gain, gain ramped as vectorMixRamped(). dest may be src. */
+void vectorScaleRamped (const float* src, float* dest, float gainStart, float gainEnd, int numSamples);
+
+/** Sum of all samples. Accumulates in double. */
+float vectorSum (const float* data, int numSamples);
+
+/** Largest absolute sample value. */
+float vectorPeak (const float* data, int numSamples);
+
+/** True if every sample is exactly equal. */
+bool vectorEquals (const float* a, const float* b, int numSamples);
+
+/** Direct form FIR as a sliding dot product:
+    dest[i] (+)= sum of reversedTaps[k] * src[i + k] for k < numTaps
+    i.e. the impulse is stored back to front, and src starts numTaps - 1
+    samples of history before the first output's input. The SIMD versions
+    accumulate in float, the scalar one in double. dest mustn't overlap src.
+*/
+void vectorFir (const float* reversedTaps, int numTaps, const float* src,
+                float* dest, int numSamples, bool accumulate);
+
+/** Complex multiply-accumulate on split real & imaginary arrays,
+    acc[i] += x[i] * h[i], as a spectrum by an impulse's.
+*/
+void vectorComplexMultiplyAdd (const float* xRe, const float* xIm, const float* hRe, const float* hIm,
+                               float* accRe, float* accIm, int numSamples);
+
+/** numDots dot products of numSamples each, every one at its own offsets:
+    dest[j] = sum of a[aOffsets[j] + i] * b[bOffsets[j] + i]
+    e.g. a run of polyphase FIR outputs, each its phase's taps against its
+    input. The SIMD versions do 4 at once & accumulate in float, the scalar
+    one in double.
+*/
+void vectorDots (const float* a, const int* aOffsets, const float* b, const int* bOffsets,
+                 float* dest, int numDots, int numSamples);
+
+//==============================================================================
+/** For double precision hosts, around float processing: the same ramps,
+    computed in double.
+*/
+void vectorCopy (const double* src, double* dest, int numSamples);
+
+/** dest = src, rounded to float. */
+void vectorConvert (const double* src, float* dest, int numSamples);
+
+/** vectorMixRamped() in double. dest may be a or b. */
+void vectorMixRamped (const double* a, float gainAStart, float gainAEnd,
+                      const double* b, float gainBStart, float gainBEnd,
+                      double* dest, int numSamples);
+
+/** Mixed precision vectorMixRamped(), e.g. a float wet into a double dry:
+    b is widened, the sum never rounded to float. dest may be a.
+*/
+void vectorMixRamped (const double* a, float gainAStart, float gainAEnd,
+                      const float* b, float gainBStart, float gainBEnd,
+                      double* dest, int numSamples);
+
+} // namespace
+
+#endif  // KERNELS_H_INCLUDED
@@ -0,0 +1,107 @@
+//==============================================================================
+/*
+    The MIT License (MIT)
+
+    Copyright (c) 2016 John Flynn
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to
+    deal in the Software without restriction, including without limitation the
+    rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+    sell copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+    IN THE SOFTWARE.
+*/
+
+#ifndef MEMORY_H_INCLUDED
+#define MEMORY_H_INCLUDED
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace ado
+{
+
+//==============================================================================
+/** Write to every page of a block of memory so the OS maps it in now, rather 
+    than on first use (on the audio thread). Returns the number of bytes touched.
+*/
+size_t prefaultMemory (void* data, size_t numBytes);
+
+//==============================================================================
+/** Page-lock a block of memory (mlock / VirtualLock) so it can't be paged out.
+    Returns false if the OS refused, e.g. RLIMIT_MEMLOCK exceeded. Locks are
+    counted per page, so unlocking a block leaves pages it shares with other
+    still-locked blocks locked. Pair every successful lock with one unlock.
+*/
+bool lockMemory (void* data, size_t numBytes);
+void unlockMemory (void* data, size_t numBytes);
+
+//==============================================================================
+/** Max bytes this process may page-lock. SIZE_MAX if unlimited, 0 if unknown.
+*/
+size_t getMemoryLockLimit();
+
+//==============================================================================
+/** Outcome of prefaulting/locking a set of memory blocks.
+*/
+struct MemoryLockReport
+{
+    size_t bytesTouched {0};
+    size_t bytesLocked {0};
+    size_t lockLimit {0};       // see getMemoryLockLimit()
+    bool lockFailed {false};    // locking requested but (partly) refused
+};
+
+//==============================================================================
+/** Prefaults, and optionally locks, a set of memory blocks. Remembers what it
+    locked so it can be unlocked before the memory is freed or reallocated.
+
+    @example    ado::MemoryLocker locker;
+                locker.add (data, numBytes);    // repeat for each block
+                locker.lock (true);             // false == prefault only
+                DBG (locker.getReport().bytesLocked);
+                ...
+                locker.clear();                 // before freeing the blocks
+*/
+class MemoryLocker
+{
+public:
+    MemoryLocker() {}
+    ~MemoryLocker() { clear(); }
+
+    MemoryLocker (const MemoryLocker&) = delete;
+    MemoryLocker& operator=(const MemoryLocker&) = delete;
+
+    void add (void* data, size_t numBytes);
+    void lock (bool shouldLock);
+    void clear();               // unlocks anything locked and forgets all blocks
+
+    const MemoryLockReport& getReport() const noexcept { return report; }
+
+private:
+    struct Block
+    {
+        void* data;
+        size_t numBytes;
+        bool isLocked;
+    };
+
+    std::vector<Block> blocks;
+    MemoryLockReport report;
+};
+
+} // namespace
+
+#endif  // MEMORY_H_INCLUDED
@@ -0,0 +1,127 @@
+//==============================================================================
+/*
+    The MIT License (MIT)
+
+    Copyright (c) 2016 John Flynn
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to
+    deal in the Software without restriction, including without limitation the
+    rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+    sell copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+    IN THE SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef MULTISTREAMCONVOLUTION_H_INCLUDED
+#define MULTISTREAMCONVOLUTION_H_INCLUDED
+
+#include <memory>
+#include <vector>
+
+#include "Buffer.h"
+#include "Convolution.h"
+
+
+namespace ado
+{
+
+//==============================================================================
+/** Many mono streams convolved with one impulse at once: the voices of a
+    batch, the files of a render farm. Zero latency, uniformly partitioned
+    (blocks of blockSize, FFTs of twice that).
+
+    Where ado::Convolution runs a WDL engine per stream, each with its own
+    copy of the impulse's spectra, this shares one (Spectra) and batches the
+    streams through every step:
+    - two streams per FFT, as the real & imaginary parts of one complex FFT
+      (the impulse is real, so the convolutions come back apart), half the
+      FFTs of a stream at a time.
+    - up to maxBlocksAtOnce blocks a pass, a tile of bins at a time: each
+      tile of every stream's history is read into cache once for all of the
+      blocks, and each tile of the impulse once for all of the streams. A
+      block at a time the pass only streams the history through, a multiply-
+      add per load, and stalls on memory once it outgrows the cache.
+
+    So throughput per stream is twice a lone stream's from two streams on,
+    with the impulse once in memory, and larger calls to process() (multiples
+    of maxBlocksAtOnce blocks) are faster. Each block still has zero latency.
+
+    Not real time safe to construct; process() allocates nothing.
+
+    @example    auto spectra = std::make_shared<const ado::MultiStreamConvolution::Spectra> (ir, 0, 1024);
+                ado::MultiStreamConvolution engine {spectra, 16};
+                engine.process (voices, 16 * 1024);   // in place, 16 streams
+*/
+class MultiStreamConvolution
+{
+public:
+    /** One channel of an impulse, sliced into blockSize partitions and
+        transformed, ready to share between engines (& threads, it's const).
+    */
+    class Spectra
+    {
+    public:
+        /** blockSize: a power of two, 16 - 16384. */
+        Spectra (const ado::Buffer& impulse, int channel, int blockSize);
+
+        int getBlockSize() const noexcept { return blockSize; }
+        int getNumPartitions() const noexcept { return numPartitions; }
+
+    private:
+        friend class MultiStreamConvolution;
+
+        const int blockSize;
+        const int numPartitions;
+        ado::Buffer re, im;                     // [partition][bin], scaled by 1 / fft size
+    };
+
+    MultiStreamConvolution (std::shared_ptr<const Spectra> impulseSpectra, int numStreams);
+
+    /** Convolves each stream in place, numSamples a multiple of the block
+        size, wet only.
+    */
+    void process (float* const* streams, int numSamples);
+
+    /** Clears the streams' history, as new. */
+    void reset();
+
+    int getNumStreams() const noexcept { return numStreams; }
+    int getBlockSize() const noexcept { return blockSize; }
+
+private:
+    static constexpr int maxBlocksAtOnce {8};
+    static constexpr int tileSize {512};        // bins, 2kB a plane
+
+    void processBlocks (float* const* streams, int offset, int numBlocks);
+
+    const std::shared_ptr<const Spectra> spectra;
+    const int numStreams;
+    const int numPairs;                         // streams per complex FFT: 2
+    const int blockSize;
+    const int fftSize;
+    const int numPartitions;
+    const int numSlots;                         // partitions plus the blocks of a pass
+
+    ado::Buffer historyRe, historyIm;           // [pair * numSlots + slot][bin]
+    ado::Buffer accRe, accIm;                   // [pair * maxBlocksAtOnce + block][bin]
+    ado::Buffer previous;                       // [stream][sample], the last block in
+    std::vector<WDL_FFT_COMPLEX> work;
+    int current {0};                            // slot of the next block
+};
+
+} // namespace ado
+
+#endif  // MULTISTREAMCONVOLUTION_H_INCLUDED
@@ -0,0 +1,206 @@
+//==============================================================================
+/*
+    The MIT License (MIT)
+
+    Copyright (c) 2016 John Flynn
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to
+    deal in the Software without restriction, including without limitation the
+    rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+    sell copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+    IN THE SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef MULTICHANNELCONVOLUTION_H_INCLUDED
+#define MULTICHANNELCONVOLUTION_H_INCLUDED
+
+#include <memory>
+#include <vector>
+
+#include "Buffer.h"
+#include "Convolution.h"
+#include "Resampling.h"
+
+
+namespace ado
+{
+
+//==============================================================================
+/** Convolution for any number of channels (5.1, 7.1.4, ambisonics...), built
+    from ado::Convolution engines of up to WDL_CONVO_MAX_PROC_NCH channels, run
+    in parallel on a pool of realtime priority worker threads shared by every
+    instance, and the calling (audio) thread.
+
+    Channel c is convolved with impulse channel c, or c % impulse channels if
+    the impulse has fewer (e.g. one stereo IR reused across a whole layout).
+    
+    - 1 or 2 channels: one engine, exactly as ado::Convolution (topologies too).
+    - Otherwise, with a distinct impulse channel per channel: one engine per 
+      channel pair.
+    - Otherwise, channels sharing an impulse channel go in the same engines,
+      up to 4 at a time, so they share its spectra (and WDL packs them in 
+      pairs, one FFT per pair).
+
+    @example    ado::Buffer ir {1, 1};
+                ado::MultichannelConvolution engine {ir};
+                
+                engine.resampleIrOnRateChange (sampleRate);    // prepareToPlay()
+                engine.prepare (numChannels, samplesPerBlock);
+                
+                engine.process (buffer.getArrayOfWritePointers(),  // processBlock()
+                                buffer.getNumChannels(),
+                                buffer.getNumSamples(),
+                                lastGains, gains);
+    
+    Notes:
+    - prepare() (re)builds the engines, starting any workers the shared pool
+      lacks, set() rebuilds the engines. Neither is for the audio thread.
+*/
+class MultichannelConvolution
+{
+public:
+    static constexpr int maxChannels {64};      // 7th order ambisonics
+
+    explicit MultichannelConvolution (const ado::Buffer& impulse,
+                                      int maxNumWorkers = defaultNumWorkers());
+    ~MultichannelConvolution();
+
+    MultichannelConvolution (const MultichannelConvolution&) = delete;
+    MultichannelConvolution& operator=(const MultichannelConvolution&) = delete;
+
+    void set (const ado::Buffer& impulse);
+
+    void resampleIrOnRateChange (double sampleRate);
+
+    /** Runs the engines at this rate (the impulse's own, say) while the host's
+        is higher: through a PolyphaseResampler down to it and another back up,
+        so the FFTs, histories & work shrink by the ratio, a quarter at 176.4kHz.
+        0, the default, runs them at the host's rate. Rebuilds the engines
+        once prepared.
+
+        The resamplers' delay, and a few samples more for the up's output count
+        to even out, adds to getLatencySamples(), rounded to the nearest
+        sample. As with fixed latency reblocking the dry must be off in
+        process(), mixed & delayed by the caller.
+    */
+    void setInternalRate (int rate);
+    bool isConvertingRate() const noexcept { return down != nullptr; }
+
+    /** See ado::Convolution::setTopology(). Only used with 1 or 2 channels. */
+    void setTopology (Convolution::Topology newTopology);
+
+    /** See ado::Convolution::setHeadSize(), for every engine. */
+    void setHeadSize (int numSamples);
+
+    /** See ado::Convolution::setMaxFftSize(), for every engine. */
+    void setMaxFftSize (int size);
+    int getMaxFftSize() const noexcept { return maxFftSize; }
+
+    /** See ado::Convolution::setSegmentBlocks(), for every engine. */
+    void setSegmentBlocks (int blocks);
+
+    /** See ado::Convolution::setLoadBalancing(), for every engine. */
+    void setLoadBalancing (bool shouldBalance);
+
+    /** See ado::Convolution::setFftBackends(), for every engine. */
+    void setFftBackends (std::vector<Convolution::FftBackend*> preferred);
+
+    /** See ado::Convolution::setReblocking(), for every engine. */
+    void setReblocking (Convolution::Reblocking newMode, int quantumSamples = 512);
+    int getLatencySamples() const noexcept;
+
+    void prepare (int numChannels, int maxBlockSize);
+
+    void setMemoryLocking (bool shouldLock);
+    MemoryLockReport getMemoryLockReport() const;   // summed over the engines
+
+    void process (ado::Buffer& block);
+    void process (float** block, int blockNumChannels, int blockNumSamples);
+
+    /** See ado::Convolution::process() */
+    void process (float** block, int blockNumChannels, int blockNumSamples,
+                  Convolution::MixGains from, Convolution::MixGains to);
+
+    /** Mixed precision, for double hosts: the block is converted to float for
+        the engines, and their wet mixed back into it in double, so the dry
+        never goes through float. The same ramps as the float process().
+        With fixed latency reblocking the dry must be off (mixed by the caller,
+        delayed): the engines' delayed copy of it is float.
+    */
+    void process (double** block, int blockNumChannels, int blockNumSamples,
+                  Convolution::MixGains from, Convolution::MixGains to);
+
+    int getNumEngines() const noexcept { return static_cast<int> (groups.size()); }
+    int getNumWorkers() const noexcept;
+
+    /** Cores less one, for the audio thread */
+    static int defaultNumWorkers();
+
+private:
+    struct Group;
+    class WorkerPool;
+
+    void rebuild();
+    void processGroups();
+    void processGroup (int index);
+    void processAtInternalRate (float** block, int blockNumChannels, int blockNumSamples,
+                                float wetFrom, float wetTo);
+    void updateRateConversion();
+    double getEngineRate() const noexcept;
+
+    const ado::Buffer* irCurrent;
+    double sampleRate;
+    int preparedNumChannels {0};
+    int preparedMaxBlockSize {0};
+    int maxWorkers;
+    bool shouldLockMemory {false};
+    Convolution::Topology topology {Convolution::Topology::matched};
+    int headSize {Convolution::autoHeadSize};
+    int maxFftSize {Convolution::defaultMaxFftSize};
+    int segmentBlocks {Convolution::defaultSegmentBlocks};
+    bool loadBalancing {false};
+    std::vector<Convolution::FftBackend*> fftBackends;
+    Convolution::Reblocking reblocking {Convolution::Reblocking::off};
+    int reblockQuantum {512};
+    int internalRate {0};
+
+    std::vector<std::unique_ptr<Group>> groups;
+    std::shared_ptr<WorkerPool> pool;           // once there are workers, while this lives
+    int poolSlot {-1};
+    int numWorkers {0};
+    ado::Buffer narrowed {1, 1};                // a double block in float, for the engines
+
+    std::unique_ptr<PolyphaseResampler> down;   // to the internal rate & back, while converting
+    std::unique_ptr<PolyphaseResampler> up;
+    ado::Buffer lowRate {1, 1};                 // a block at the internal rate
+    ado::Buffer wetQueue {1, 1};                // back at the host's rate, a few samples ahead
+    int wetQueued {0};
+    int wetLead {0};                            // wetQueued before each block, at least
+
+    struct BlockToProcess                       // for the workers
+    {
+        float** block;
+        double** wide;                          // mixed precision: block is its float copy
+        int numSamples;
+        bool mixing;
+        Convolution::MixGains from;
+        Convolution::MixGains to;
+    } current {};
+};
+
+} // namespace
+
+#endif  // MULTICHANNELCONVOLUTION_H_INCLUDED
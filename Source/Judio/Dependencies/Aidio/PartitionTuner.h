@@ -0,0 +1,129 @@
+//==============================================================================
+/*
+    The MIT License (MIT)
+
+    Copyright (c) 2016 John Flynn
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to
+    deal in the Software without restriction, including without limitation the
+    rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+    sell copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+    IN THE SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef PARTITIONTUNER_H_INCLUDED
+#define PARTITIONTUNER_H_INCLUDED
+
+#include <vector>
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "Convolution.h"
+#include "MultichannelConvolution.h"
+
+
+namespace ado
+{
+
+//==============================================================================
+/** Picks the partition plan (head size, segment blocks, largest FFT, FFT
+    backend & load balancing) by timing candidates on this machine, and keeps what it found in
+    a "wisdom" XML file so later sessions look it up instead.
+
+    A plan is for a problem: block size, sample rate, impulse length, channels
+    per engine & reblocking. Of the plans whose worst block stays within the limit (see
+    setWorstBlockLimit()), the one with the lowest mean block time wins, or the
+    lowest worst block if none do. Candidates are searched one parameter at a
+    time from WDL's defaults, so a tune is ~15 runs of the impulse: well under a
+    second for a few seconds of stereo impulse, longer for long surround ones.
+
+    Wisdom is per machine: the file records the CPU it was tuned on, and is
+    retuned from scratch if that differs.
+
+    @example    ado::PartitionTuner tuner {wisdomFile};
+                
+                tuner.apply (tuner.getPlan ({samplesPerBlock, sampleRate,   // prepareToPlay()
+                                             irLength, 2}), engine);
+                engine.prepare (numChannels, samplesPerBlock);
+*/
+class PartitionTuner
+{
+public:
+    struct Problem
+    {
+        int blockSize;
+        double sampleRate;
+        int impulseLength;                          // at sampleRate
+        int numChannels;                            // per engine, 1 to WDL_CONVO_MAX_PROC_NCH
+        Convolution::Reblocking reblocking {Convolution::Reblocking::off};  // as the engine will run,
+        int reblockQuantum {512};                                           // see Convolution::setReblocking()
+    };
+
+    struct Plan
+    {
+        int headSize {WDL_CONVO_DEFAULT_BRUTE_SIZE};
+        int segmentBlocks {Convolution::defaultSegmentBlocks};
+        int maxFftSize {Convolution::defaultMaxFftSize};
+        juce::String fftBackend;                    // empty for WDL's own
+        bool loadBalance {false};                   // see Convolution::setLoadBalancing()
+        double meanBlockSeconds {0.0};              // as measured
+        double worstBlockSeconds {0.0};
+    };
+
+    /** Wisdom is read from & written to file, which needn't exist yet. */
+    explicit PartitionTuner (const juce::File& wisdomFile);
+
+    /** Backends to try as well as WDL's own, by GetName(). Not owned. */
+    void setFftBackends (std::vector<Convolution::FftBackend*> candidates);
+
+    /** Longest a block may take, as a fraction of its duration (default 0.5,
+        leaving the rest to the host & other plugins).
+    */
+    void setWorstBlockLimit (double fractionOfBlock);
+
+    /** The plan from wisdom, or tunes (blocking, not for the audio thread),
+        saves & returns it.
+    */
+    Plan getPlan (const Problem& problem);
+
+    /** The plan from wisdom, without tuning. */
+    bool findPlan (const Problem& problem, Plan& plan) const;
+
+    /** Times one plan, filling in its block times. */
+    Plan measure (const Problem& problem, Plan plan) const;
+
+    void apply (const Plan& plan, Convolution& engine) const;
+    void apply (const Plan& plan, MultichannelConvolution& engine) const;
+
+    /** Identifies the machine wisdom was tuned on. */
+    static juce::String getMachineSignature();
+
+private:
+    Plan tune (const Problem& problem) const;
+    bool isBetter (const Plan& a, const Plan& b, const Problem& problem) const;
+    std::vector<Convolution::FftBackend*> getBackends (const Plan& plan) const;
+    void loadWisdom();
+    void saveWisdom (const Problem& problem, const Plan& plan);
+
+    juce::File file;
+    juce::XmlElement wisdom {"CONVOLUTIONWISDOM"};
+    std::vector<Convolution::FftBackend*> backends;
+    double worstBlockLimit {0.5};
+};
+
+} // namespace ado
+
+#endif  // PARTITIONTUNER_H_INCLUDED
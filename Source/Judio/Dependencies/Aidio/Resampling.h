@@ -27,17 +27,81 @@
 #ifndef RESAMPLING_H_INCLUDED_LS23K
 #define RESAMPLING_H_INCLUDED_LS23K
 
+#include <memory>
+#include <vector>
+
 #include "Buffer.h"
 
 namespace ado
 {
 
 //==============================================================================
-/** Resamples a buffer from one sampling frequency to another
+/** Resamples a buffer from one sampling frequency to another. Returned
+    Buffer is moved, not copied.
 */
-ado::Buffer resampleBuffer (const ado::Buffer& buffer, int destRate); // No move construct/assign for Buffer
-                                                                      // so this COPIES the return Buffer!!! Eek!
-                                                                      // (Refactor to non-const & param in?)
+ado::Buffer resampleBuffer (const ado::Buffer& buffer, int destRate);
+
+//==============================================================================
+/** Streaming rate conversion by a ratio of whole numbers (192000 to 44100 is
+    147/640) through linear phase FIRs, for running a process at a lower rate
+    than its host's: down before it, up after.
+
+    Halvings take what of the ratio they can through half-band filters, the
+    cheap part: every other tap is 0 and the steep cut is only needed where
+    the rate is lowest. What's left (48kHz to 44.1kHz, 147/160) goes through
+    a polyphase windowed sinc at the lowest rate. 176.4kHz to 44.1kHz is two
+    halvings, 192kHz to 44.1kHz two and a 147/160.
+
+    Every stage passes to 90.7% of the lower rate's Nyquist (20kHz at 44.1kHz)
+    and is 100dB down wherever it would alias or image onto that, by 109.3%
+    at the lowest rate. Between the two it aliases, which suits a signal with
+    nothing there: a down, an impulse without content above 20kHz, then an up
+    leaves nothing of the aliasing.
+
+    @example    ado::PolyphaseResampler down {192000, 44100};
+                down.prepare (numChannels, maxBlockSize);
+                const int numOut = down.process (input, numSamples, output);
+
+    Notes:
+    - A block's output count varies with where it falls on the ratio, by a
+      sample or so each stage from numInputSamples * toRate / fromRate.
+    - Construction designs the filters and prepare() allocates: neither is
+      for the audio thread.
+*/
+class PolyphaseResampler
+{
+public:
+    PolyphaseResampler (int fromRate, int toRate);
+    ~PolyphaseResampler();
+
+    void prepare (int numChannels, int maxInputSamples);
+
+    /** Clears the history, as if freshly prepared. */
+    void reset();
+
+    /** The most process() gives for numInputSamples. */
+    int getMaxOutputSamples (int numInputSamples) const noexcept;
+
+    /** Returns how many samples it wrote to each output channel. */
+    int process (const float* const* input, int numInputSamples, float* const* output);
+
+    /** The stages' group delay (linear phase, so the same at every frequency). */
+    double getLatencySeconds() const noexcept;
+
+    int getFromRate() const noexcept { return fromRate; }
+    int getToRate() const noexcept { return toRate; }
+
+private:
+    class Stage;                                // a half-band 2:1 or the rational rest, in Resampling.cpp
+    class HalfBand;
+    class Rational;
+
+    const int fromRate;
+    const int toRate;
+    std::vector<std::unique_ptr<Stage>> stages; // in processing order
+    std::vector<ado::Buffer> between;           // each stage's output, the next's input
+};
+
 } // namespace
 
 #endif  // RESAMPLING_H_INCLUDED_LS23K
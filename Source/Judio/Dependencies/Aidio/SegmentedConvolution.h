@@ -0,0 +1,131 @@
+//==============================================================================
+/*
+    The MIT License (MIT)
+
+    Copyright (c) 2016 John Flynn
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to
+    deal in the Software without restriction, including without limitation the
+    rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+    sell copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+    IN THE SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef SEGMENTEDCONVOLUTION_H_INCLUDED
+#define SEGMENTEDCONVOLUTION_H_INCLUDED
+
+#include <functional>
+#include <mutex>
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "Buffer.h"
+#include "MultichannelConvolution.h"
+
+
+namespace ado
+{
+
+//==============================================================================
+/** Offline convolution of one long stream on several cores: the stream is cut
+    into segments, each convolved by its own engine on its own thread, and the
+    output handed back in order.
+
+    Exactly the output of one ado::MultichannelConvolution run from the start
+    in blocks of blockSize, sample for sample. Summing each segment's tail into
+    the next (overlap-add) would only be equal to rounding, the sums happen in
+    a different order. Instead each engine starts a warm-up before its segment
+    (at least the impulse, on the partitions' period) and runs the input from
+    there, so by the segment it holds the same history in the same partitions
+    as the sequential engine and does the same arithmetic. The warm-up costs
+    what the overlapping tail would have.
+
+    Segments are sized from the jobs and the warm-up, see getSegmentSize().
+    At most two per job are in memory at once, however long the stream.
+
+    @example    ado::SegmentedConvolution renderer {ir, 2, 4096, [] (ado::MultichannelConvolution& engine)
+                {
+                    engine.setReblocking (ado::Convolution::Reblocking::fixedLatency, 16384);
+                }};
+                renderer.process (length + renderer.getLatencySamples(), gains, numCpus,
+                                  [&] (float* const* dest, int numChannels, juce::int64 start, int numSamples)
+                                  { ... fill from the input, zeros left past its end },
+                                  [&] (const float* const* src, int numChannels, juce::int64 start, int numSamples)
+                                  { ... write to the output; return true });
+*/
+class SegmentedConvolution
+{
+public:
+    /** Sets up each engine before it's prepared, as the sequential one would
+        be (topology, partition plan, reblocking...). The impulse must already
+        be at the rate it runs at (see Convolution::resampleImpulse()).
+    */
+    using Setup = std::function<void (MultichannelConvolution& engine)>;
+
+    /** Fills the input from start, with channels already cleared (leave zeros
+        past the input's end). From any thread, but one call at a time, in
+        order within a segment.
+    */
+    using Reader = std::function<void (float* const* dest, int numChannels,
+                                       juce::int64 start, int numSamples)>;
+
+    /** Takes the output from start, in order, on the thread that called
+        process(). Return false to stop.
+    */
+    using Writer = std::function<bool (const float* const* source, int numChannels,
+                                       juce::int64 start, int numSamples)>;
+
+    SegmentedConvolution (const ado::Buffer& impulse, int numChannels, int blockSize, Setup setup);
+
+    /** Convolves the first numSamples of the engine's output (input plus any
+        tail and latency wanted) with numJobs threads, gains fixed throughout.
+        False if the writer stopped it.
+    */
+    bool process (juce::int64 numSamples, Convolution::MixGains gains, int numJobs,
+                  Reader reader, Writer writer);
+
+    /** Samples per segment for this stream and jobs: a share of the stream
+        per job (a few each, so a slow one doesn't hold up the end), at least
+        8x the warm-up so that stays under an eighth of the work, and no more
+        than maxSegmentSize. A multiple of the period. The whole stream (one
+        engine, no warm-up) if there's one job or it's too short to split.
+    */
+    juce::int64 getSegmentSize (juce::int64 numSamples, int numJobs) const noexcept;
+
+    int getLatencySamples() const noexcept { return latency; }
+    int getWarmUpSize() const noexcept { return warmUp; }
+    int getPeriod() const noexcept { return period; }
+
+    static constexpr int maxSegmentSize {1 << 22};     // ~90s at 44.1kHz, 16MB a channel
+
+private:
+    struct Segment;
+
+    void render (Segment& segment, Convolution::MixGains gains, const Reader& reader);
+
+    const ado::Buffer& ir;
+    const int numChannels;
+    const int blockSize;
+    const Setup setup;
+    int latency {0};
+    int period {0};                                 // engine state repeats, in samples
+    int warmUp {0};                                 // a multiple of period
+    std::mutex readLock;
+};
+
+} // namespace ado
+
+#endif  // SEGMENTEDCONVOLUTION_H_INCLUDED
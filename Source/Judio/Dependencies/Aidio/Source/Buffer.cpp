@@ -24,6 +24,7 @@
 */
 //==============================================================================
 
+#include <cstring>
 #include <iostream>
 #include "../Buffer.h"
 
@@ -38,6 +39,13 @@ BufferView makeBufferView (juce::AudioBuffer<float>& juceBuffer)
                        juceBuffer.getNumSamples()};
 }
 
+BufferView makeBufferView (Buffer& buffer)
+{
+    return BufferView {buffer.getWriteArray(),
+                       buffer.getNumChannels(),
+                       buffer.getNumSamples()};
+}
+
 void coutBuffer (const BufferView& buffer)
 {
     for (int chan = 0; chan < buffer.getNumChannels(); ++chan)
@@ -55,13 +63,59 @@ Buffer::Buffer (int numChannels, int numSamples, int samplingRate)
     clearAndResize (numChannels, numSamples, samplingRate);
 }
 
+Buffer::Buffer (const Buffer& other)
+    : sampleRate {other.sampleRate}
+{
+    *this = other;
+}
+
+Buffer& Buffer::operator= (const Buffer& other)
+{
+    if (this != &other)
+    {
+        allocate (other.chans, other.samps);    // storage can't be copied directly, alignment
+        sampleRate = other.sampleRate;          // offset may differ in the new allocation
+
+        for (int c = 0; c < chans; ++c)
+            vectorCopy (other.channels[c], channels[c], stride);
+    }
+    return *this;
+}
+
+Buffer::Buffer (Buffer&& other) noexcept
+    : sampleRate {other.sampleRate},
+      chans {other.chans},
+      samps {other.samps},
+      stride {other.stride},
+      storage (std::move (other.storage)),  // vector move keeps the data pointer,
+      channels (std::move (other.channels)) // so channels stay valid
+{
+    other.chans = other.samps = other.stride = 0;
+}
+
+Buffer& Buffer::operator= (Buffer&& other) noexcept
+{
+    if (this != &other)
+    {
+        sampleRate = other.sampleRate;
+        chans      = other.chans;
+        samps      = other.samps;
+        stride     = other.stride;
+        storage    = std::move (other.storage);
+        channels   = std::move (other.channels);
+
+        other.chans = other.samps = other.stride = 0;
+    }
+    return *this;
+}
+
 void Buffer::clearAndResize (int numChannels, int numSamples)
 {
     Expects (numChannels  > 0);
     Expects (numSamples   > 0);
 
-    bufferData.setSize (numChannels, numSamples);
-    clear(); // juce buffer does not clear on creation
+    allocate (numChannels, numSamples);
+    clear();
 }
 
 void Buffer::clearAndResize (int numChannels, int numSamples, int samplingRate)
@@ -72,11 +126,17 @@ void Buffer::clearAndResize (int numChannels, int numSamples, int samplingRate)
     clearAndResize (numChannels, numSamples);
 }
 
+void Buffer::clear()
+{
+    for (int chan = 0; chan < chans; ++chan)
+        std::memset (channels[chan], 0, sizeof (float) * static_cast<size_t> (stride)); // padding too
+}
+
 void Buffer::fillAllOnes()
 {
     for (int chan = 0; chan < getNumChannels(); ++chan)
         for (int samp = 0; samp < getNumSamples(); ++samp)
-            bufferData.setSample(chan, samp, 1.0f);
+            channels[chan][samp] = 1.0f;
 }
 
 void Buffer::fillAscending()
@@ -87,21 +147,53 @@ void Buffer::fillAscending()
 
         for (int samp = 0; samp < getNumSamples(); ++samp)
         {
-            bufferData.setSample(chan, samp, sum);
+            channels[chan][samp] = sum;
             sum += 1.0f;
         }
     }
 }
 
+void Buffer::copyFrom (const Buffer& source)
+{
+    jassert (source.getNumChannels() <= getNumChannels());
+    jassert (source.getNumSamples() <= getNumSamples());
+
+    clear();
+
+    for (int c = 0; c < source.getNumChannels(); ++c)
+        vectorCopy (source.channels[c], channels[c], source.samps);
+}
+
 Buffer& Buffer::operator*= (float scale)
 {
-    for (int chan = 0; chan < getNumChannels(); ++chan)
-        for (int samp = 0; samp < getNumSamples(); ++samp)
-            getWriteArray()[chan][samp] *= scale;
+    for (int chan = 0; chan < chans; ++chan)
+        vectorScale (channels[chan], scale, stride);  // whole vectors, padding is zero
 
     return *this;
 }
 
+void Buffer::allocate (int numChannels, int numSamples)
+{
+    stride = (numSamples + paddingSamples - 1) / paddingSamples * paddingSamples;
+    const size_t slack = alignmentBytes / sizeof (float);
+    const size_t size  = static_cast<size_t> (numChannels) * static_cast<size_t> (stride) + slack;
+
+    if (numChannels != chans || storage.size() != size) // keep storage (and alignment) when unchanged
+    {
+        storage.assign (size, 0.0f);
+        channels.resize (static_cast<size_t> (numChannels));
+
+        const uintptr_t address = reinterpret_cast<uintptr_t> (storage.data());
+        const size_t offset = ((alignmentBytes - address % alignmentBytes) % alignmentBytes) / sizeof (float);
+
+        for (int c = 0; c < numChannels; ++c)
+            channels[c] = storage.data() + offset + static_cast<size_t> (c) * static_cast<size_t> (stride);
+    }
+
+    chans = numChannels;
+    samps = numSamples;
+}
+
 //==============================================================================
 
 void coutBuffer (ado::Buffer& buffer)
@@ -117,8 +209,7 @@ float bufferSumElements (const Buffer& buffer)
 {
     float sum {0};
     for (int chan = 0; chan < buffer.getNumChannels(); ++chan)
-        for (int samp = 0; samp < buffer.getNumSamples(); ++samp)
-            sum += buffer.getReadArray()[chan][samp];
+        sum += vectorSum (buffer.getReadArray()[chan], buffer.getNumSamples());
 
     return sum;
 }
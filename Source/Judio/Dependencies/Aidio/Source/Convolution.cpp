@@ -25,8 +25,14 @@
 //==============================================================================
 
 #include <cassert>
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <utility>
 #include "../Dependencies/gsl.h"
 #include "../Convolution.h"
+#include "../Kernels.h"
 #include "../Utility.h"
 #include "../Buffer.h"
 #include "../Resampling.h"
@@ -142,6 +148,16 @@ void Convolver::complexMultiplyInterleavedBuffers()
 */
 //==============================================================================
 
+namespace
+{
+
+int knownBlockSize (int maxBlockSize)       // for WDL's partition plan, powers of two plan fine without
+{
+    return isPowerOf2 (maxBlockSize) ? 0 : maxBlockSize;
+}
+
+} // namespace
+
 Convolution::Convolution (const ado::Buffer& impulse)
     : lastSampleRate {static_cast<double> (impulse.getSampleRate())},
       irOriginal {impulse}
@@ -151,27 +167,249 @@ Convolution::Convolution (const ado::Buffer& impulse)
 
 void Convolution::set (const ado::Buffer& impulse)
 {
+    locker.clear();                                 // before WDL frees the old buffers
+
     imp.Set (impulse.getReadArray(), impulse.getNumSamples(), impulse.getNumChannels());
-    eng.SetImpulse (&imp);
+    loadImpulse();
+
+    if (preparedNumChannels > 0)
+        prepareEngine();
+}
+
+void Convolution::setTopology (Topology newTopology)
+{
+    topology = newTopology;
+    eng.SetMonoInput (topology == Topology::monoInput);
+    tailEng.SetMonoInput (topology == Topology::monoInput);
+
+    if (eng.GetTrueStereo() != (topology == Topology::trueStereo))
+    {
+        locker.clear();                             // before WDL frees the old buffers
+        eng.SetTrueStereo (topology == Topology::trueStereo);
+        tailEng.SetTrueStereo (topology == Topology::trueStereo);
+        loadImpulse();                              // only takes effect on a new impulse
+    }
+
+    if (preparedNumChannels > 0)                    // the input ring is sized by channel
+        prepareEngine();
 }
 
 void Convolution::resampleIrOnRateChange (double sampleRate)
 {
     eng.Reset();
+    tailEng.Reset();
+    reblockFill = 0;
+    reblockIn.clear();
+    reblockOut.clear();
 
     if (sampleRate != lastSampleRate)
     {
-        irResampled = ado::resampleBuffer (irOriginal, static_cast<int> (sampleRate));
-
-        const float scale = static_cast<float> (irOriginal.getSampleRate() / sampleRate); // more samples convolved = louder!
-        irResampled *= scale;
-
+        irResampled = resampleImpulse (irOriginal, sampleRate);
         set (irResampled);
 
         lastSampleRate = sampleRate;
     }
 }
 
+ado::Buffer Convolution::resampleImpulse (const ado::Buffer& impulse, double sampleRate)
+{
+    ado::Buffer resampled = ado::resampleBuffer (impulse, static_cast<int> (sampleRate));
+
+    const float scale = static_cast<float> (impulse.getSampleRate() / sampleRate); // more samples convolved = louder!
+    resampled *= scale;
+
+    return resampled;
+}
+
+void Convolution::setHeadSize (int numSamples)
+{
+    Expects (0 <= numSamples);
+
+    headSize = numSamples;
+
+    if (headSize != autoHeadSize)
+        applyHeadSize (headSize);
+    else if (preparedNumChannels > 0)
+        applyHeadSize (measureHeadSize (preparedNumChannels, preparedMaxBlockSize));
+
+    if (preparedNumChannels > 0)
+        prepareEngine();
+}
+
+void Convolution::setMaxFftSize (int size)
+{
+    Expects (defaultMaxFftSize <= size && size <= WDL_FFT_MAX_SIZE && isPowerOf2 (size));
+
+    if (size == maxFftSize)
+        return;
+
+    maxFftSize = size;
+    loadImpulse();
+
+    if (preparedNumChannels > 0)
+        prepareEngine();
+}
+
+void Convolution::setSegmentBlocks (int blocks)
+{
+    Expects (1 <= blocks && blocks <= WDL_CONVO_MAX_SEGMENT_BLOCKS);
+
+    if (blocks == eng.GetSegmentBlocks())
+        return;
+
+    eng.SetSegmentBlocks (blocks);
+    tailEng.SetSegmentBlocks (blocks);
+    loadImpulse();
+
+    if (preparedNumChannels > 0)
+        prepareEngine();
+}
+
+void Convolution::setLoadBalancing (bool shouldBalance)
+{
+    if (shouldBalance == eng.GetLoadBalance())
+        return;
+
+    eng.SetLoadBalance (shouldBalance);
+    tailEng.SetLoadBalance (shouldBalance);
+    loadImpulse();
+
+    if (preparedNumChannels > 0)
+        prepareEngine();
+}
+
+void Convolution::setFftBackends (std::vector<FftBackend*> preferred)
+{
+    if (preferred == fftBackends)
+        return;
+
+    fftBackends = std::move (preferred);
+    eng.SetFFTBackends (fftBackends.data(), static_cast<int> (fftBackends.size()));
+    tailEng.SetFFTBackends (fftBackends.data(), static_cast<int> (fftBackends.size()));
+    loadImpulse();
+
+    if (preparedNumChannels > 0)
+        prepareEngine();
+}
+
+void Convolution::setReblocking (Reblocking newMode, int quantumSamples)
+{
+    Expects (32 <= quantumSamples && quantumSamples <= 16384);
+    Expects (isPowerOf2 (quantumSamples));
+
+    if (newMode == reblocking && quantumSamples == reblockQuantum)
+        return;
+
+    reblocking = newMode;
+    reblockQuantum = quantumSamples;
+    loadImpulse();
+
+    if (preparedNumChannels > 0)
+        prepareEngine();
+}
+
+int Convolution::measureHeadSize (int numChannels, int blockSize)
+{
+    Expects (0 < numChannels && numChannels <= WDL_CONVO_MAX_PROC_NCH);
+    Expects (0 < blockSize);
+
+    static std::mutex lock;
+    static std::map<std::pair<int, int>, int> measured;
+
+    std::lock_guard<std::mutex> guard {lock};
+
+    const auto key = std::make_pair (numChannels, blockSize);
+    const auto found = measured.find (key);
+    if (found != measured.end())
+        return found->second;
+
+    const int impulseLength {16384};            // covers the partitions that differ
+    const int numPasses {3};                    // fastest of, to dodge interruptions
+    const int samplesPerPass = std::max (2 * impulseLength, 8 * blockSize);
+
+    ado::Buffer noise {numChannels, impulseLength};   // any non-silent impulse will do
+    unsigned int seed {12345u};
+    for (int c = 0; c < numChannels; ++c)
+        for (auto& sample : noise.channel (c))
+        {
+            seed = seed * 1664525u + 1013904223u;
+            sample = static_cast<float> (seed >> 8) / (1 << 24) - 0.5f;
+        }
+
+    WDL_ImpulseBuffer impulse;
+    impulse.Set (noise.getReadArray(), impulseLength, numChannels);
+
+    ado::Buffer block {numChannels, blockSize};
+    block.fillAllOnes();
+
+    int fastest {WDL_CONVO_DEFAULT_BRUTE_SIZE};
+    double fastestTime {0.0};
+
+    for (int size = 32; size <= 512; size *= 2)
+    {
+        WDL_ConvolutionEngine_Div candidate;
+        candidate.SetBruteSize (size);
+        candidate.SetImpulse (&impulse);
+        candidate.Prepare (numChannels, blockSize);
+
+        double best {0.0};
+        for (int pass = 0; pass < numPasses; ++pass)
+        {
+            const auto start = std::chrono::steady_clock::now();
+
+            for (int done = 0; done < samplesPerPass; done += blockSize)
+            {
+                candidate.Add (block.getWriteArray(), blockSize, numChannels);
+                candidate.AvailTo (block.getWriteArray(), numChannels, blockSize);
+                block.fillAllOnes();
+            }
+
+            const double time = std::chrono::duration<double> (std::chrono::steady_clock::now() - start).count();
+            if (pass == 0 || time < best)
+                best = time;
+        }
+
+        if (size == 32 || best < fastestTime)
+        {
+            fastest = size;
+            fastestTime = best;
+        }
+    }
+
+    measured[key] = fastest;
+    return fastest;
+}
+
+void Convolution::prepare (int numChannels, int maxBlockSize)
+{
+    Expects (0 < numChannels && numChannels <= WDL_CONVO_MAX_PROC_NCH);
+    Expects (0 < maxBlockSize);
+
+    const bool repartition = reblocking == Reblocking::off
+                             && knownBlockSize (maxBlockSize) != knownBlockSize (preparedMaxBlockSize);
+
+    preparedNumChannels = numChannels;
+    preparedMaxBlockSize = maxBlockSize;
+
+    if (repartition)
+        loadImpulse();
+
+    if (headSize == autoHeadSize)
+        applyHeadSize (measureHeadSize (numChannels, maxBlockSize));
+
+    prepareEngine();
+
+    if (wetScratch.getNumSamples() < maxBlockSize)
+        wetScratch.clearAndResize (WDL_CONVO_MAX_PROC_NCH, maxBlockSize);
+    if (dryScratch.getNumSamples() < maxBlockSize)
+        dryScratch.clearAndResize (WDL_CONVO_MAX_PROC_NCH, maxBlockSize);
+}
+
+bool Convolution::partitionsMatchBlockSize (int blockSize)
+{
+    return isPowerOf2 (blockSize) || (blockSize % 8 == 0 && WDL_fft_size_supported (blockSize) != 0);
+}
+
 void Convolution::process (ado::Buffer& block)
 {
     convolve (block.getWriteArray(), block.getNumChannels(), block.getNumSamples());
@@ -182,27 +420,221 @@ void Convolution::process (float** block, int blockNumChannels, int blockNumSamp
     convolve (block, blockNumChannels, blockNumSamples);
 }
 
+void Convolution::process (float** block, int blockNumChannels, int blockNumSamples,
+                           MixGains from, MixGains to)
+{
+    if (reblocking == Reblocking::off)
+        eng.Add (block, blockNumSamples, blockNumChannels);
+
+    const bool allWet = from.dry == 0.0f && to.dry == 0.0f;
+    const bool allDry = from.wet == 0.0f && to.wet == 0.0f;
+
+    auto gainsAt = [&] (int pos) -> MixGains            // ramp position at a chunk boundary
+    {
+        const float t = static_cast<float> (pos) / static_cast<float> (blockNumSamples);
+        return {from.wet + (to.wet - from.wet) * t, from.dry + (to.dry - from.dry) * t};
+    };
+
+    float** wet = wetScratch.getWriteArray();
+    const bool delayedDry = reblocking == Reblocking::fixedLatency;
+
+    for (int start = 0; start < blockNumSamples; )
+    {
+        const int numSamples = std::min (blockNumSamples - start, wetScratch.getNumSamples());
+        const MixGains chunkFrom = gainsAt (start);
+        const MixGains chunkTo   = gainsAt (start + numSamples);
+
+        if (reblocking == Reblocking::off)
+        {
+            const int avail = eng.AvailTo (wet, blockNumChannels, numSamples);
+            assert (avail == numSamples);
+            (void) avail;
+        }
+        else
+        {
+            float* chunk[WDL_CONVO_MAX_PROC_NCH];
+            for (int chan = 0; chan < blockNumChannels; ++chan)
+                chunk[chan] = block[chan] + start;
+
+            reblock (chunk, blockNumChannels, numSamples);
+        }
+
+        for (int chan = blockNumChannels - 1; chan >= 0; --chan)   // channel 0 last, it may be
+        {                                                           // every channel's dry input
+            const int dryChan = topology == Topology::monoInput ? 0 : chan;
+            float* dest = block[chan] + start;
+            const float* dry = delayedDry ? dryScratch.getReadArray()[dryChan]
+                                          : block[dryChan] + start;
+
+            if (allDry)
+            {
+                if (dry != dest || chunkFrom.dry != 1.0f || chunkTo.dry != 1.0f)
+                    vectorScaleRamped (dry, dest, chunkFrom.dry, chunkTo.dry, numSamples);
+            }
+            else if (allWet)
+                vectorScaleRamped (wet[chan], dest, chunkFrom.wet, chunkTo.wet, numSamples);
+            else
+                vectorMixRamped (wet[chan], chunkFrom.wet, chunkTo.wet,
+                                 dry, chunkFrom.dry, chunkTo.dry,
+                                 dest, numSamples);
+        }
+
+        start += numSamples;
+    }
+}
+
 //==============================================================================
 //private:
 
 void Convolution::convolve (float** block, int blockNumChannels, int blockNumSamples)
 {
+    if (reblocking != Reblocking::off)
+    {
+        for (int start = 0; start < blockNumSamples; )
+        {
+            const int numSamples = std::min (blockNumSamples - start, wetScratch.getNumSamples());
+
+            float* chunk[WDL_CONVO_MAX_PROC_NCH];
+            for (int chan = 0; chan < blockNumChannels; ++chan)
+                chunk[chan] = block[chan] + start;
+
+            reblock (chunk, blockNumChannels, numSamples);
+
+            for (int chan = 0; chan < blockNumChannels; ++chan)
+                vectorCopy (wetScratch.getReadArray()[chan], chunk[chan], numSamples);
+
+            start += numSamples;
+        }
+        return;
+    }
+
     eng.Add (block,                                 // Send input to conv eng
              blockNumSamples,
              blockNumChannels);
 
-    const int avail = eng.Avail (blockNumSamples);  // Confirm full buffer available
-    assert (avail == blockNumSamples);
+    const int avail = eng.AvailTo (block,           // Sum engine output straight back
+                                   blockNumChannels,
+                                   blockNumSamples);
+    assert (avail == blockNumSamples);              // Confirm full buffer available
+    (void) avail;
+}
+
+void Convolution::reblock (float** block, int blockNumChannels, int blockNumSamples)
+{
+    Expects (blockNumChannels <= reblockIn.getNumChannels());   // i.e. prepared
+    Expects (blockNumSamples <= wetScratch.getNumSamples());
+
+    float** wet = wetScratch.getWriteArray();
+    float** dry = dryScratch.getWriteArray();
+    float** in  = reblockIn.getWriteArray();
+    float** out = reblockOut.getWriteArray();
+
+    const bool fixedLatency = reblocking == Reblocking::fixedLatency;
+    WDL_ConvolutionEngine_Div& quantumEng = fixedLatency ? eng : tailEng;
+
+    if (! fixedLatency)                             // the head, on the host's block
+    {
+        eng.Add (block, blockNumSamples, blockNumChannels);
+        const int avail = eng.AvailTo (wet, blockNumChannels, blockNumSamples);
+        assert (avail == blockNumSamples);
+        (void) avail;
+    }
+
+    for (int pos = 0; pos < blockNumSamples; )
+    {
+        const int numSamples = std::min (blockNumSamples - pos, reblockQuantum - reblockFill);
+
+        for (int chan = 0; chan < blockNumChannels; ++chan)
+        {
+            if (fixedLatency)                       // what's still in reblockIn is a quantum old
+            {
+                vectorCopy (in[chan] + reblockFill, dry[chan] + pos, numSamples);
+                vectorCopy (out[chan] + reblockFill, wet[chan] + pos, numSamples);
+            }
+            else
+                vectorAdd (out[chan] + reblockFill, wet[chan] + pos, numSamples);
+
+            vectorCopy (block[chan] + pos, in[chan] + reblockFill, numSamples);
+        }
+
+        reblockFill += numSamples;
+        pos += numSamples;
+
+        if (reblockFill == reblockQuantum)
+        {
+            if (fixedLatency || hasTail)
+            {
+                quantumEng.Add (in, reblockQuantum, blockNumChannels);
+                const int avail = quantumEng.AvailTo (out, blockNumChannels, reblockQuantum);
+                assert (avail == reblockQuantum);
+                (void) avail;
+            }
+            reblockFill = 0;
+        }
+    }
+}
+
+void Convolution::loadImpulse()
+{
+    locker.clear();                                 // before WDL frees the old buffers
+
+    const int maxFft = maxFftSize / 2;             // WDL doubles it
+
+    switch (reblocking)
+    {
+        case Reblocking::off:                       // partitions to match odd block sizes, if they can
+            eng.SetImpulse (&imp, maxFft, knownBlockSize (preparedMaxBlockSize));
+            break;
+
+        case Reblocking::fixedLatency:              // first partition a quantum, no head
+            eng.SetImpulse (&imp, maxFft, 0, 0, 0, reblockQuantum);
+            break;
+
+        case Reblocking::zeroLatency:               // head up to the quantum, the tail from it
+            eng.SetImpulse (&imp, maxFft, 0, reblockQuantum);
+            break;
+    }
+
+    hasTail = reblocking == Reblocking::zeroLatency && imp.GetLength() > reblockQuantum;
+    if (hasTail)
+        tailEng.SetImpulse (&imp, maxFft, 0, 0, reblockQuantum, reblockQuantum);
+}
+
+void Convolution::applyHeadSize (int numSamples)
+{
+    if (numSamples == eng.GetBruteSize())
+        return;
+
+    eng.SetBruteSize (numSamples);
+    loadImpulse();                                  // only takes effect on a new impulse
+}
+
+void Convolution::prepareEngine()
+{
+    const auto addToLocker = [] (void* ctx, void* buf, int bytes)
+    {
+        static_cast<MemoryLocker*> (ctx)->add (buf, static_cast<size_t> (bytes));
+    };
+
+    locker.clear();
+    eng.Prepare (preparedNumChannels,
+                 reblocking == Reblocking::fixedLatency ? reblockQuantum : preparedMaxBlockSize);
+    eng.EnumBuffers (addToLocker, &locker);
 
-    float** convolved = eng.Get();
-    auto constConvolved = const_cast<const float**> (convolved);
+    if (hasTail)
+    {
+        tailEng.Prepare (preparedNumChannels, reblockQuantum);
+        tailEng.EnumBuffers (addToLocker, &locker);
+    }
 
-    ado::rawBufferCopy (constConvolved,
-                        block,
-                        blockNumChannels,
-                        blockNumSamples);
+    locker.lock (shouldLockMemory);
 
-    eng.Advance (blockNumSamples);                  // Advance the eng
+    reblockFill = 0;
+    if (reblocking != Reblocking::off)
+    {
+        reblockIn.clearAndResize (preparedNumChannels, reblockQuantum);
+        reblockOut.clearAndResize (preparedNumChannels, reblockQuantum);
+    }
 }
 
 } // namespace
@@ -0,0 +1,1177 @@
+//==============================================================================
+/*
+    The MIT License (MIT)
+
+    Copyright (c) 2016 John Flynn
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to
+    deal in the Software without restriction, including without limitation the
+    rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+    sell copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+    IN THE SOFTWARE.
+*/
+
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include "../Kernels.h"
+
+#if defined (__x86_64__) || defined (_M_X64) || defined (__i386__) || defined (_M_IX86)
+ #define AIDIO_KERNELS_X86 1
+ #include <immintrin.h>
+ #if defined (_MSC_VER) && ! defined (__clang__)
+  #include <intrin.h>
+  #define AIDIO_TARGET(isa)                 // MSVC emits any intrinsic, no attribute needed
+ #else
+  #define AIDIO_TARGET(isa) __attribute__ ((target (isa)))
+ #endif
+#else
+ #define AIDIO_KERNELS_X86 0
+#endif
+
+namespace ado
+{
+
+namespace
+{
+
+//==============================================================================
+
+struct KernelTable
+{
+    void   (*scale)     (float*, float, int);
+    void   (*addScaled) (const float*, float*, float, int);
+    void   (*mix)       (const float*, float, const float*, float, float*, int);
+    double (*sum)       (const float*, int);
+    float  (*peak)      (const float*, int);
+    bool   (*equals)    (const float*, const float*, int);
+
+    // ramps are passed as start & per sample increment
+    void   (*mixRamped)   (const float*, float, float, const float*, float, float, float*, int);
+    void   (*scaleRamped) (const float*, float*, float, float, int);
+    void   (*fir)         (const float*, int, const float*, float*, int, bool);
+    void   (*complexMac)  (const float*, const float*, const float*, const float*, float*, float*, int);
+    void   (*dots)        (const float*, const int*, const float*, const int*, float*, int, int);
+
+    // double hosts: the dry in double, the wet converted
+    void   (*toFloat)        (const double*, float*, int);
+    void   (*mixRampedDouble) (const double*, double, double, const double*, double, double, double*, int);
+    void   (*mixRampedMixed)  (const double*, double, double, const float*, double, double, double*, int);
+};
+
+//==============================================================================
+
+namespace scalar
+{
+    void scale (float* d, float g, int n)
+    {
+        for (int i = 0; i < n; ++i)
+            d[i] *= g;
+    }
+
+    void addScaled (const float* s, float* d, float g, int n)
+    {
+        for (int i = 0; i < n; ++i)
+            d[i] += s[i] * g;
+    }
+
+    void mix (const float* a, float ga, const float* b, float gb, float* d, int n)
+    {
+        for (int i = 0; i < n; ++i)
+            d[i] = a[i] * ga + b[i] * gb;
+    }
+
+    double sum (const float* s, int n)
+    {
+        double total {0.0};
+        for (int i = 0; i < n; ++i)
+            total += s[i];
+        return total;
+    }
+
+    float peak (const float* s, int n)
+    {
+        float p {0.0f};
+        for (int i = 0; i < n; ++i)
+            p = std::fabs (s[i]) > p ? std::fabs (s[i]) : p;
+        return p;
+    }
+
+    bool equals (const float* a, const float* b, int n)
+    {
+        for (int i = 0; i < n; ++i)
+            if (a[i] != b[i])
+                return false;
+        return true;
+    }
+
+    void mixRamped (const float* a, float ga, float incA, const float* b, float gb, float incB, float* d, int n)
+    {
+        for (int i = 0; i < n; ++i)
+            d[i] = a[i] * (ga + incA * i) + b[i] * (gb + incB * i);
+    }
+
+    void scaleRamped (const float* s, float* d, float g, float inc, int n)
+    {
+        for (int i = 0; i < n; ++i)
+            d[i] = s[i] * (g + inc * i);
+    }
+
+        void fir (const float* t, int nt, const float* s, float* d, int n, bool add)
+    {
+        for (int i = 0; i < n; ++i)
+        {
+            double acc {0.0};
+            for (int k = 0; k < nt; ++k)
+                acc += static_cast<double> (t[k]) * s[i + k];
+            d[i] = add ? d[i] + static_cast<float> (acc) : static_cast<float> (acc);
+        }
+    }
+
+    void complexMac (const float* xr, const float* xi, const float* hr, const float* hi, float* ar, float* ai, int n)
+    {
+        for (int i = 0; i < n; ++i)
+        {
+            ar[i] += xr[i] * hr[i] - xi[i] * hi[i];
+            ai[i] += xr[i] * hi[i] + xi[i] * hr[i];
+        }
+    }
+
+    float dot (const float* a, const float* b, int n)
+    {
+        double acc {0.0};
+        for (int i = 0; i < n; ++i)
+            acc += static_cast<double> (a[i]) * b[i];
+        return static_cast<float> (acc);
+    }
+
+    void dots (const float* a, const int* aOffsets, const float* b, const int* bOffsets, float* d, int count, int n)
+    {
+        for (int j = 0; j < count; ++j)
+            d[j] = dot (a + aOffsets[j], b + bOffsets[j], n);
+    }
+
+    void toFloat (const double* s, float* d, int n)
+    {
+        for (int i = 0; i < n; ++i)
+            d[i] = static_cast<float> (s[i]);
+    }
+
+    void mixRampedDouble (const double* a, double ga, double incA, const double* b, double gb, double incB, double* d, int n)
+    {
+        for (int i = 0; i < n; ++i)
+            d[i] = a[i] * (ga + incA * i) + b[i] * (gb + incB * i);
+    }
+
+    void mixRampedMixed (const double* a, double ga, double incA, const float* b, double gb, double incB, double* d, int n)
+    {
+        for (int i = 0; i < n; ++i)
+            d[i] = a[i] * (ga + incA * i) + b[i] * (gb + incB * i);
+    }
+
+    const KernelTable table {scale, addScaled, mix, sum, peak, equals, mixRamped, scaleRamped, fir, complexMac, dots,
+                             toFloat, mixRampedDouble, mixRampedMixed};
+}
+
+#if AIDIO_KERNELS_X86
+
+//==============================================================================
+
+namespace sse2
+{
+    AIDIO_TARGET ("sse2") void scale (float* d, float g, int n)
+    {
+        const __m128 gain = _mm_set1_ps (g);
+        int i = 0;
+        for (; i + 4 <= n; i += 4)
+            _mm_storeu_ps (d + i, _mm_mul_ps (_mm_loadu_ps (d + i), gain));
+        scalar::scale (d + i, g, n - i);
+    }
+
+    AIDIO_TARGET ("sse2") void addScaled (const float* s, float* d, float g, int n)
+    {
+        const __m128 gain = _mm_set1_ps (g);
+        int i = 0;
+        for (; i + 4 <= n; i += 4)
+            _mm_storeu_ps (d + i, _mm_add_ps (_mm_loadu_ps (d + i), _mm_mul_ps (_mm_loadu_ps (s + i), gain)));
+        scalar::addScaled (s + i, d + i, g, n - i);
+    }
+
+    AIDIO_TARGET ("sse2") void mix (const float* a, float ga, const float* b, float gb, float* d, int n)
+    {
+        const __m128 gainA = _mm_set1_ps (ga);
+        const __m128 gainB = _mm_set1_ps (gb);
+        int i = 0;
+        for (; i + 4 <= n; i += 4)
+            _mm_storeu_ps (d + i, _mm_add_ps (_mm_mul_ps (_mm_loadu_ps (a + i), gainA),
+                                              _mm_mul_ps (_mm_loadu_ps (b + i), gainB)));
+        scalar::mix (a + i, ga, b + i, gb, d + i, n - i);
+    }
+
+    AIDIO_TARGET ("sse2") double sum (const float* s, int n)
+    {
+        __m128d lo = _mm_setzero_pd();
+        __m128d hi = _mm_setzero_pd();
+        int i = 0;
+        for (; i + 4 <= n; i += 4)
+        {
+            const __m128 x = _mm_loadu_ps (s + i);
+            lo = _mm_add_pd (lo, _mm_cvtps_pd (x));
+            hi = _mm_add_pd (hi, _mm_cvtps_pd (_mm_movehl_ps (x, x)));
+        }
+        double lanes[2];
+        _mm_storeu_pd (lanes, _mm_add_pd (lo, hi));
+        return lanes[0] + lanes[1] + scalar::sum (s + i, n - i);
+    }
+
+    AIDIO_TARGET ("sse2") float peak (const float* s, int n)
+    {
+        const __m128 signBit = _mm_set1_ps (-0.0f);
+        __m128 p = _mm_setzero_ps();
+        int i = 0;
+        for (; i + 4 <= n; i += 4)
+            p = _mm_max_ps (p, _mm_andnot_ps (signBit, _mm_loadu_ps (s + i)));
+        float lanes[4];
+        _mm_storeu_ps (lanes, p);
+        const float tail = scalar::peak (s + i, n - i);
+        float result = tail;
+        for (float lane : lanes)
+            result = lane > result ? lane : result;
+        return result;
+    }
+
+    AIDIO_TARGET ("sse2") bool equals (const float* a, const float* b, int n)
+    {
+        int i = 0;
+        for (; i + 4 <= n; i += 4)
+            if (_mm_movemask_ps (_mm_cmpneq_ps (_mm_loadu_ps (a + i), _mm_loadu_ps (b + i))) != 0)
+                return false;
+        return scalar::equals (a + i, b + i, n - i);
+    }
+
+    AIDIO_TARGET ("sse2") void mixRamped (const float* a, float ga, float incA, const float* b, float gb, float incB, float* d, int n)
+    {
+        const __m128 lanes = _mm_set_ps (3.0f, 2.0f, 1.0f, 0.0f);
+        const __m128 startA = _mm_set1_ps (ga), stepA = _mm_set1_ps (incA);
+        const __m128 startB = _mm_set1_ps (gb), stepB = _mm_set1_ps (incB);
+        int i = 0;
+        for (; i + 4 <= n; i += 4)
+        {
+            const __m128 index = _mm_add_ps (_mm_set1_ps (static_cast<float> (i)), lanes);  // no drift
+            const __m128 gainA = _mm_add_ps (startA, _mm_mul_ps (index, stepA));
+            const __m128 gainB = _mm_add_ps (startB, _mm_mul_ps (index, stepB));
+            _mm_storeu_ps (d + i, _mm_add_ps (_mm_mul_ps (_mm_loadu_ps (a + i), gainA),
+                                              _mm_mul_ps (_mm_loadu_ps (b + i), gainB)));
+        }
+        scalar::mixRamped (a + i, ga + incA * i, incA, b + i, gb + incB * i, incB, d + i, n - i);
+    }
+
+    AIDIO_TARGET ("sse2") void scaleRamped (const float* s, float* d, float g, float inc, int n)
+    {
+        const __m128 lanes = _mm_set_ps (3.0f, 2.0f, 1.0f, 0.0f);
+        const __m128 start = _mm_set1_ps (g), step = _mm_set1_ps (inc);
+        int i = 0;
+        for (; i + 4 <= n; i += 4)
+        {
+            const __m128 index = _mm_add_ps (_mm_set1_ps (static_cast<float> (i)), lanes);
+            _mm_storeu_ps (d + i, _mm_mul_ps (_mm_loadu_ps (s + i), _mm_add_ps (start, _mm_mul_ps (index, step))));
+        }
+        scalar::scaleRamped (s + i, d + i, g + inc * i, inc, n - i);
+    }
+
+        inline AIDIO_TARGET ("sse2") void firStore (float* d, __m128 v, bool add)
+    {
+        _mm_storeu_ps (d, add ? _mm_add_ps (_mm_loadu_ps (d), v) : v);
+    }
+
+    AIDIO_TARGET ("sse2") void fir (const float* t, int nt, const float* s, float* d, int n, bool add)
+    {
+        int i = 0;
+        for (; i + 16 <= n; i += 16)                // 4 accumulators, each tap loaded once
+        {
+            __m128 a0 = _mm_setzero_ps(), a1 = a0, a2 = a0, a3 = a0;
+            const float* p = s + i;
+            for (int k = 0; k < nt; ++k, ++p)
+            {
+                const __m128 tap = _mm_set1_ps (t[k]);
+                a0 = _mm_add_ps (a0, _mm_mul_ps (tap, _mm_loadu_ps (p)));
+                a1 = _mm_add_ps (a1, _mm_mul_ps (tap, _mm_loadu_ps (p + 4)));
+                a2 = _mm_add_ps (a2, _mm_mul_ps (tap, _mm_loadu_ps (p + 8)));
+                a3 = _mm_add_ps (a3, _mm_mul_ps (tap, _mm_loadu_ps (p + 12)));
+            }
+            firStore (d + i,      a0, add);
+            firStore (d + i + 4,  a1, add);
+            firStore (d + i + 8,  a2, add);
+            firStore (d + i + 12, a3, add);
+        }
+        for (; i + 4 <= n; i += 4)
+        {
+            __m128 a0 = _mm_setzero_ps();
+            for (int k = 0; k < nt; ++k)
+                a0 = _mm_add_ps (a0, _mm_mul_ps (_mm_set1_ps (t[k]), _mm_loadu_ps (s + i + k)));
+            firStore (d + i, a0, add);
+        }
+        scalar::fir (t, nt, s + i, d + i, n - i, add);
+    }
+
+    AIDIO_TARGET ("sse2") void complexMac (const float* xr, const float* xi, const float* hr, const float* hi, float* ar, float* ai, int n)
+    {
+        int i = 0;
+        for (; i + 4 <= n; i += 4)
+        {
+            const __m128 a = _mm_loadu_ps (xr + i), b = _mm_loadu_ps (xi + i);
+            const __m128 c = _mm_loadu_ps (hr + i), d = _mm_loadu_ps (hi + i);
+            _mm_storeu_ps (ar + i, _mm_add_ps (_mm_loadu_ps (ar + i), _mm_sub_ps (_mm_mul_ps (a, c), _mm_mul_ps (b, d))));
+            _mm_storeu_ps (ai + i, _mm_add_ps (_mm_loadu_ps (ai + i), _mm_add_ps (_mm_mul_ps (a, d), _mm_mul_ps (b, c))));
+        }
+        scalar::complexMac (xr + i, xi + i, hr + i, hi + i, ar + i, ai + i, n - i);
+    }
+
+    AIDIO_TARGET ("sse2") float dot (const float* a, const float* b, int n)
+    {
+        __m128 acc0 = _mm_setzero_ps();
+        __m128 acc1 = _mm_setzero_ps();
+        int i = 0;
+        for (; i + 8 <= n; i += 8)
+        {
+            acc0 = _mm_add_ps (acc0, _mm_mul_ps (_mm_loadu_ps (a + i), _mm_loadu_ps (b + i)));
+            acc1 = _mm_add_ps (acc1, _mm_mul_ps (_mm_loadu_ps (a + i + 4), _mm_loadu_ps (b + i + 4)));
+        }
+        float lanes[4];
+        _mm_storeu_ps (lanes, _mm_add_ps (acc0, acc1));
+        return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + scalar::dot (a + i, b + i, n - i);
+    }
+
+    AIDIO_TARGET ("sse2") void dots (const float* a, const int* aOffsets, const float* b, const int* bOffsets, float* d, int count, int n)
+    {
+        int j = 0;
+        for (; j + 4 <= count; j += 4)              // 4 at once, a lane each after the transpose
+        {
+            const float* x[4];
+            const float* y[4];
+            __m128 acc[4];
+            for (int k = 0; k < 4; ++k)
+            {
+                x[k] = a + aOffsets[j + k];
+                y[k] = b + bOffsets[j + k];
+                acc[k] = _mm_setzero_ps();
+            }
+            int i = 0;
+            for (; i + 4 <= n; i += 4)
+                for (int k = 0; k < 4; ++k)
+                    acc[k] = _mm_add_ps (acc[k], _mm_mul_ps (_mm_loadu_ps (x[k] + i), _mm_loadu_ps (y[k] + i)));
+
+            _MM_TRANSPOSE4_PS (acc[0], acc[1], acc[2], acc[3]);
+            float lanes[4];
+            _mm_storeu_ps (lanes, _mm_add_ps (_mm_add_ps (acc[0], acc[1]), _mm_add_ps (acc[2], acc[3])));
+            for (int k = 0; k < 4; ++k)
+                d[j + k] = lanes[k] + scalar::dot (x[k] + i, y[k] + i, n - i);
+        }
+        for (; j < count; ++j)
+            d[j] = dot (a + aOffsets[j], b + bOffsets[j], n);
+    }
+
+    AIDIO_TARGET ("sse2") void toFloat (const double* s, float* d, int n)
+    {
+        int i = 0;
+        for (; i + 4 <= n; i += 4)
+            _mm_storeu_ps (d + i, _mm_movelh_ps (_mm_cvtpd_ps (_mm_loadu_pd (s + i)),
+                                                 _mm_cvtpd_ps (_mm_loadu_pd (s + i + 2))));
+        scalar::toFloat (s + i, d + i, n - i);
+    }
+
+    AIDIO_TARGET ("sse2") void mixRampedDouble (const double* a, double ga, double incA, const double* b, double gb, double incB, double* d, int n)
+    {
+        const __m128d lanes = _mm_set_pd (1.0, 0.0);
+        const __m128d startA = _mm_set1_pd (ga), stepA = _mm_set1_pd (incA);
+        const __m128d startB = _mm_set1_pd (gb), stepB = _mm_set1_pd (incB);
+        int i = 0;
+        for (; i + 2 <= n; i += 2)
+        {
+            const __m128d index = _mm_add_pd (_mm_set1_pd (static_cast<double> (i)), lanes);
+            const __m128d gainA = _mm_add_pd (startA, _mm_mul_pd (index, stepA));
+            const __m128d gainB = _mm_add_pd (startB, _mm_mul_pd (index, stepB));
+            _mm_storeu_pd (d + i, _mm_add_pd (_mm_mul_pd (_mm_loadu_pd (a + i), gainA),
+                                              _mm_mul_pd (_mm_loadu_pd (b + i), gainB)));
+        }
+        scalar::mixRampedDouble (a + i, ga + incA * i, incA, b + i, gb + incB * i, incB, d + i, n - i);
+    }
+
+    AIDIO_TARGET ("sse2") void mixRampedMixed (const double* a, double ga, double incA, const float* b, double gb, double incB, double* d, int n)
+    {
+        const __m128d lanes = _mm_set_pd (1.0, 0.0);
+        const __m128d startA = _mm_set1_pd (ga), stepA = _mm_set1_pd (incA);
+        const __m128d startB = _mm_set1_pd (gb), stepB = _mm_set1_pd (incB);
+        int i = 0;
+        for (; i + 2 <= n; i += 2)
+        {
+            const __m128d index = _mm_add_pd (_mm_set1_pd (static_cast<double> (i)), lanes);
+            const __m128d gainA = _mm_add_pd (startA, _mm_mul_pd (index, stepA));
+            const __m128d gainB = _mm_add_pd (startB, _mm_mul_pd (index, stepB));
+            const __m128d wide = _mm_cvtps_pd (_mm_castsi128_ps (_mm_loadl_epi64 (reinterpret_cast<const __m128i*> (b + i))));
+            _mm_storeu_pd (d + i, _mm_add_pd (_mm_mul_pd (_mm_loadu_pd (a + i), gainA), _mm_mul_pd (wide, gainB)));
+        }
+        scalar::mixRampedMixed (a + i, ga + incA * i, incA, b + i, gb + incB * i, incB, d + i, n - i);
+    }
+
+    const KernelTable table {scale, addScaled, mix, sum, peak, equals, mixRamped, scaleRamped, fir, complexMac, dots,
+                             toFloat, mixRampedDouble, mixRampedMixed};
+}
+
+//==============================================================================
+
+namespace avx2
+{
+    AIDIO_TARGET ("avx2,fma") void scale (float* d, float g, int n)
+    {
+        const __m256 gain = _mm256_set1_ps (g);
+        int i = 0;
+        for (; i + 8 <= n; i += 8)
+            _mm256_storeu_ps (d + i, _mm256_mul_ps (_mm256_loadu_ps (d + i), gain));
+        sse2::scale (d + i, g, n - i);
+    }
+
+    AIDIO_TARGET ("avx2,fma") void addScaled (const float* s, float* d, float g, int n)
+    {
+        const __m256 gain = _mm256_set1_ps (g);
+        int i = 0;
+        for (; i + 8 <= n; i += 8)
+            _mm256_storeu_ps (d + i, _mm256_fmadd_ps (_mm256_loadu_ps (s + i), gain, _mm256_loadu_ps (d + i)));
+        sse2::addScaled (s + i, d + i, g, n - i);
+    }
+
+    AIDIO_TARGET ("avx2,fma") void mix (const float* a, float ga, const float* b, float gb, float* d, int n)
+    {
+        const __m256 gainA = _mm256_set1_ps (ga);
+        const __m256 gainB = _mm256_set1_ps (gb);
+        int i = 0;
+        for (; i + 8 <= n; i += 8)
+            _mm256_storeu_ps (d + i, _mm256_fmadd_ps (_mm256_loadu_ps (a + i), gainA,
+                                                      _mm256_mul_ps (_mm256_loadu_ps (b + i), gainB)));
+        sse2::mix (a + i, ga, b + i, gb, d + i, n - i);
+    }
+
+    AIDIO_TARGET ("avx2,fma") double sum (const float* s, int n)
+    {
+        __m256d lo = _mm256_setzero_pd();
+        __m256d hi = _mm256_setzero_pd();
+        int i = 0;
+        for (; i + 8 <= n; i += 8)
+        {
+            lo = _mm256_add_pd (lo, _mm256_cvtps_pd (_mm_loadu_ps (s + i)));
+            hi = _mm256_add_pd (hi, _mm256_cvtps_pd (_mm_loadu_ps (s + i + 4)));
+        }
+        double lanes[4];
+        _mm256_storeu_pd (lanes, _mm256_add_pd (lo, hi));
+        return lanes[0] + lanes[1] + lanes[2] + lanes[3] + sse2::sum (s + i, n - i);
+    }
+
+    AIDIO_TARGET ("avx2,fma") float peak (const float* s, int n)
+    {
+        const __m256 signBit = _mm256_set1_ps (-0.0f);
+        __m256 p = _mm256_setzero_ps();
+        int i = 0;
+        for (; i + 8 <= n; i += 8)
+            p = _mm256_max_ps (p, _mm256_andnot_ps (signBit, _mm256_loadu_ps (s + i)));
+        float lanes[8];
+        _mm256_storeu_ps (lanes, p);
+        float result = sse2::peak (s + i, n - i);
+        for (float lane : lanes)
+            result = lane > result ? lane : result;
+        return result;
+    }
+
+    AIDIO_TARGET ("avx2,fma") bool equals (const float* a, const float* b, int n)
+    {
+        int i = 0;
+        for (; i + 8 <= n; i += 8)
+            if (_mm256_movemask_ps (_mm256_cmp_ps (_mm256_loadu_ps (a + i), _mm256_loadu_ps (b + i), _CMP_NEQ_UQ)) != 0)
+                return false;
+        return sse2::equals (a + i, b + i, n - i);
+    }
+
+    AIDIO_TARGET ("avx2,fma") void mixRamped (const float* a, float ga, float incA, const float* b, float gb, float incB, float* d, int n)
+    {
+        const __m256 lanes = _mm256_set_ps (7.0f, 6.0f, 5.0f, 4.0f, 3.0f, 2.0f, 1.0f, 0.0f);
+        const __m256 startA = _mm256_set1_ps (ga), stepA = _mm256_set1_ps (incA);
+        const __m256 startB = _mm256_set1_ps (gb), stepB = _mm256_set1_ps (incB);
+        int i = 0;
+        for (; i + 8 <= n; i += 8)
+        {
+            const __m256 index = _mm256_add_ps (_mm256_set1_ps (static_cast<float> (i)), lanes);
+            const __m256 gainA = _mm256_fmadd_ps (index, stepA, startA);
+            const __m256 gainB = _mm256_fmadd_ps (index, stepB, startB);
+            _mm256_storeu_ps (d + i, _mm256_fmadd_ps (_mm256_loadu_ps (a + i), gainA,
+                                                      _mm256_mul_ps (_mm256_loadu_ps (b + i), gainB)));
+        }
+        sse2::mixRamped (a + i, ga + incA * i, incA, b + i, gb + incB * i, incB, d + i, n - i);
+    }
+
+    AIDIO_TARGET ("avx2,fma") void scaleRamped (const float* s, float* d, float g, float inc, int n)
+    {
+        const __m256 lanes = _mm256_set_ps (7.0f, 6.0f, 5.0f, 4.0f, 3.0f, 2.0f, 1.0f, 0.0f);
+        const __m256 start = _mm256_set1_ps (g), step = _mm256_set1_ps (inc);
+        int i = 0;
+        for (; i + 8 <= n; i += 8)
+        {
+            const __m256 index = _mm256_add_ps (_mm256_set1_ps (static_cast<float> (i)), lanes);
+            _mm256_storeu_ps (d + i, _mm256_mul_ps (_mm256_loadu_ps (s + i), _mm256_fmadd_ps (index, step, start)));
+        }
+        sse2::scaleRamped (s + i, d + i, g + inc * i, inc, n - i);
+    }
+
+        inline AIDIO_TARGET ("avx2,fma") void firStore (float* d, __m256 v, bool add)
+    {
+        _mm256_storeu_ps (d, add ? _mm256_add_ps (_mm256_loadu_ps (d), v) : v);
+    }
+
+    AIDIO_TARGET ("avx2,fma") void fir (const float* t, int nt, const float* s, float* d, int n, bool add)
+    {
+        int i = 0;
+        for (; i + 32 <= n; i += 32)                // 4 accumulators hide the FMA latency
+        {
+            __m256 a0 = _mm256_setzero_ps(), a1 = a0, a2 = a0, a3 = a0;
+            const float* p = s + i;
+            for (int k = 0; k < nt; ++k, ++p)
+            {
+                const __m256 tap = _mm256_broadcast_ss (t + k);
+                a0 = _mm256_fmadd_ps (tap, _mm256_loadu_ps (p),      a0);
+                a1 = _mm256_fmadd_ps (tap, _mm256_loadu_ps (p + 8),  a1);
+                a2 = _mm256_fmadd_ps (tap, _mm256_loadu_ps (p + 16), a2);
+                a3 = _mm256_fmadd_ps (tap, _mm256_loadu_ps (p + 24), a3);
+            }
+            firStore (d + i,      a0, add);
+            firStore (d + i + 8,  a1, add);
+            firStore (d + i + 16, a2, add);
+            firStore (d + i + 24, a3, add);
+        }
+        for (; i + 8 <= n; i += 8)
+        {
+            __m256 a0 = _mm256_setzero_ps(), a1 = a0;   // even & odd taps
+            int k = 0;
+            for (; k + 2 <= nt; k += 2)
+            {
+                a0 = _mm256_fmadd_ps (_mm256_broadcast_ss (t + k),     _mm256_loadu_ps (s + i + k),     a0);
+                a1 = _mm256_fmadd_ps (_mm256_broadcast_ss (t + k + 1), _mm256_loadu_ps (s + i + k + 1), a1);
+            }
+            if (k < nt)
+                a0 = _mm256_fmadd_ps (_mm256_broadcast_ss (t + k), _mm256_loadu_ps (s + i + k), a0);
+            firStore (d + i, _mm256_add_ps (a0, a1), add);
+        }
+        sse2::fir (t, nt, s + i, d + i, n - i, add);
+    }
+
+    AIDIO_TARGET ("avx2,fma") void complexMac (const float* xr, const float* xi, const float* hr, const float* hi, float* ar, float* ai, int n)
+    {
+        int i = 0;
+        for (; i + 8 <= n; i += 8)
+        {
+            const __m256 a = _mm256_loadu_ps (xr + i), b = _mm256_loadu_ps (xi + i);
+            const __m256 c = _mm256_loadu_ps (hr + i), d = _mm256_loadu_ps (hi + i);
+            _mm256_storeu_ps (ar + i, _mm256_fnmadd_ps (b, d, _mm256_fmadd_ps (a, c, _mm256_loadu_ps (ar + i))));
+            _mm256_storeu_ps (ai + i, _mm256_fmadd_ps (b, c, _mm256_fmadd_ps (a, d, _mm256_loadu_ps (ai + i))));
+        }
+        sse2::complexMac (xr + i, xi + i, hr + i, hi + i, ar + i, ai + i, n - i);
+    }
+
+    AIDIO_TARGET ("avx2,fma") float dot (const float* a, const float* b, int n)
+    {
+        __m256 acc0 = _mm256_setzero_ps();
+        __m256 acc1 = _mm256_setzero_ps();
+        int i = 0;
+        for (; i + 16 <= n; i += 16)
+        {
+            acc0 = _mm256_fmadd_ps (_mm256_loadu_ps (a + i), _mm256_loadu_ps (b + i), acc0);
+            acc1 = _mm256_fmadd_ps (_mm256_loadu_ps (a + i + 8), _mm256_loadu_ps (b + i + 8), acc1);
+        }
+        const __m256 acc = _mm256_add_ps (acc0, acc1);
+        float lanes[4];
+        _mm_storeu_ps (lanes, _mm_add_ps (_mm256_castps256_ps128 (acc), _mm256_extractf128_ps (acc, 1)));
+        return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + sse2::dot (a + i, b + i, n - i);
+    }
+
+    AIDIO_TARGET ("avx2,fma") void dots (const float* a, const int* aOffsets, const float* b, const int* bOffsets, float* d, int count, int n)
+    {
+        int j = 0;
+        for (; j + 4 <= count; j += 4)              // 4 at once, summed across by hadd
+        {
+            const float* x[4];
+            const float* y[4];
+            __m256 acc[4];
+            for (int k = 0; k < 4; ++k)
+            {
+                x[k] = a + aOffsets[j + k];
+                y[k] = b + bOffsets[j + k];
+                acc[k] = _mm256_setzero_ps();
+            }
+            int i = 0;
+            for (; i + 8 <= n; i += 8)
+                for (int k = 0; k < 4; ++k)
+                    acc[k] = _mm256_fmadd_ps (_mm256_loadu_ps (x[k] + i), _mm256_loadu_ps (y[k] + i), acc[k]);
+
+            if (i < n)                              // masked, no SSE in the loop (transition stalls)
+            {
+                const __m256i m = _mm256_cmpgt_epi32 (_mm256_set1_epi32 (n - i), _mm256_setr_epi32 (0, 1, 2, 3, 4, 5, 6, 7));
+                for (int k = 0; k < 4; ++k)
+                    acc[k] = _mm256_fmadd_ps (_mm256_maskload_ps (x[k] + i, m), _mm256_maskload_ps (y[k] + i, m), acc[k]);
+            }
+
+            const __m256 sums = _mm256_hadd_ps (_mm256_hadd_ps (acc[0], acc[1]), _mm256_hadd_ps (acc[2], acc[3]));
+            _mm_storeu_ps (d + j, _mm_add_ps (_mm256_castps256_ps128 (sums), _mm256_extractf128_ps (sums, 1)));
+        }
+        for (; j < count; ++j)
+            d[j] = dot (a + aOffsets[j], b + bOffsets[j], n);
+    }
+
+    AIDIO_TARGET ("avx2,fma") void toFloat (const double* s, float* d, int n)
+    {
+        int i = 0;
+        for (; i + 4 <= n; i += 4)
+            _mm_storeu_ps (d + i, _mm256_cvtpd_ps (_mm256_loadu_pd (s + i)));
+        sse2::toFloat (s + i, d + i, n - i);
+    }
+
+    AIDIO_TARGET ("avx2,fma") void mixRampedDouble (const double* a, double ga, double incA, const double* b, double gb, double incB, double* d, int n)
+    {
+        const __m256d lanes = _mm256_set_pd (3.0, 2.0, 1.0, 0.0);
+        const __m256d startA = _mm256_set1_pd (ga), stepA = _mm256_set1_pd (incA);
+        const __m256d startB = _mm256_set1_pd (gb), stepB = _mm256_set1_pd (incB);
+        int i = 0;
+        for (; i + 4 <= n; i += 4)
+        {
+            const __m256d index = _mm256_add_pd (_mm256_set1_pd (static_cast<double> (i)), lanes);
+            const __m256d gainA = _mm256_fmadd_pd (index, stepA, startA);
+            const __m256d gainB = _mm256_fmadd_pd (index, stepB, startB);
+            _mm256_storeu_pd (d + i, _mm256_fmadd_pd (_mm256_loadu_pd (a + i), gainA,
+                                                      _mm256_mul_pd (_mm256_loadu_pd (b + i), gainB)));
+        }
+        sse2::mixRampedDouble (a + i, ga + incA * i, incA, b + i, gb + incB * i, incB, d + i, n - i);
+    }
+
+    AIDIO_TARGET ("avx2,fma") void mixRampedMixed (const double* a, double ga, double incA, const float* b, double gb, double incB, double* d, int n)
+    {
+        const __m256d lanes = _mm256_set_pd (3.0, 2.0, 1.0, 0.0);
+        const __m256d startA = _mm256_set1_pd (ga), stepA = _mm256_set1_pd (incA);
+        const __m256d startB = _mm256_set1_pd (gb), stepB = _mm256_set1_pd (incB);
+        int i = 0;
+        for (; i + 4 <= n; i += 4)
+        {
+            const __m256d index = _mm256_add_pd (_mm256_set1_pd (static_cast<double> (i)), lanes);
+            const __m256d gainA = _mm256_fmadd_pd (index, stepA, startA);
+            const __m256d gainB = _mm256_fmadd_pd (index, stepB, startB);
+            _mm256_storeu_pd (d + i, _mm256_fmadd_pd (_mm256_loadu_pd (a + i), gainA,
+                                                      _mm256_mul_pd (_mm256_cvtps_pd (_mm_loadu_ps (b + i)), gainB)));
+        }
+        sse2::mixRampedMixed (a + i, ga + incA * i, incA, b + i, gb + incB * i, incB, d + i, n - i);
+    }
+
+    const KernelTable table {scale, addScaled, mix, sum, peak, equals, mixRamped, scaleRamped, fir, complexMac, dots,
+                             toFloat, mixRampedDouble, mixRampedMixed};
+}
+
+//==============================================================================
+
+namespace avx512                            // masked loads/stores do the tails
+{
+    inline AIDIO_TARGET ("avx512f") __mmask16 tailMask (int remaining)
+    {
+        return static_cast<__mmask16> ((1u << remaining) - 1u);
+    }
+
+    AIDIO_TARGET ("avx512f") void scale (float* d, float g, int n)
+    {
+        const __m512 gain = _mm512_set1_ps (g);
+        int i = 0;
+        for (; i + 16 <= n; i += 16)
+            _mm512_storeu_ps (d + i, _mm512_mul_ps (_mm512_loadu_ps (d + i), gain));
+        if (i < n)
+        {
+            const __mmask16 m = tailMask (n - i);
+            _mm512_mask_storeu_ps (d + i, m, _mm512_mul_ps (_mm512_maskz_loadu_ps (m, d + i), gain));
+        }
+    }
+
+    AIDIO_TARGET ("avx512f") void addScaled (const float* s, float* d, float g, int n)
+    {
+        const __m512 gain = _mm512_set1_ps (g);
+        int i = 0;
+        for (; i + 16 <= n; i += 16)
+            _mm512_storeu_ps (d + i, _mm512_fmadd_ps (_mm512_loadu_ps (s + i), gain, _mm512_loadu_ps (d + i)));
+        if (i < n)
+        {
+            const __mmask16 m = tailMask (n - i);
+            _mm512_mask_storeu_ps (d + i, m, _mm512_fmadd_ps (_mm512_maskz_loadu_ps (m, s + i), gain,
+                                                              _mm512_maskz_loadu_ps (m, d + i)));
+        }
+    }
+
+    AIDIO_TARGET ("avx512f") void mix (const float* a, float ga, const float* b, float gb, float* d, int n)
+    {
+        const __m512 gainA = _mm512_set1_ps (ga);
+        const __m512 gainB = _mm512_set1_ps (gb);
+        int i = 0;
+        for (; i + 16 <= n; i += 16)
+            _mm512_storeu_ps (d + i, _mm512_fmadd_ps (_mm512_loadu_ps (a + i), gainA,
+                                                      _mm512_mul_ps (_mm512_loadu_ps (b + i), gainB)));
+        if (i < n)
+        {
+            const __mmask16 m = tailMask (n - i);
+            _mm512_mask_storeu_ps (d + i, m, _mm512_fmadd_ps (_mm512_maskz_loadu_ps (m, a + i), gainA,
+                                                              _mm512_mul_ps (_mm512_maskz_loadu_ps (m, b + i), gainB)));
+        }
+    }
+
+    AIDIO_TARGET ("avx512f") double sum (const float* s, int n)
+    {
+        __m512d lo = _mm512_setzero_pd();
+        __m512d hi = _mm512_setzero_pd();
+        int i = 0;
+        for (; i + 16 <= n; i += 16)
+        {
+            lo = _mm512_add_pd (lo, _mm512_cvtps_pd (_mm256_loadu_ps (s + i)));
+            hi = _mm512_add_pd (hi, _mm512_cvtps_pd (_mm256_loadu_ps (s + i + 8)));
+        }
+        return _mm512_reduce_add_pd (_mm512_add_pd (lo, hi)) + avx2::sum (s + i, n - i);
+    }
+
+    AIDIO_TARGET ("avx512f") float peak (const float* s, int n)
+    {
+        __m512 p = _mm512_setzero_ps();
+        int i = 0;
+        for (; i + 16 <= n; i += 16)
+            p = _mm512_max_ps (p, _mm512_abs_ps (_mm512_loadu_ps (s + i)));
+        if (i < n)
+            p = _mm512_max_ps (p, _mm512_abs_ps (_mm512_maskz_loadu_ps (tailMask (n - i), s + i)));
+        return _mm512_reduce_max_ps (p);
+    }
+
+    AIDIO_TARGET ("avx512f") bool equals (const float* a, const float* b, int n)
+    {
+        int i = 0;
+        for (; i + 16 <= n; i += 16)
+            if (_mm512_cmp_ps_mask (_mm512_loadu_ps (a + i), _mm512_loadu_ps (b + i), _CMP_NEQ_UQ) != 0)
+                return false;
+        if (i < n)
+        {
+            const __mmask16 m = tailMask (n - i);
+            return _mm512_mask_cmp_ps_mask (m, _mm512_maskz_loadu_ps (m, a + i),
+                                               _mm512_maskz_loadu_ps (m, b + i), _CMP_NEQ_UQ) == 0;
+        }
+        return true;
+    }
+
+    AIDIO_TARGET ("avx512f") void mixRamped (const float* a, float ga, float incA, const float* b, float gb, float incB, float* d, int n)
+    {
+        const __m512 lanes = _mm512_set_ps (15.0f, 14.0f, 13.0f, 12.0f, 11.0f, 10.0f, 9.0f, 8.0f,
+                                             7.0f,  6.0f,  5.0f,  4.0f,  3.0f,  2.0f, 1.0f, 0.0f);
+        const __m512 startA = _mm512_set1_ps (ga), stepA = _mm512_set1_ps (incA);
+        const __m512 startB = _mm512_set1_ps (gb), stepB = _mm512_set1_ps (incB);
+        for (int i = 0; i < n; i += 16)
+        {
+            const __mmask16 m = n - i >= 16 ? static_cast<__mmask16> (0xffff) : tailMask (n - i);
+            const __m512 index = _mm512_add_ps (_mm512_set1_ps (static_cast<float> (i)), lanes);
+            const __m512 gainA = _mm512_fmadd_ps (index, stepA, startA);
+            const __m512 gainB = _mm512_fmadd_ps (index, stepB, startB);
+            _mm512_mask_storeu_ps (d + i, m, _mm512_fmadd_ps (_mm512_maskz_loadu_ps (m, a + i), gainA,
+                                                              _mm512_mul_ps (_mm512_maskz_loadu_ps (m, b + i), gainB)));
+        }
+    }
+
+    AIDIO_TARGET ("avx512f") void scaleRamped (const float* s, float* d, float g, float inc, int n)
+    {
+        const __m512 lanes = _mm512_set_ps (15.0f, 14.0f, 13.0f, 12.0f, 11.0f, 10.0f, 9.0f, 8.0f,
+                                             7.0f,  6.0f,  5.0f,  4.0f,  3.0f,  2.0f, 1.0f, 0.0f);
+        const __m512 start = _mm512_set1_ps (g), step = _mm512_set1_ps (inc);
+        for (int i = 0; i < n; i += 16)
+        {
+            const __mmask16 m = n - i >= 16 ? static_cast<__mmask16> (0xffff) : tailMask (n - i);
+            const __m512 index = _mm512_add_ps (_mm512_set1_ps (static_cast<float> (i)), lanes);
+            _mm512_mask_storeu_ps (d + i, m, _mm512_mul_ps (_mm512_maskz_loadu_ps (m, s + i),
+                                                            _mm512_fmadd_ps (index, step, start)));
+        }
+    }
+
+        inline AIDIO_TARGET ("avx512f") void firStore (float* d, __m512 v, bool add)
+    {
+        _mm512_storeu_ps (d, add ? _mm512_add_ps (_mm512_loadu_ps (d), v) : v);
+    }
+
+    AIDIO_TARGET ("avx512f") void fir (const float* t, int nt, const float* s, float* d, int n, bool add)
+    {
+        int i = 0;
+        for (; i + 64 <= n; i += 64)
+        {
+            __m512 a0 = _mm512_setzero_ps(), a1 = a0, a2 = a0, a3 = a0;
+            const float* p = s + i;
+            for (int k = 0; k < nt; ++k, ++p)
+            {
+                const __m512 tap = _mm512_set1_ps (t[k]);
+                a0 = _mm512_fmadd_ps (tap, _mm512_loadu_ps (p),      a0);
+                a1 = _mm512_fmadd_ps (tap, _mm512_loadu_ps (p + 16), a1);
+                a2 = _mm512_fmadd_ps (tap, _mm512_loadu_ps (p + 32), a2);
+                a3 = _mm512_fmadd_ps (tap, _mm512_loadu_ps (p + 48), a3);
+            }
+            firStore (d + i,      a0, add);
+            firStore (d + i + 16, a1, add);
+            firStore (d + i + 32, a2, add);
+            firStore (d + i + 48, a3, add);
+        }
+        for (; i + 32 <= n; i += 32)                // e.g. a 32 sample host block
+        {
+            __m512 a0 = _mm512_setzero_ps(), a1 = a0, a2 = a0, a3 = a0;   // even & odd taps
+            int k = 0;
+            for (; k + 2 <= nt; k += 2)
+            {
+                const __m512 tap0 = _mm512_set1_ps (t[k]), tap1 = _mm512_set1_ps (t[k + 1]);
+                a0 = _mm512_fmadd_ps (tap0, _mm512_loadu_ps (s + i + k),          a0);
+                a1 = _mm512_fmadd_ps (tap0, _mm512_loadu_ps (s + i + k + 16),     a1);
+                a2 = _mm512_fmadd_ps (tap1, _mm512_loadu_ps (s + i + k + 1),      a2);
+                a3 = _mm512_fmadd_ps (tap1, _mm512_loadu_ps (s + i + k + 1 + 16), a3);
+            }
+            if (k < nt)
+            {
+                const __m512 tap0 = _mm512_set1_ps (t[k]);
+                a0 = _mm512_fmadd_ps (tap0, _mm512_loadu_ps (s + i + k),      a0);
+                a1 = _mm512_fmadd_ps (tap0, _mm512_loadu_ps (s + i + k + 16), a1);
+            }
+            firStore (d + i,      _mm512_add_ps (a0, a2), add);
+            firStore (d + i + 16, _mm512_add_ps (a1, a3), add);
+        }
+        avx2::fir (t, nt, s + i, d + i, n - i, add);
+    }
+
+    AIDIO_TARGET ("avx512f") void complexMac (const float* xr, const float* xi, const float* hr, const float* hi, float* ar, float* ai, int n)
+    {
+        int i = 0;
+        for (; i + 16 <= n; i += 16)
+        {
+            const __m512 a = _mm512_loadu_ps (xr + i), b = _mm512_loadu_ps (xi + i);
+            const __m512 c = _mm512_loadu_ps (hr + i), d = _mm512_loadu_ps (hi + i);
+            _mm512_storeu_ps (ar + i, _mm512_fnmadd_ps (b, d, _mm512_fmadd_ps (a, c, _mm512_loadu_ps (ar + i))));
+            _mm512_storeu_ps (ai + i, _mm512_fmadd_ps (b, c, _mm512_fmadd_ps (a, d, _mm512_loadu_ps (ai + i))));
+        }
+        if (i < n)
+        {
+            const __mmask16 m = tailMask (n - i);
+            const __m512 a = _mm512_maskz_loadu_ps (m, xr + i), b = _mm512_maskz_loadu_ps (m, xi + i);
+            const __m512 c = _mm512_maskz_loadu_ps (m, hr + i), d = _mm512_maskz_loadu_ps (m, hi + i);
+            _mm512_mask_storeu_ps (ar + i, m, _mm512_fnmadd_ps (b, d, _mm512_fmadd_ps (a, c, _mm512_maskz_loadu_ps (m, ar + i))));
+            _mm512_mask_storeu_ps (ai + i, m, _mm512_fmadd_ps (b, c, _mm512_fmadd_ps (a, d, _mm512_maskz_loadu_ps (m, ai + i))));
+        }
+    }
+
+    AIDIO_TARGET ("avx512f") float dot (const float* a, const float* b, int n)
+    {
+        __m512 acc0 = _mm512_setzero_ps();
+        __m512 acc1 = _mm512_setzero_ps();
+        int i = 0;
+        for (; i + 32 <= n; i += 32)
+        {
+            acc0 = _mm512_fmadd_ps (_mm512_loadu_ps (a + i), _mm512_loadu_ps (b + i), acc0);
+            acc1 = _mm512_fmadd_ps (_mm512_loadu_ps (a + i + 16), _mm512_loadu_ps (b + i + 16), acc1);
+        }
+        for (; i < n; i += 16)
+        {
+            const __mmask16 m = n - i >= 16 ? static_cast<__mmask16> (0xffff) : tailMask (n - i);
+            acc0 = _mm512_fmadd_ps (_mm512_maskz_loadu_ps (m, a + i), _mm512_maskz_loadu_ps (m, b + i), acc0);
+        }
+        return _mm512_reduce_add_ps (_mm512_add_ps (acc0, acc1));
+    }
+
+    AIDIO_TARGET ("avx512f") void dots (const float* a, const int* aOffsets, const float* b, const int* bOffsets, float* d, int count, int n)
+    {
+        int j = 0;
+        for (; j + 4 <= count; j += 4)              // 4 at once, tails masked
+        {
+            const float* x[4];
+            const float* y[4];
+            __m512 acc[4];
+            for (int k = 0; k < 4; ++k)
+            {
+                x[k] = a + aOffsets[j + k];
+                y[k] = b + bOffsets[j + k];
+                acc[k] = _mm512_setzero_ps();
+            }
+            for (int i = 0; i < n; i += 16)
+            {
+                const __mmask16 m = n - i >= 16 ? static_cast<__mmask16> (0xffff) : tailMask (n - i);
+                for (int k = 0; k < 4; ++k)
+                    acc[k] = _mm512_fmadd_ps (_mm512_maskz_loadu_ps (m, x[k] + i), _mm512_maskz_loadu_ps (m, y[k] + i), acc[k]);
+            }
+            for (int k = 0; k < 4; ++k)
+                d[j + k] = _mm512_reduce_add_ps (acc[k]);
+        }
+        for (; j < count; ++j)
+            d[j] = dot (a + aOffsets[j], b + bOffsets[j], n);
+    }
+
+    AIDIO_TARGET ("avx512f") void toFloat (const double* s, float* d, int n)
+    {
+        for (int i = 0; i < n; i += 8)              // 8 doubles to 8 floats, the lower half of a 16 float store
+        {
+            const __mmask16 m = n - i >= 8 ? static_cast<__mmask16> (0xff) : tailMask (n - i);
+            const __m256 narrow = _mm512_cvtpd_ps (_mm512_maskz_loadu_pd (static_cast<__mmask8> (m), s + i));
+            _mm512_mask_storeu_ps (d + i, m, _mm512_castps256_ps512 (narrow));
+        }
+    }
+
+    AIDIO_TARGET ("avx512f") void mixRampedDouble (const double* a, double ga, double incA, const double* b, double gb, double incB, double* d, int n)
+    {
+        const __m512d lanes = _mm512_set_pd (7.0, 6.0, 5.0, 4.0, 3.0, 2.0, 1.0, 0.0);
+        const __m512d startA = _mm512_set1_pd (ga), stepA = _mm512_set1_pd (incA);
+        const __m512d startB = _mm512_set1_pd (gb), stepB = _mm512_set1_pd (incB);
+        for (int i = 0; i < n; i += 8)
+        {
+            const __mmask8 m = n - i >= 8 ? static_cast<__mmask8> (0xff) : static_cast<__mmask8> (tailMask (n - i));
+            const __m512d index = _mm512_add_pd (_mm512_set1_pd (static_cast<double> (i)), lanes);
+            const __m512d gainA = _mm512_fmadd_pd (index, stepA, startA);
+            const __m512d gainB = _mm512_fmadd_pd (index, stepB, startB);
+            _mm512_mask_storeu_pd (d + i, m, _mm512_fmadd_pd (_mm512_maskz_loadu_pd (m, a + i), gainA,
+                                                              _mm512_mul_pd (_mm512_maskz_loadu_pd (m, b + i), gainB)));
+        }
+    }
+
+    AIDIO_TARGET ("avx512f") void mixRampedMixed (const double* a, double ga, double incA, const float* b, double gb, double incB, double* d, int n)
+    {
+        const __m512d lanes = _mm512_set_pd (7.0, 6.0, 5.0, 4.0, 3.0, 2.0, 1.0, 0.0);
+        const __m512d startA = _mm512_set1_pd (ga), stepA = _mm512_set1_pd (incA);
+        const __m512d startB = _mm512_set1_pd (gb), stepB = _mm512_set1_pd (incB);
+        for (int i = 0; i < n; i += 8)
+        {
+            const __mmask16 m = n - i >= 8 ? static_cast<__mmask16> (0xff) : tailMask (n - i);
+            const __m512d index = _mm512_add_pd (_mm512_set1_pd (static_cast<double> (i)), lanes);
+            const __m512d gainA = _mm512_fmadd_pd (index, stepA, startA);
+            const __m512d gainB = _mm512_fmadd_pd (index, stepB, startB);
+            const __m512d wide = _mm512_cvtps_pd (_mm512_castps512_ps256 (_mm512_maskz_loadu_ps (m, b + i)));
+            _mm512_mask_storeu_pd (d + i, static_cast<__mmask8> (m),
+                                   _mm512_fmadd_pd (_mm512_maskz_loadu_pd (static_cast<__mmask8> (m), a + i), gainA,
+                                                    _mm512_mul_pd (wide, gainB)));
+        }
+    }
+
+    const KernelTable table {scale, addScaled, mix, sum, peak, equals, mixRamped, scaleRamped, fir, complexMac, dots,
+                             toFloat, mixRampedDouble, mixRampedMixed};
+}
+
+#endif // AIDIO_KERNELS_X86
+
+//==============================================================================
+
+SimdLevel detectSimdLevel()
+{
+   #if AIDIO_KERNELS_X86
+    #if defined (_MSC_VER) && ! defined (__clang__)
+     int info[4];
+     __cpuid (info, 0);
+     const int maxLeaf = info[0];
+
+     __cpuid (info, 1);
+     const bool hasSse2  = (info[3] & (1 << 26)) != 0;
+     const bool hasFma   = (info[2] & (1 << 12)) != 0;
+     const bool hasAvxOs = (info[2] & (1 << 27)) != 0    // OSXSAVE
+                        && (info[2] & (1 << 28)) != 0;   // AVX
+     const unsigned long long xcr0 = hasAvxOs ? _xgetbv (0) : 0;
+
+     bool hasAvx2 {false}, hasAvx512 {false};
+     if (maxLeaf >= 7)
+     {
+         __cpuidex (info, 7, 0);
+         hasAvx2   = (info[1] & (1 << 5))  != 0;
+         hasAvx512 = (info[1] & (1 << 16)) != 0;
+     }
+
+     const bool osSavesYmm = (xcr0 & 0x06) == 0x06;
+     const bool osSavesZmm = (xcr0 & 0xe6) == 0xe6;
+
+     if (hasAvx512 && osSavesZmm)                   return SimdLevel::avx512;
+     if (hasAvx2 && hasFma && osSavesYmm)           return SimdLevel::avx2;
+     if (hasSse2)                                   return SimdLevel::sse2;
+    #else
+     __builtin_cpu_init();                          // also checks the OS saves the registers
+     if (__builtin_cpu_supports ("avx512f"))        return SimdLevel::avx512;
+     if (__builtin_cpu_supports ("avx2")
+          && __builtin_cpu_supports ("fma"))       return SimdLevel::avx2;
+     if (__builtin_cpu_supports ("sse2"))           return SimdLevel::sse2;
+    #endif
+   #endif
+    return SimdLevel::scalar;
+}
+
+const KernelTable& tableFor (SimdLevel level)
+{
+    switch (level)
+    {
+       #if AIDIO_KERNELS_X86
+        case SimdLevel::avx512: return avx512::table;
+        case SimdLevel::avx2:   return avx2::table;
+        case SimdLevel::sse2:   return sse2::table;
+       #endif
+        default:                return scalar::table;
+    }
+}
+
+std::atomic<int>& activeLevel()
+{
+    static std::atomic<int> level {static_cast<int> (getHighestSupportedSimdLevel())};
+    return level;
+}
+
+inline const KernelTable& kernels()
+{
+    return tableFor (static_cast<SimdLevel> (activeLevel().load (std::memory_order_relaxed)));
+}
+
+} // namespace
+
+//==============================================================================
+
+SimdLevel getHighestSupportedSimdLevel()
+{
+    static const SimdLevel highest {detectSimdLevel()};
+    return highest;
+}
+
+SimdLevel getSimdLevel()
+{
+    return static_cast<SimdLevel> (activeLevel().load());
+}
+
+void setSimdLevel (SimdLevel level)
+{
+    if (level > getHighestSupportedSimdLevel())
+        level = getHighestSupportedSimdLevel();
+    activeLevel().store (static_cast<int> (level));
+}
+
+//==============================================================================
+
+void vectorCopy (const float* src, float* dest, int numSamples)
+{
+    if (src != dest && numSamples > 0)              // libc memcpy is already vectorised & dispatched
+        std::memcpy (dest, src, sizeof (float) * static_cast<size_t> (numSamples));
+}
+
+void vectorCopy (const double* src, double* dest, int numSamples)
+{
+    if (src != dest && numSamples > 0)
+        std::memcpy (dest, src, sizeof (double) * static_cast<size_t> (numSamples));
+}
+
+void vectorConvert (const double* src, float* dest, int numSamples)
+{
+    kernels().toFloat (src, dest, numSamples);
+}
+
+void vectorScale (float* data, float gain, int numSamples)
+{
+    kernels().scale (data, gain, numSamples);
+}
+
+void vectorAdd (const float* src, float* dest, int numSamples)
+{
+    kernels().addScaled (src, dest, 1.0f, numSamples);
+}
+
+void vectorAddScaled (const float* src, float* dest, float gain, int numSamples)
+{
+    kernels().addScaled (src, dest, gain, numSamples);
+}
+
+void vectorMix (const float* a, float gainA, const float* b, float gainB, float* dest, int numSamples)
+{
+    kernels().mix (a, gainA, b, gainB, dest, numSamples);
+}
+
+void vectorMixRamped (const float* a, float gainAStart, float gainAEnd,
+                      const float* b, float gainBStart, float gainBEnd,
+                      float* dest, int numSamples)
+{
+    if (numSamples <= 0)
+        return;
+
+    const float incA = (gainAEnd - gainAStart) / numSamples;
+    const float incB = (gainBEnd - gainBStart) / numSamples;
+    kernels().mixRamped (a, gainAStart, incA, b, gainBStart, incB, dest, numSamples);
+}
+
+void vectorMixRamped (const double* a, float gainAStart, float gainAEnd,
+                      const double* b, float gainBStart, float gainBEnd,
+                      double* dest, int numSamples)
+{
+    if (numSamples <= 0)
+        return;
+
+    const double incA = (static_cast<double> (gainAEnd) - gainAStart) / numSamples;
+    const double incB = (static_cast<double> (gainBEnd) - gainBStart) / numSamples;
+    kernels().mixRampedDouble (a, gainAStart, incA, b, gainBStart, incB, dest, numSamples);
+}
+
+void vectorMixRamped (const double* a, float gainAStart, float gainAEnd,
+                      const float* b, float gainBStart, float gainBEnd,
+                      double* dest, int numSamples)
+{
+    if (numSamples <= 0)
+        return;
+
+    const double incA = (static_cast<double> (gainAEnd) - gainAStart) / numSamples;
+    const double incB = (static_cast<double> (gainBEnd) - gainBStart) / numSamples;
+    kernels().mixRampedMixed (a, gainAStart, incA, b, gainBStart, incB, dest, numSamples);
+}
+
+void vectorScaleRamped (const float* src, float* dest, float gainStart, float gainEnd, int numSamples)
+{
+    if (numSamples <= 0)
+        return;
+
+    kernels().scaleRamped (src, dest, gainStart, (gainEnd - gainStart) / numSamples, numSamples);
+}
+
+float vectorSum (const float* data, int numSamples)
+{
+    return static_cast<float> (kernels().sum (data, numSamples));
+}
+
+float vectorPeak (const float* data, int numSamples)
+{
+    return kernels().peak (data, numSamples);
+}
+
+bool vectorEquals (const float* a, const float* b, int numSamples)
+{
+    return kernels().equals (a, b, numSamples);
+}
+
+void vectorFir (const float* reversedTaps, int numTaps, const float* src,
+                float* dest, int numSamples, bool accumulate)
+{
+    if (numSamples > 0 && numTaps > 0)
+        kernels().fir (reversedTaps, numTaps, src, dest, numSamples, accumulate);
+    else if (numSamples > 0 && ! accumulate)
+        std::memset (dest, 0, sizeof (float) * static_cast<size_t> (numSamples));
+}
+
+void vectorComplexMultiplyAdd (const float* xRe, const float* xIm, const float* hRe, const float* hIm,
+                               float* accRe, float* accIm, int numSamples)
+{
+    kernels().complexMac (xRe, xIm, hRe, hIm, accRe, accIm, numSamples);
+}
+
+void vectorDots (const float* a, const int* aOffsets, const float* b, const int* bOffsets,
+                 float* dest, int numDots, int numSamples)
+{
+    kernels().dots (a, aOffsets, b, bOffsets, dest, numDots, numSamples);
+}
+
+} // namespace
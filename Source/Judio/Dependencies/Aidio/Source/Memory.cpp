@@ -0,0 +1,247 @@
+//==============================================================================
+/*
+    The MIT License (MIT)
+
+    Copyright (c) 2016 John Flynn
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to
+    deal in the Software without restriction, including without limitation the
+    rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+    sell copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+    IN THE SOFTWARE.
+*/
+
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+#include "../Memory.h"
+
+#if defined (_WIN32)
+ #ifndef NOMINMAX
+  #define NOMINMAX
+ #endif
+ #include <windows.h>
+#else
+ #include <sys/mman.h>
+ #include <sys/resource.h>
+ #include <unistd.h>
+#endif
+
+namespace ado
+{
+
+//==============================================================================
+
+namespace
+{
+    size_t getPageSize()
+    {
+       #if defined (_WIN32)
+        SYSTEM_INFO info;
+        GetSystemInfo (&info);
+        return static_cast<size_t> (info.dwPageSize);
+       #else
+        const long size = sysconf (_SC_PAGESIZE);
+        return size > 0 ? static_cast<size_t> (size) : 4096;
+       #endif
+    }
+
+    // mlock wants whole pages on some systems, so round out to page boundaries
+    std::pair<void*, size_t> pageAlign (void* data, size_t numBytes)
+    {
+        const uintptr_t page  = getPageSize();
+        const uintptr_t start = reinterpret_cast<uintptr_t> (data) & ~(page - 1);
+        const uintptr_t end   = (reinterpret_cast<uintptr_t> (data) + numBytes + page - 1) & ~(page - 1);
+        return {reinterpret_cast<void*> (start), static_cast<size_t> (end - start)};
+    }
+
+    // Blocks share pages (heap neighbours, other engines' buffers), and the OS
+    // doesn't count locks: one munlock unlocks a page for everyone. So each
+    // page is counted here, locked by its first user & unlocked by its last.
+    std::mutex pageLocksMutex;
+    std::unordered_map<uintptr_t, int>& getPageLocks()
+    {
+        static std::unordered_map<uintptr_t, int> pageLocks;
+        return pageLocks;
+    }
+
+    bool lockPages (void* start, size_t numBytes)
+    {
+       #if defined (_WIN32)
+        return VirtualLock (start, numBytes) != 0;
+       #else
+        return mlock (start, numBytes) == 0;
+       #endif
+    }
+
+    void unlockPages (void* start, size_t numBytes)
+    {
+       #if defined (_WIN32)
+        VirtualUnlock (start, numBytes);
+       #else
+        munlock (start, numBytes);
+       #endif
+    }
+}
+
+//==============================================================================
+
+size_t prefaultMemory (void* data, size_t numBytes)
+{
+    if (data == nullptr || numBytes == 0)
+        return 0;
+
+    auto bytes = static_cast<volatile char*> (data);
+    const size_t page = getPageSize();
+
+    for (size_t i = 0; i < numBytes; i += page)
+        bytes[i] = bytes[i];                        // write, so copy-on-write zero pages get real pages
+    bytes[numBytes - 1] = bytes[numBytes - 1];
+
+    return numBytes;
+}
+
+//==============================================================================
+
+bool lockMemory (void* data, size_t numBytes)
+{
+    if (data == nullptr || numBytes == 0)
+        return true;
+
+    const auto region = pageAlign (data, numBytes);
+    const uintptr_t page  = getPageSize();
+    const uintptr_t start = reinterpret_cast<uintptr_t> (region.first);
+
+    std::lock_guard<std::mutex> lock {pageLocksMutex};
+
+    if (! lockPages (region.first, region.second))  // already locked pages stay so
+        return false;
+
+    for (uintptr_t p = start; p < start + region.second; p += page)
+        ++getPageLocks()[p];
+    return true;
+}
+
+void unlockMemory (void* data, size_t numBytes)
+{
+    if (data == nullptr || numBytes == 0)
+        return;
+
+    const auto region = pageAlign (data, numBytes);
+    const uintptr_t page  = getPageSize();
+    const uintptr_t start = reinterpret_cast<uintptr_t> (region.first);
+    const uintptr_t end   = start + region.second;
+
+    std::lock_guard<std::mutex> lock {pageLocksMutex};
+    auto& pageLocks = getPageLocks();
+
+    uintptr_t runStart {0};                         // pages no longer locked by anyone, unlocked in runs
+    for (uintptr_t p = start; p <= end; p += page)
+    {
+        bool release {false};
+        if (p < end)
+        {
+            auto count = pageLocks.find (p);
+            if (count != pageLocks.end() && --count->second == 0)
+            {
+                pageLocks.erase (count);
+                release = true;
+            }
+        }
+
+        if (release && runStart == 0)
+            runStart = p;
+        else if (! release && runStart != 0)
+        {
+            unlockPages (reinterpret_cast<void*> (runStart), static_cast<size_t> (p - runStart));
+            runStart = 0;
+        }
+    }
+}
+
+//==============================================================================
+
+size_t getMemoryLockLimit()
+{
+   #if defined (_WIN32)
+    SIZE_T minSize, maxSize;
+    if (GetProcessWorkingSetSize (GetCurrentProcess(), &minSize, &maxSize))
+        return static_cast<size_t> (minSize);       // VirtualLock is bounded by the min working set
+    return 0;
+   #else
+    struct rlimit limit;
+    if (getrlimit (RLIMIT_MEMLOCK, &limit) != 0)
+        return 0;
+    if (limit.rlim_cur == RLIM_INFINITY)
+        return SIZE_MAX;
+    return static_cast<size_t> (limit.rlim_cur);
+   #endif
+}
+
+//==============================================================================
+
+void MemoryLocker::add (void* data, size_t numBytes)
+{
+    if (data != nullptr && numBytes > 0)
+        blocks.push_back ({data, numBytes, false});
+}
+
+void MemoryLocker::lock (bool shouldLock)
+{
+    report = MemoryLockReport();
+    report.lockLimit = getMemoryLockLimit();
+
+    for (auto& block : blocks)
+        report.bytesTouched += prefaultMemory (block.data, block.numBytes);
+
+    if (! shouldLock)
+        return;
+
+    size_t pagesNeeded {0};
+    for (auto& block : blocks)
+        pagesNeeded += pageAlign (block.data, block.numBytes).second;
+
+    if (report.lockLimit != 0 && pagesNeeded > report.lockLimit)  // don't lock half, then fail
+    {
+        report.lockFailed = true;
+        return;
+    }
+
+    for (auto& block : blocks)
+    {
+        if (! block.isLocked && lockMemory (block.data, block.numBytes))
+        {
+            block.isLocked = true;
+            report.bytesLocked += block.numBytes;
+        }
+        else if (! block.isLocked)
+            report.lockFailed = true;
+        else
+            report.bytesLocked += block.numBytes;
+    }
+}
+
+void MemoryLocker::clear()
+{
+    for (auto& block : blocks)
+        if (block.isLocked)                         // only its own locks, others' pages stay locked
+            unlockMemory (block.data, block.numBytes);
+
+    blocks.clear();
+    report = MemoryLockReport();
+}
+
+} // namespace
@@ -0,0 +1,201 @@
+//==============================================================================
+/*
+    The MIT License (MIT)
+
+    Copyright (c) 2016 John Flynn
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to
+    deal in the Software without restriction, including without limitation the
+    rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+    sell copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+    IN THE SOFTWARE.
+*/
+//==============================================================================
+
+
+
+#include <algorithm>
+#include "../Dependencies/gsl.h"
+#include "../MultiStreamConvolution.h"
+#include "../Kernels.h"
+#include "../Utility.h"
+
+namespace ado
+{
+
+//==============================================================================
+MultiStreamConvolution::Spectra::Spectra (const ado::Buffer& impulse, int channel, int size)
+    : blockSize {size},
+      numPartitions {std::max (1, (impulse.getNumSamples() + size - 1) / size)}
+{
+    Expects (0 <= channel && channel < impulse.getNumChannels());
+    Expects (isPowerOf2 (blockSize) && 16 <= blockSize && blockSize <= 16384);
+
+    WDL_fft_init();
+
+    const int fftSize {2 * blockSize};
+    re.clearAndResize (numPartitions, fftSize);
+    im.clearAndResize (numPartitions, fftSize);
+
+    const float* const h {impulse.getReadArray()[channel]};
+    std::vector<WDL_FFT_COMPLEX> slice (static_cast<size_t> (fftSize));
+
+    for (int p = 0; p < numPartitions; ++p)
+    {
+        const int start {p * blockSize};
+        const int length {std::min (blockSize, impulse.getNumSamples() - start)};
+
+        std::fill (slice.begin(), slice.end(), WDL_FFT_COMPLEX {0.0f, 0.0f});
+        for (int s = 0; s < length; ++s)
+            slice[static_cast<size_t> (s)].re = h[start + s];
+
+        WDL_fft (slice.data(), fftSize, false);     // permuted order, as the inverse takes it
+
+        const float scale {1.0f / fftSize};         // the inverse doesn't
+        for (int k = 0; k < fftSize; ++k)
+        {
+            re.getWriteArray()[p][k] = slice[static_cast<size_t> (k)].re * scale;
+            im.getWriteArray()[p][k] = slice[static_cast<size_t> (k)].im * scale;
+        }
+    }
+}
+
+//==============================================================================
+MultiStreamConvolution::MultiStreamConvolution (std::shared_ptr<const Spectra> impulseSpectra, int streams)
+    : spectra {std::move (impulseSpectra)},
+      numStreams {streams},
+      numPairs {(streams + 1) / 2},
+      blockSize {spectra != nullptr ? spectra->getBlockSize() : 0},
+      fftSize {2 * blockSize},
+      numPartitions {spectra != nullptr ? spectra->getNumPartitions() : 0},
+      numSlots {numPartitions + maxBlocksAtOnce - 1}
+{
+    Expects (spectra != nullptr);
+    Expects (0 < numStreams);
+
+    historyRe.clearAndResize (numPairs * numSlots, fftSize);
+    historyIm.clearAndResize (numPairs * numSlots, fftSize);
+    accRe.clearAndResize (numPairs * maxBlocksAtOnce, fftSize);
+    accIm.clearAndResize (numPairs * maxBlocksAtOnce, fftSize);
+    previous.clearAndResize (numStreams, blockSize);
+    work.resize (static_cast<size_t> (fftSize));
+}
+
+void MultiStreamConvolution::process (float* const* streams, int numSamples)
+{
+    Expects (numSamples % blockSize == 0);
+
+    for (int offset = 0; offset < numSamples; offset += maxBlocksAtOnce * blockSize)
+        processBlocks (streams, offset, std::min (maxBlocksAtOnce, (numSamples - offset) / blockSize));
+}
+
+void MultiStreamConvolution::reset()
+{
+    historyRe.clear();
+    historyIm.clear();
+    previous.clear();
+    current = 0;
+}
+
+//==============================================================================
+//private:
+
+void MultiStreamConvolution::processBlocks (float* const* streams, int offset, int numBlocks)
+{
+    WDL_FFT_COMPLEX* const w {work.data()};
+
+        // Each pair's last two blocks in, transformed, into each block's slot
+    for (int q = 0; q < numPairs; ++q)
+    {
+        const int a {2 * q};
+        const int b {2 * q + 1};                // numStreams if it's odd: imaginary part silent
+
+        for (int j = 0; j < numBlocks; ++j)
+        {
+            const int start {offset + j * blockSize};
+
+            for (int s = 0; s < blockSize; ++s)
+            {
+                w[s].re = previous.getReadArray()[a][s];
+                w[s].im = b < numStreams ? previous.getReadArray()[b][s] : 0.0f;
+                w[blockSize + s].re = streams[a][start + s];
+                w[blockSize + s].im = b < numStreams ? streams[b][start + s] : 0.0f;
+            }
+            std::copy (streams[a] + start, streams[a] + start + blockSize, previous.getWriteArray()[a]);
+            if (b < numStreams)
+                std::copy (streams[b] + start, streams[b] + start + blockSize, previous.getWriteArray()[b]);
+
+            WDL_fft (w, fftSize, false);
+
+            const int slot {q * numSlots + (current + j) % numSlots};
+            for (int k = 0; k < fftSize; ++k)
+            {
+                historyRe.getWriteArray()[slot][k] = w[k].re;
+                historyIm.getWriteArray()[slot][k] = w[k].im;
+            }
+        }
+    }
+
+        // Each block's spectra sum, partition p by the block in p blocks
+        // before it. A tile of bins at a time through every pair, partition
+        // & block, so the tile stays in cache for all of them
+    accRe.clear();
+    accIm.clear();
+
+    for (int k = 0; k < fftSize; k += tileSize)
+    {
+        const int numBins {std::min (tileSize, fftSize - k)};
+
+        for (int q = 0; q < numPairs; ++q)
+            for (int p = 0; p < numPartitions; ++p)
+                for (int j = 0; j < numBlocks; ++j)
+                {
+                    const int slot {q * numSlots + (current + j - p + numSlots) % numSlots};
+                    const int sum {q * maxBlocksAtOnce + j};
+                    vectorComplexMultiplyAdd (historyRe.getReadArray()[slot] + k, historyIm.getReadArray()[slot] + k,
+                                              spectra->re.getReadArray()[p] + k, spectra->im.getReadArray()[p] + k,
+                                              accRe.getWriteArray()[sum] + k, accIm.getWriteArray()[sum] + k,
+                                              numBins);
+                }
+    }
+
+        // Back per pair, the second half (the first wrapped around) out
+    for (int q = 0; q < numPairs; ++q)
+    {
+        const int a {2 * q};
+        const int b {2 * q + 1};
+
+        for (int j = 0; j < numBlocks; ++j)
+        {
+            const float* const sumRe {accRe.getReadArray()[q * maxBlocksAtOnce + j]};
+            const float* const sumIm {accIm.getReadArray()[q * maxBlocksAtOnce + j]};
+            for (int k = 0; k < fftSize; ++k)
+                w[k] = {sumRe[k], sumIm[k]};
+
+            WDL_fft (w, fftSize, true);
+
+            const int start {offset + j * blockSize};
+            for (int s = 0; s < blockSize; ++s)
+                streams[a][start + s] = w[blockSize + s].re;
+            if (b < numStreams)
+                for (int s = 0; s < blockSize; ++s)
+                    streams[b][start + s] = w[blockSize + s].im;
+        }
+    }
+
+    current = (current + numBlocks) % numSlots;
+}
+
+} // namespace ado
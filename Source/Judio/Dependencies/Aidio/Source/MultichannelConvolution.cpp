@@ -0,0 +1,723 @@
+//==============================================================================
+/*
+    The MIT License (MIT)
+
+    Copyright (c) 2016 John Flynn
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to
+    deal in the Software without restriction, including without limitation the
+    rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+    sell copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+    IN THE SOFTWARE.
+*/
+//==============================================================================
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <utility>
+#include "../Dependencies/gsl.h"
+#include "../MultichannelConvolution.h"
+#include "../Kernels.h"
+
+namespace ado
+{
+
+//==============================================================================
+/** One engine, and the block channels it convolves */
+struct MultichannelConvolution::Group
+{
+    Group (ado::Buffer impulse, std::vector<int> blockChannels)
+        : ir {std::move (impulse)},
+          engine {ir},
+          channels {std::move (blockChannels)},
+          pointers (channels.size(), nullptr)
+    {
+    }
+
+    ado::Buffer ir;
+    Convolution engine;
+    std::vector<int> channels;
+    std::vector<float*> pointers;               // filled each block
+};
+
+//==============================================================================
+/** Realtime priority threads shared by every MultichannelConvolution in the
+    process, started once and kept while any engine holds the pool (so set()
+    & prepare() never restart them).
+
+    Each engine with workers owns a slot. Per block it publishes its groups
+    there and wakes a few threads, then claims groups itself, through the
+    slot's counter, until none are left: the audio thread never sleeps on a
+    worker that hasn't started, it only waits (spinning, then yielding) for
+    groups a worker is already running. A group is claimed by a CAS on the
+    slot's state, the block's generation, group count & next group packed
+    together, so a late worker can't claim from a block already done.
+*/
+class MultichannelConvolution::WorkerPool
+{
+public:
+    static constexpr int maxThreads {32};
+    static constexpr int maxSlots   {64};
+
+    ~WorkerPool()
+    {
+        for (int t = 0; t < numThreads.load(); ++t)
+            threads[static_cast<size_t> (t)]->signalThreadShouldExit();
+
+        for (int t = 0; t < numThreads.load(); ++t)
+        {
+            threads[static_cast<size_t> (t)]->go.signal();
+            threads[static_cast<size_t> (t)]->stopThread (1000);
+        }
+    }
+
+    static std::shared_ptr<WorkerPool> getShared()
+    {
+        static std::mutex mutex;
+        static std::weak_ptr<WorkerPool> shared;
+
+        std::lock_guard<std::mutex> lock {mutex};
+        std::shared_ptr<WorkerPool> pool = shared.lock();
+        if (pool == nullptr)
+        {
+            pool.reset (new WorkerPool);
+            shared = pool;
+        }
+        return pool;
+    }
+
+    /** Starts threads up to this many (or maxThreads), never stops any. */
+    int reserveThreads (int count)
+    {
+        std::lock_guard<std::mutex> lock {threadsMutex};
+        const int limit {maxThreads};
+
+        for (int t = numThreads.load(); t < std::min (count, limit); ++t)
+        {
+            threads[static_cast<size_t> (t)].reset (new Worker {*this});
+            threads[static_cast<size_t> (t)]->startThread (10);    // realtime, as the audio thread
+            numThreads.store (t + 1);
+        }
+        return std::min (count, numThreads.load());
+    }
+
+    /** A slot for owner's blocks, or -1 if all are taken */
+    int acquireSlot (MultichannelConvolution& owner)
+    {
+        for (int i = 0; i < maxSlots; ++i)
+        {
+            bool free {false};
+            if (slots[i].inUse.compare_exchange_strong (free, true))
+            {
+                slots[i].owner.store (&owner);
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    void releaseSlot (int slot)
+    {
+        slots[slot].owner.store (nullptr);
+        slots[slot].inUse.store (false);
+    }
+
+    /** Audio thread: runs owner's groups 0 to numJobs - 1 with up to
+        numHelpers threads, returning when all are done.
+    */
+    void run (int slot, int numJobs, int numHelpers)
+    {
+        Slot& s = slots[slot];
+        const uint64_t generation = (s.state.load() >> 32) + 1;
+
+        s.remaining.store (numJobs);
+        s.state.store ((generation << 32) | (static_cast<uint64_t> (numJobs) << 16));
+
+        wake (numHelpers);
+
+        while (claim (s))                       // whatever the workers haven't taken
+            ;
+
+        for (int spins = 0; s.remaining.load() > 0; ++spins)    // only groups on a worker now
+            if (spins >= maxSpins)
+                juce::Thread::yield();
+    }
+
+private:
+    struct Slot
+    {
+        std::atomic<bool> inUse {false};
+        std::atomic<MultichannelConvolution*> owner {nullptr};  // fixed while inUse
+        std::atomic<uint64_t> state {0};        // generation << 32 | numJobs << 16 | next
+        std::atomic<int> remaining {0};         // groups not yet finished
+    };
+
+    struct Worker  : public juce::Thread
+    {
+        explicit Worker (WorkerPool& owningPool)
+            : juce::Thread {"Convolution worker"}, pool (owningPool)
+        {
+        }
+
+        void run() override
+        {
+            while (! threadShouldExit())
+            {
+                if (pool.claimAny())
+                    continue;
+
+                sleeping.store (true);
+                if (! pool.hasWork())           // after the flag, so a wake can't be missed
+                    go.wait();
+                sleeping.store (false);
+            }
+        }
+
+        WorkerPool& pool;
+        std::atomic<bool> sleeping {false};
+        juce::WaitableEvent go;
+    };
+
+    static constexpr int maxSpins {2000};      // the audio thread's, waiting on a worker's group
+
+    WorkerPool() = default;
+
+    static bool claim (Slot& s)
+    {
+        uint64_t state = s.state.load();
+        for (;;)
+        {
+            const int numJobs = static_cast<int> ((state >> 16) & 0xffff);
+            const int next    = static_cast<int> (state & 0xffff);
+            if (next >= numJobs)
+                return false;
+
+            MultichannelConvolution* owner = s.owner.load();   // valid if the state's unchanged
+            if (s.state.compare_exchange_weak (state, state + 1))
+            {
+                owner->processGroup (next);
+                s.remaining.fetch_sub (1);
+                return true;
+            }
+        }
+    }
+
+    bool claimAny()
+    {
+        bool any {false};
+        for (auto& s : slots)
+            while (claim (s))
+                any = true;
+        return any;
+    }
+
+    bool hasWork() const
+    {
+        for (auto& s : slots)
+        {
+            const uint64_t state = s.state.load();
+            if ((state & 0xffff) < ((state >> 16) & 0xffff))
+                return true;
+        }
+        return false;
+    }
+
+    void wake (int count)
+    {
+        const int n = numThreads.load();
+        const unsigned first = nextToWake.fetch_add (static_cast<unsigned> (count));  // spread the engines
+
+        for (int i = 0; i < std::min (count, n); ++i)
+        {
+            Worker& w = *threads[(first + static_cast<unsigned> (i)) % static_cast<unsigned> (n)];
+            if (w.sleeping.load())              // otherwise it's looking for work already
+                w.go.signal();
+        }
+    }
+
+    std::array<Slot, maxSlots> slots;
+    std::array<std::unique_ptr<Worker>, maxThreads> threads;
+    std::atomic<int> numThreads {0};
+    std::atomic<unsigned> nextToWake {0};
+    std::mutex threadsMutex;
+};
+
+//==============================================================================
+
+MultichannelConvolution::MultichannelConvolution (const ado::Buffer& impulse, int maxNumWorkers)
+    : irCurrent {&impulse},
+      sampleRate {static_cast<double> (impulse.getSampleRate())},
+      maxWorkers {std::max (0, maxNumWorkers)}
+{
+}
+
+MultichannelConvolution::~MultichannelConvolution()
+{
+    if (pool != nullptr)
+        pool->releaseSlot (poolSlot);
+}
+
+void MultichannelConvolution::set (const ado::Buffer& impulse)
+{
+    irCurrent = &impulse;
+
+    if (preparedNumChannels > 0)
+        rebuild();
+}
+
+void MultichannelConvolution::resampleIrOnRateChange (double newSampleRate)
+{
+    const bool wasConverting = isConvertingRate();
+    sampleRate = newSampleRate;
+    updateRateConversion();
+
+    if (preparedNumChannels > 0 && (wasConverting || isConvertingRate()))
+        rebuild();                              // the engines' block size & rate change with the host's
+    else
+        for (auto& g : groups)
+            g->engine.resampleIrOnRateChange (getEngineRate());
+}
+
+void MultichannelConvolution::setInternalRate (int rate)
+{
+    Expects (0 <= rate);
+
+    internalRate = rate;
+    updateRateConversion();
+
+    if (preparedNumChannels > 0)
+        rebuild();
+}
+
+void MultichannelConvolution::setTopology (Convolution::Topology newTopology)
+{
+    topology = newTopology;
+
+    if (groups.size() == 1 && preparedNumChannels <= 2)
+        groups.front()->engine.setTopology (topology);
+}
+
+void MultichannelConvolution::setHeadSize (int numSamples)
+{
+    headSize = numSamples;
+
+    for (auto& g : groups)
+        g->engine.setHeadSize (headSize);
+}
+
+void MultichannelConvolution::setMaxFftSize (int size)
+{
+    maxFftSize = size;
+
+    for (auto& g : groups)
+        g->engine.setMaxFftSize (maxFftSize);
+}
+
+void MultichannelConvolution::setSegmentBlocks (int blocks)
+{
+    segmentBlocks = blocks;
+
+    for (auto& g : groups)
+        g->engine.setSegmentBlocks (segmentBlocks);
+}
+
+void MultichannelConvolution::setLoadBalancing (bool shouldBalance)
+{
+    loadBalancing = shouldBalance;
+
+    for (auto& g : groups)
+        g->engine.setLoadBalancing (loadBalancing);
+}
+
+void MultichannelConvolution::setFftBackends (std::vector<Convolution::FftBackend*> preferred)
+{
+    fftBackends = std::move (preferred);
+
+    for (auto& g : groups)
+        g->engine.setFftBackends (fftBackends);
+}
+
+void MultichannelConvolution::setReblocking (Convolution::Reblocking newMode, int quantumSamples)
+{
+    reblocking = newMode;
+    reblockQuantum = quantumSamples;
+
+    for (auto& g : groups)
+        g->engine.setReblocking (reblocking, reblockQuantum);
+}
+
+void MultichannelConvolution::prepare (int numChannels, int maxBlockSize)
+{
+    Expects (0 < numChannels && numChannels <= maxChannels);
+    Expects (0 < maxBlockSize);
+
+    preparedNumChannels = numChannels;
+    preparedMaxBlockSize = maxBlockSize;
+    rebuild();
+}
+
+void MultichannelConvolution::setMemoryLocking (bool shouldLock)
+{
+    shouldLockMemory = shouldLock;
+
+    for (auto& g : groups)
+        g->engine.setMemoryLocking (shouldLock);
+}
+
+MemoryLockReport MultichannelConvolution::getMemoryLockReport() const
+{
+    MemoryLockReport total;
+    total.lockLimit = getMemoryLockLimit();
+
+    for (auto& g : groups)
+    {
+        const MemoryLockReport& r = g->engine.getMemoryLockReport();
+        total.bytesTouched += r.bytesTouched;
+        total.bytesLocked  += r.bytesLocked;
+        total.lockFailed   |= r.lockFailed;
+    }
+    return total;
+}
+
+int MultichannelConvolution::getLatencySamples() const noexcept
+{
+    const int reblockLatency = reblocking == Convolution::Reblocking::fixedLatency ? reblockQuantum : 0;
+
+    if (! isConvertingRate())
+        return reblockLatency;
+
+    const double seconds = down->getLatencySeconds() + up->getLatencySeconds() + reblockLatency / getEngineRate();
+    return wetLead + static_cast<int> (std::lround (seconds * sampleRate));
+}
+
+void MultichannelConvolution::process (ado::Buffer& block)
+{
+    process (block.getWriteArray(), block.getNumChannels(), block.getNumSamples());
+}
+
+void MultichannelConvolution::process (float** block, int blockNumChannels, int blockNumSamples)
+{
+    process (block, blockNumChannels, blockNumSamples, {1.0f, 0.0f}, {1.0f, 0.0f});
+}
+
+void MultichannelConvolution::process (float** block, int blockNumChannels, int blockNumSamples,
+                                       Convolution::MixGains from, Convolution::MixGains to)
+{
+    if (blockNumChannels != preparedNumChannels)    // unprepared, allocates here (as WDL would)
+        prepare (blockNumChannels, std::max (blockNumSamples, preparedMaxBlockSize));
+
+    if (isConvertingRate())
+    {
+        Expects (from.dry == 0.0f && to.dry == 0.0f);
+        processAtInternalRate (block, blockNumChannels, blockNumSamples, from.wet, to.wet);
+        return;
+    }
+
+    current.block = block;
+    current.wide = nullptr;
+    current.numSamples = blockNumSamples;
+    current.mixing = ! (from.wet == 1.0f && from.dry == 0.0f && to.wet == 1.0f && to.dry == 0.0f);
+    current.from = from;
+    current.to = to;
+
+    processGroups();
+}
+
+void MultichannelConvolution::process (double** block, int blockNumChannels, int blockNumSamples,
+                                       Convolution::MixGains from, Convolution::MixGains to)
+{
+    Expects (getLatencySamples() == 0 || (from.dry == 0.0f && to.dry == 0.0f));
+
+    if (blockNumChannels != preparedNumChannels)    // unprepared, allocates here (as WDL would)
+        prepare (blockNumChannels, std::max (blockNumSamples, preparedMaxBlockSize));
+
+    auto gainsAt = [&] (int pos) -> Convolution::MixGains   // ramp position at a chunk boundary
+    {
+        const float t = static_cast<float> (pos) / static_cast<float> (blockNumSamples);
+        return {from.wet + (to.wet - from.wet) * t, from.dry + (to.dry - from.dry) * t};
+    };
+
+    double* chunk[maxChannels];
+    float** wet = narrowed.getWriteArray();
+
+    for (int start = 0; start < blockNumSamples; )  // blocks past prepare()'s size in chunks
+    {
+        const int numSamples = std::min (blockNumSamples - start, narrowed.getNumSamples());
+        for (int chan = 0; chan < blockNumChannels; ++chan)
+            chunk[chan] = block[chan] + start;
+
+        if (isConvertingRate())                     // all wet, so converted whole & widened
+        {
+            for (int chan = 0; chan < blockNumChannels; ++chan)
+                vectorConvert (chunk[chan], wet[chan], numSamples);
+
+            processAtInternalRate (wet, blockNumChannels, numSamples,
+                                   gainsAt (start).wet, gainsAt (start + numSamples).wet);
+
+            for (int chan = 0; chan < blockNumChannels; ++chan)
+                vectorMixRamped (chunk[chan], 0.0f, 0.0f, wet[chan], 1.0f, 1.0f, chunk[chan], numSamples);
+
+            start += numSamples;
+            continue;
+        }
+
+        current.block = narrowed.getWriteArray();   // each group converts, convolves all wet
+        current.wide = chunk;                       // & mixes its own channels, while they're
+        current.numSamples = numSamples;            // in its worker's cache
+        current.mixing = false;
+        current.from = gainsAt (start);
+        current.to = gainsAt (start + numSamples);
+
+        processGroups();
+
+        start += numSamples;
+    }
+    current.wide = nullptr;
+}
+
+int MultichannelConvolution::getNumWorkers() const noexcept
+{
+    return numWorkers;
+}
+
+int MultichannelConvolution::defaultNumWorkers()
+{
+    return std::max (0, juce::SystemStats::getNumCpus() - 1);
+}
+
+//==============================================================================
+//private:
+
+void MultichannelConvolution::rebuild()
+{
+    groups.clear();
+
+    const ado::Buffer& ir = *irCurrent;
+    const int numChannels = preparedNumChannels;
+    const int irChannels  = ir.getNumChannels();
+
+    narrowed.clearAndResize (numChannels, preparedMaxBlockSize);
+
+    int engineMaxBlockSize = preparedMaxBlockSize;
+    if (isConvertingRate())
+    {
+        engineMaxBlockSize = down->getMaxOutputSamples (preparedMaxBlockSize);
+        down->prepare (numChannels, preparedMaxBlockSize);
+        up->prepare (numChannels, engineMaxBlockSize);
+        lowRate.clearAndResize (numChannels, engineMaxBlockSize);
+
+            // up's output count wobbles by a sample or so a block about the
+            // host's, so a few samples' lead (as latency) keeps it ahead
+        const int ratio = static_cast<int> (std::ceil (sampleRate / internalRate));
+        wetLead = 2 * ratio + 2;
+        wetQueue.clearAndResize (numChannels, 2 * wetLead + up->getMaxOutputSamples (engineMaxBlockSize));
+        wetQueued = wetLead;                    // of zeros
+    }
+    else
+    {
+        lowRate.clearAndResize (1, 1);
+        wetQueue.clearAndResize (1, 1);
+        wetQueued = wetLead = 0;
+    }
+
+    auto addGroup = [&] (std::vector<int> channels, std::vector<int> irChannelsToUse)
+    {
+        ado::Buffer groupIr {static_cast<int> (irChannelsToUse.size()), ir.getNumSamples(), ir.getSampleRate()};
+        for (size_t c = 0; c < irChannelsToUse.size(); ++c)
+            vectorCopy (ir.getReadArray()[irChannelsToUse[c]],
+                        groupIr.getWriteArray()[c],
+                        ir.getNumSamples());
+
+        groups.emplace_back (new Group {std::move (groupIr), std::move (channels)});
+    };
+
+    if (numChannels <= 2)                       // as ado::Convolution, topologies & all
+    {
+        std::vector<int> irChans;
+        for (int k = 0; k < std::min (irChannels, WDL_CONVO_MAX_IMPULSE_NCH); ++k)
+            irChans.push_back (k);
+
+        addGroup (numChannels == 1 ? std::vector<int> {0} : std::vector<int> {0, 1}, irChans);
+    }
+    else if (irChannels >= numChannels)         // own impulse channel each, in pairs
+    {
+        for (int c = 0; c < numChannels; c += 2)
+        {
+            std::vector<int> chans {c};
+            if (c + 1 < numChannels)
+                chans.push_back (c + 1);
+
+            addGroup (chans, chans);
+        }
+    }
+    else                                        // impulse reused, share its spectra
+    {
+        for (int k = 0; k < irChannels; ++k)
+        {
+            std::vector<int> chans;
+            for (int c = k; c < numChannels; c += irChannels)
+            {
+                chans.push_back (c);
+                if (static_cast<int> (chans.size()) == WDL_CONVO_MAX_PROC_NCH)
+                {
+                    addGroup (chans, {k});
+                    chans.clear();
+                }
+            }
+            if (! chans.empty())
+                addGroup (chans, {k});
+        }
+    }
+
+    for (auto& g : groups)
+    {
+        Convolution& engine = g->engine;
+        engine.setMemoryLocking (shouldLockMemory);
+        engine.setHeadSize (headSize);
+        engine.setMaxFftSize (maxFftSize);
+        engine.setSegmentBlocks (segmentBlocks);
+        engine.setLoadBalancing (loadBalancing);
+        engine.setFftBackends (fftBackends);
+        engine.setReblocking (reblocking, reblockQuantum);
+        engine.resampleIrOnRateChange (getEngineRate());
+        if (numChannels <= 2)
+            engine.setTopology (topology);
+        engine.prepare (static_cast<int> (g->channels.size()), engineMaxBlockSize);
+    }
+
+    numWorkers = std::min (maxWorkers, getNumEngines() - 1);
+    if (numWorkers > 0 && pool == nullptr)      // kept from then on, threads & slot
+    {
+        pool = WorkerPool::getShared();
+        poolSlot = pool->acquireSlot (*this);
+        if (poolSlot < 0)                       // every slot taken: this thread's alone
+            pool.reset();
+    }
+    numWorkers = pool != nullptr ? pool->reserveThreads (numWorkers) : 0;
+}
+
+void MultichannelConvolution::processGroups()
+{
+    const int numGroups = getNumEngines();
+
+    if (numWorkers > 0 && numGroups > 1)
+        pool->run (poolSlot, numGroups, numWorkers);
+    else
+        for (int i = 0; i < numGroups; ++i)
+            processGroup (i);
+}
+
+void MultichannelConvolution::processAtInternalRate (float** block, int blockNumChannels, int blockNumSamples,
+                                                     float wetFrom, float wetTo)
+{
+    float** low = lowRate.getWriteArray();
+    float** queue = wetQueue.getWriteArray();
+    const float* in[maxChannels];
+    float* out[maxChannels];
+
+    for (int start = 0; start < blockNumSamples; )  // blocks past prepare()'s size in chunks
+    {
+        const int numSamples = std::min (blockNumSamples - start, preparedMaxBlockSize);
+        for (int chan = 0; chan < blockNumChannels; ++chan)
+        {
+            in[chan] = block[chan] + start;
+            out[chan] = queue[chan] + wetQueued;
+        }
+
+        const int numLow = down->process (in, numSamples, low);
+        if (numLow > 0)
+        {
+            current.block = low;
+            current.wide = nullptr;
+            current.numSamples = numLow;
+            current.mixing = false;
+            processGroups();
+        }
+
+        wetQueued += up->process (low, numLow, out);
+        assert (wetQueued >= numSamples);      // wetLead too small
+
+        const float rampFrom = wetFrom + (wetTo - wetFrom) * start / blockNumSamples;
+        const float rampTo = wetFrom + (wetTo - wetFrom) * (start + numSamples) / blockNumSamples;
+        for (int chan = 0; chan < blockNumChannels; ++chan)
+        {
+            vectorScaleRamped (queue[chan], block[chan] + start, rampFrom, rampTo, numSamples);
+            std::memmove (queue[chan], queue[chan] + numSamples,
+                          sizeof (float) * static_cast<size_t> (wetQueued - numSamples));
+        }
+
+        wetQueued -= numSamples;
+        start += numSamples;
+    }
+}
+
+void MultichannelConvolution::updateRateConversion()
+{
+    const bool shouldConvert = internalRate > 0 && sampleRate > internalRate
+                                && sampleRate == std::floor (sampleRate);
+    const int hostRate = static_cast<int> (sampleRate);
+
+    if (! shouldConvert)
+    {
+        down.reset();
+        up.reset();
+    }
+    else if (down == nullptr || down->getFromRate() != hostRate || down->getToRate() != internalRate)
+    {
+        down.reset (new PolyphaseResampler {hostRate, internalRate});
+        up.reset (new PolyphaseResampler {internalRate, hostRate});
+    }
+}
+
+double MultichannelConvolution::getEngineRate() const noexcept
+{
+    return isConvertingRate() ? static_cast<double> (internalRate) : sampleRate;
+}
+
+void MultichannelConvolution::processGroup (int index)
+{
+    Group& g = *groups[static_cast<size_t> (index)];
+
+    for (size_t c = 0; c < g.channels.size(); ++c)
+        g.pointers[c] = current.block[g.channels[c]];
+
+    const int numChannels = static_cast<int> (g.channels.size());
+
+    if (current.wide != nullptr)
+        for (int chan : g.channels)
+            vectorConvert (current.wide[chan], current.block[chan], current.numSamples);
+
+    if (current.mixing)
+        g.engine.process (g.pointers.data(), numChannels, current.numSamples, current.from, current.to);
+    else
+        g.engine.process (g.pointers.data(), numChannels, current.numSamples);
+
+    if (current.wide != nullptr)                // channel 0 last, with monoInput every channel's dry
+    {
+        const bool monoDry = g.engine.getTopology() == Convolution::Topology::monoInput;
+        for (auto chan = g.channels.rbegin(); chan != g.channels.rend(); ++chan)
+            vectorMixRamped (current.wide[monoDry ? g.channels.front() : *chan], current.from.dry, current.to.dry,
+                             current.block[*chan], current.from.wet, current.to.wet,
+                             current.wide[*chan], current.numSamples);
+    }
+}
+
+} // namespace
@@ -0,0 +1,320 @@
+//==============================================================================
+/*
+    The MIT License (MIT)
+
+    Copyright (c) 2016 John Flynn
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to
+    deal in the Software without restriction, including without limitation the
+    rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+    sell copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+    IN THE SOFTWARE.
+*/
+//==============================================================================
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <mutex>
+#include <utility>
+#include "../Dependencies/gsl.h"
+#include "../PartitionTuner.h"
+#include "../Kernels.h"
+#include "../Utility.h"
+
+namespace ado
+{
+
+namespace
+{
+
+bool matches (const juce::XmlElement& entry, const PartitionTuner::Problem& problem)
+{
+    return entry.getIntAttribute ("blockSize") == problem.blockSize
+        && std::abs (entry.getDoubleAttribute ("sampleRate") - problem.sampleRate) < 0.5
+        && entry.getIntAttribute ("impulseLength") == problem.impulseLength
+        && entry.getIntAttribute ("numChannels") == problem.numChannels
+        && entry.getIntAttribute ("reblocking") == static_cast<int> (problem.reblocking)      // older wisdom:
+        && entry.getIntAttribute ("reblockQuantum", 512) == problem.reblockQuantum;          // off, timed so
+}
+
+bool isValid (const PartitionTuner::Plan& plan)     // wisdom is a file anyone can edit
+{
+    return WDL_CONVO_MIN_BRUTE_SIZE <= plan.headSize && plan.headSize <= WDL_CONVO_MAX_BRUTE_SIZE
+        && 1 <= plan.segmentBlocks && plan.segmentBlocks <= WDL_CONVO_MAX_SEGMENT_BLOCKS
+        && Convolution::defaultMaxFftSize <= plan.maxFftSize && plan.maxFftSize <= WDL_FFT_MAX_SIZE
+        && isPowerOf2 (plan.maxFftSize);
+}
+
+} // namespace
+
+//==============================================================================
+PartitionTuner::PartitionTuner (const juce::File& wisdomFile)
+    : file {wisdomFile}
+{
+    loadWisdom();
+}
+
+void PartitionTuner::setFftBackends (std::vector<Convolution::FftBackend*> candidates)
+{
+    backends = std::move (candidates);
+}
+
+void PartitionTuner::setWorstBlockLimit (double fractionOfBlock)
+{
+    Expects (0.0 < fractionOfBlock);
+
+    worstBlockLimit = fractionOfBlock;
+}
+
+PartitionTuner::Plan PartitionTuner::getPlan (const Problem& problem)
+{
+    static std::mutex lock;                         // one tune at a time, they'd skew each other's timing
+
+    std::lock_guard<std::mutex> guard {lock};
+
+    loadWisdom();                                   // another instance may have tuned it meanwhile
+
+    Plan plan;
+    if (findPlan (problem, plan))
+        return plan;
+
+    plan = tune (problem);
+    saveWisdom (problem, plan);
+    return plan;
+}
+
+bool PartitionTuner::findPlan (const Problem& problem, Plan& plan) const
+{
+    forEachXmlChildElementWithTagName (wisdom, entry, "PLAN")
+    {
+        if (! matches (*entry, problem))
+            continue;
+
+        Plan found;
+        found.headSize          = entry->getIntAttribute ("headSize");
+        found.segmentBlocks     = entry->getIntAttribute ("segmentBlocks");
+        found.maxFftSize        = entry->getIntAttribute ("maxFftSize");
+        found.fftBackend        = entry->getStringAttribute ("fftBackend");
+        found.loadBalance       = entry->getBoolAttribute ("loadBalance");
+        found.meanBlockSeconds  = entry->getDoubleAttribute ("meanBlockSeconds");
+        found.worstBlockSeconds = entry->getDoubleAttribute ("worstBlockSeconds");
+
+        if (! isValid (found))
+            return false;
+        if (found.fftBackend.isNotEmpty() && getBackends (found).empty())
+            return false;                           // tuned with a backend we haven't got
+
+        plan = found;
+        return true;
+    }
+    return false;
+}
+
+PartitionTuner::Plan PartitionTuner::measure (const Problem& problem, Plan plan) const
+{
+    Expects (0 < problem.blockSize && 0.0 < problem.sampleRate && 0 < problem.impulseLength);
+    Expects (0 < problem.numChannels && problem.numChannels <= WDL_CONVO_MAX_PROC_NCH);
+    Expects (isValid (plan));
+
+    const int numChannels = problem.numChannels;
+    const int blockSize = problem.blockSize;
+    const int numPasses {2};                        // best of, to dodge interruptions
+    const int numBlocks = (std::max (problem.impulseLength, plan.maxFftSize) + 8 * blockSize) / blockSize;
+
+    ado::Buffer noise {numChannels, problem.impulseLength, static_cast<int> (problem.sampleRate)};
+    unsigned int seed {12345u};                     // any non-silent impulse will do
+    for (int c = 0; c < numChannels; ++c)
+        for (auto& sample : noise.channel (c))
+        {
+            seed = seed * 1664525u + 1013904223u;
+            sample = static_cast<float> (seed >> 8) / (1 << 24) - 0.5f;
+        }
+
+    Convolution engine {noise};
+    apply (plan, engine);
+    engine.setReblocking (problem.reblocking, problem.reblockQuantum);
+    engine.prepare (numChannels, blockSize);
+
+    ado::Buffer block {numChannels, blockSize};
+
+    for (int pass = 0; pass < numPasses; ++pass)
+    {
+        double total {0.0};
+        double worst {0.0};
+
+        for (int i = 0; i < numBlocks; ++i)
+        {
+            block.fillAllOnes();
+
+            const auto start = std::chrono::steady_clock::now();
+            engine.process (block.getWriteArray(), numChannels, blockSize);
+            const double time = std::chrono::duration<double> (std::chrono::steady_clock::now() - start).count();
+
+            total += time;
+            worst = std::max (worst, time);
+        }
+
+        const double mean = total / numBlocks;
+        if (pass == 0 || mean < plan.meanBlockSeconds)
+            plan.meanBlockSeconds = mean;
+        if (pass == 0 || worst < plan.worstBlockSeconds)
+            plan.worstBlockSeconds = worst;
+    }
+    return plan;
+}
+
+void PartitionTuner::apply (const Plan& plan, Convolution& engine) const
+{
+    engine.setHeadSize (plan.headSize);
+    engine.setSegmentBlocks (plan.segmentBlocks);
+    engine.setMaxFftSize (plan.maxFftSize);
+    engine.setLoadBalancing (plan.loadBalance);
+    engine.setFftBackends (getBackends (plan));
+}
+
+void PartitionTuner::apply (const Plan& plan, MultichannelConvolution& engine) const
+{
+    engine.setHeadSize (plan.headSize);
+    engine.setSegmentBlocks (plan.segmentBlocks);
+    engine.setMaxFftSize (plan.maxFftSize);
+    engine.setLoadBalancing (plan.loadBalance);
+    engine.setFftBackends (getBackends (plan));
+}
+
+juce::String PartitionTuner::getMachineSignature()
+{
+    return juce::SystemStats::getCpuVendor()
+        + " " + juce::String (juce::SystemStats::getNumCpus()) + " cpus"
+        + " simd " + juce::String (static_cast<int> (getSimdLevel()));
+}
+
+//==============================================================================
+PartitionTuner::Plan PartitionTuner::tune (const Problem& problem) const
+{
+    Plan best = measure (problem, Plan {});         // WDL's defaults
+
+    const auto tryPlan = [&] (const Plan& candidate)
+    {
+        const Plan measured = measure (problem, candidate);
+        if (isBetter (measured, best, problem))
+            best = measured;
+    };
+
+    for (int size = 32; size <= 512; size *= 2)     // one parameter at a time, from the best so far
+        if (size != best.headSize)
+        {
+            Plan candidate = best;
+            candidate.headSize = size;
+            tryPlan (candidate);
+        }
+
+    for (int blocks : {1, 2, 3, 4, 6, 8})
+        if (blocks != best.segmentBlocks)
+        {
+            Plan candidate = best;
+            candidate.segmentBlocks = blocks;
+            tryPlan (candidate);
+        }
+
+    for (int size = 2 * Convolution::defaultMaxFftSize; size <= WDL_FFT_MAX_SIZE && size <= problem.impulseLength; size *= 2)
+    {
+        Plan candidate = best;                      // only once the tail is a partition that size
+        candidate.maxFftSize = size;
+        tryPlan (candidate);
+    }
+
+    for (auto* backend : backends)
+    {
+        Plan candidate = best;
+        candidate.fftBackend = backend->GetName();
+        tryPlan (candidate);
+    }
+
+    {
+        Plan candidate = best;                      // wins when only it keeps the worst block in the limit
+        candidate.loadBalance = true;
+        tryPlan (candidate);
+    }
+
+    return best;
+}
+
+bool PartitionTuner::isBetter (const Plan& a, const Plan& b, const Problem& problem) const
+{
+    const double limit = worstBlockLimit * problem.blockSize / problem.sampleRate;
+    const bool aFits = a.worstBlockSeconds <= limit;
+    const bool bFits = b.worstBlockSeconds <= limit;
+
+    if (aFits != bFits)
+        return aFits;
+    if (aFits)
+        return a.meanBlockSeconds < b.meanBlockSeconds * 0.98;     // a clear win, not timing noise
+    return a.worstBlockSeconds < b.worstBlockSeconds;
+}
+
+std::vector<Convolution::FftBackend*> PartitionTuner::getBackends (const Plan& plan) const
+{
+    for (auto* backend : backends)
+        if (plan.fftBackend == backend->GetName())
+            return {backend};
+    return {};
+}
+
+void PartitionTuner::loadWisdom()
+{
+    const juce::String machine = getMachineSignature();
+
+    juce::ScopedPointer<juce::XmlElement> parsed {juce::XmlDocument::parse (file)};
+    if (parsed != nullptr && parsed->hasTagName ("CONVOLUTIONWISDOM")
+        && parsed->getStringAttribute ("machine") == machine)
+    {
+        wisdom = *parsed;
+        return;
+    }
+
+    wisdom = juce::XmlElement {"CONVOLUTIONWISDOM"};   // none yet, or another machine's
+    wisdom.setAttribute ("machine", machine);
+}
+
+void PartitionTuner::saveWisdom (const Problem& problem, const Plan& plan)
+{
+    forEachXmlChildElementWithTagName (wisdom, entry, "PLAN")
+        if (matches (*entry, problem))
+        {
+            wisdom.removeChildElement (entry, true);
+            break;
+        }
+
+    juce::XmlElement* entry = wisdom.createNewChildElement ("PLAN");
+    entry->setAttribute ("blockSize", problem.blockSize);
+    entry->setAttribute ("sampleRate", problem.sampleRate);
+    entry->setAttribute ("impulseLength", problem.impulseLength);
+    entry->setAttribute ("numChannels", problem.numChannels);
+    entry->setAttribute ("reblocking", static_cast<int> (problem.reblocking));
+    entry->setAttribute ("reblockQuantum", problem.reblockQuantum);
+    entry->setAttribute ("headSize", plan.headSize);
+    entry->setAttribute ("segmentBlocks", plan.segmentBlocks);
+    entry->setAttribute ("maxFftSize", plan.maxFftSize);
+    entry->setAttribute ("fftBackend", plan.fftBackend);
+    entry->setAttribute ("loadBalance", plan.loadBalance);
+    entry->setAttribute ("meanBlockSeconds", plan.meanBlockSeconds);
+    entry->setAttribute ("worstBlockSeconds", plan.worstBlockSeconds);
+
+    file.getParentDirectory().createDirectory();
+    wisdom.writeToFile (file, "");                  // "" is DTD (unused)
+}
+
+} // namespace ado
@@ -24,7 +24,13 @@
 */
 //==============================================================================
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include "../Dependencies/gsl.h"
 #include "../Dependencies/WDL/resample.h"
+#include "../Kernels.h"
 #include "../Resampling.h"
 
 namespace ado
@@ -37,24 +43,22 @@ ado::Buffer resampleBuffer (const ado::Buffer& buffer, int destRate)
     const double factor = static_cast<double> (destRate) / sourceRate; // divide in double
     int destLength = static_cast<int> (sourceLength * factor);         // then round down
 
+    if (destLength == sourceLength)             // copy and exit
+        return buffer;
+
     ado::Buffer destBuff {buffer.getNumChannels(), destLength, destRate};
 
-    if (destLength == sourceLength)             // copy and exit
-    {
-        destBuff = buffer;
-        return destBuff;
-    }
-    
     WDL_Resampler engine;                       // else resample...
     engine.SetMode (false, 0, true); // sinc, default size (interp, filtercnt, sinc)
     engine.SetRates (sourceRate, destRate);
 
     for (int chan = 0; chan < buffer.getNumChannels(); ++chan)
     {
-        ado::Buffer p {1, sourceLength};                    // needs to work this way
-        engine.ResamplePrepare (destLength, 1, p.getWriteArray());
-        for (int samp = 0; samp < sourceLength; ++samp)
-            p.getWriteArray()[0][samp] = buffer.getReadArray()[chan][samp];
+        WDL_ResampleSample* in {nullptr};                   // WDL owns the input buffer
+        const int inNeeded = engine.ResamplePrepare (destLength, 1, &in);
+        jassert (inNeeded >= sourceLength);
+        ignoreUnused (inNeeded);
+        std::copy (buffer.getReadArray()[chan], buffer.getReadArray()[chan] + sourceLength, in);
 
         float* dest = destBuff.getWriteArray()[chan];
 
@@ -66,4 +70,435 @@ ado::Buffer resampleBuffer (const ado::Buffer& buffer, int destRate)
     return destBuff;
 }
 
+//==============================================================================
+
+namespace
+{
+
+constexpr double passbandEdge {0.907};          // of the lower rate's Nyquist
+constexpr double stopbandDecibels {100.0};
+constexpr double pi {3.14159265358979323846};
+
+int greatestCommonDivisor (int a, int b)
+{
+    while (b != 0)
+    {
+        const int r = a % b;
+        a = b;
+        b = r;
+    }
+    return a;
+}
+
+double besselI0 (double x)                      // for the Kaiser window
+{
+    double sum {1.0};
+    double term {1.0};
+    for (int k = 1; k < 50 && term > 1.0e-12 * sum; ++k)
+    {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+/** Kaiser's estimate of the length for stopbandDecibels over a transition
+    of this many cycles per sample.
+*/
+int kaiserLength (double transition)
+{
+    return static_cast<int> (std::ceil ((stopbandDecibels - 7.95) / (2.285 * 2.0 * pi * transition))) + 1;
+}
+
+/** Kaiser windowed sinc, unnormalised, cutoff in cycles per sample. */
+std::vector<double> kaiserSinc (int length, double cutoff)
+{
+    const double beta = 0.1102 * (stopbandDecibels - 8.7);
+    const double centre = (length - 1) / 2.0;
+    std::vector<double> h (static_cast<size_t> (length));
+
+    for (int n = 0; n < length; ++n)
+    {
+        const double x = n - centre;
+        const double sinc = x == 0.0 ? 1.0 : std::sin (2.0 * pi * cutoff * x) / (2.0 * pi * cutoff * x);
+        const double r = x / centre;
+        h[static_cast<size_t> (n)] = sinc * besselI0 (beta * std::sqrt (std::max (0.0, 1.0 - r * r)));
+    }
+    return h;
+}
+
+} // namespace
+
+//==============================================================================
+class PolyphaseResampler::Stage
+{
+public:
+    virtual ~Stage() {}
+
+    virtual void prepare (int numChannels, int maxInputSamples) = 0;
+    virtual void reset() = 0;
+    virtual int getMaxOutputSamples (int numInputSamples) const noexcept = 0;
+    virtual int process (const float* const* input, int numInputSamples, float* const* output) = 0;
+    virtual double getLatencySeconds() const noexcept = 0;
+};
+
+//==============================================================================
+/** 2:1 down or up between highRate and half it. The filter is 4K + 3 long
+    with its cutoff at a quarter of highRate, so the taps an even distance
+    from the centre are 0 and the centre is a half: per low rate sample it's
+    a 2K + 2 tap FIR over every other sample and one scaled copy.
+*/
+class PolyphaseResampler::HalfBand : public PolyphaseResampler::Stage
+{
+public:
+    HalfBand (int rate, double passbandHz, bool isDown)
+        : highRate {rate},
+          down {isDown}
+    {
+            // aliases & images of the passband fold about a quarter of highRate,
+            // so the stopband starts as far above it as the passband ends below
+        const double transition = (highRate / 2.0 - 2.0 * passbandHz) / highRate;
+        halfLength = kaiserLength (transition) / 4;                         // 4K + 3 at least that
+        const int length = 4 * halfLength + 3;
+
+        const std::vector<double> h = kaiserSinc (length, 0.25);
+        const int numTaps = 2 * halfLength + 2;
+        double total {0.0};
+        for (int i = 0; i < numTaps; ++i)
+            total += h[static_cast<size_t> (2 * i)];
+
+            // the odd distances from the centre, summing to a half (the centre's
+            // the other), doubled going up for the zeros stuffed between inputs;
+            // symmetric, so already back to front for vectorFir()
+        const double gain = down ? 0.5 : 1.0;
+        taps.resize (static_cast<size_t> (numTaps));
+        for (int i = 0; i < numTaps; ++i)
+            taps[static_cast<size_t> (i)] = static_cast<float> (h[static_cast<size_t> (2 * i)] * gain / total);
+    }
+
+    void prepare (int numChannels, int maxInputSamples) override
+    {
+        const int numPast = static_cast<int> (taps.size()) - 1;
+
+        if (down)
+        {
+            const int maxPairs = (maxInputSamples + 1) / 2;
+            scratch.clearAndResize (numChannels, maxInputSamples + 1);
+            history.clearAndResize (numChannels, numPast + maxPairs);
+            evens.clearAndResize (numChannels, halfLength + maxPairs);
+        }
+        else
+        {
+            scratch.clearAndResize (1, maxInputSamples);
+            history.clearAndResize (numChannels, numPast + maxInputSamples);
+        }
+        reset();
+    }
+
+    void reset() override
+    {
+        scratch.clear();
+        history.clear();
+        evens.clear();
+        pending = false;
+    }
+
+    int getMaxOutputSamples (int numInputSamples) const noexcept override
+    {
+        return down ? (numInputSamples + 1) / 2 : 2 * numInputSamples;
+    }
+
+    int process (const float* const* input, int numInputSamples, float* const* output) override
+    {
+        return down ? processDown (input, numInputSamples, output)
+                    : processUp (input, numInputSamples, output);
+    }
+
+    double getLatencySeconds() const noexcept override
+    {
+            // down: an output on each pair's first input; up: the centre tap
+            // lands on the odd outputs, half a low rate sample later
+        return (down ? 2 * halfLength : 2 * halfLength + 1) / static_cast<double> (highRate);
+    }
+
+private:
+        // y[m] = sum of taps[i] * x[2m + 1 - 2i] + x[2m - 2K] / 2, over the odd
+        // & even inputs split apart. An odd sample left over waits for the next block.
+    int processDown (const float* const* input, int numInputSamples, float* const* output)
+    {
+        const int numTaps = static_cast<int> (taps.size());
+        const int numPast = numTaps - 1;
+        const int numStaged = numInputSamples + (pending ? 1 : 0);
+        const int numPairs = numStaged / 2;
+
+        for (int chan = 0; chan < history.getNumChannels(); ++chan)
+        {
+            float* staged = scratch.getWriteArray()[chan];     // [0] the one left over, if pending
+            float* odd = history.getWriteArray()[chan];
+            float* even = evens.getWriteArray()[chan];
+
+            vectorCopy (input[chan], staged + (pending ? 1 : 0), numInputSamples);
+            for (int m = 0; m < numPairs; ++m)
+            {
+                even[halfLength + m] = staged[2 * m];
+                odd[numPast + m] = staged[2 * m + 1];
+            }
+
+            vectorFir (taps.data(), numTaps, odd, output[chan], numPairs, false);
+            vectorAddScaled (even, output[chan], 0.5f, numPairs);
+
+            std::memmove (odd, odd + numPairs, sizeof (float) * static_cast<size_t> (numPast));
+            std::memmove (even, even + numPairs, sizeof (float) * static_cast<size_t> (halfLength));
+            if (numStaged % 2 != 0)
+                staged[0] = staged[numStaged - 1];
+        }
+
+        pending = numStaged % 2 != 0;
+        return numPairs;
+    }
+
+        // z[2m] = sum of taps[i] * x[m - i], z[2m + 1] = x[m - K]
+    int processUp (const float* const* input, int numInputSamples, float* const* output)
+    {
+        const int numTaps = static_cast<int> (taps.size());
+        const int numPast = numTaps - 1;
+        float* filtered = scratch.getWriteArray()[0];
+
+        for (int chan = 0; chan < history.getNumChannels(); ++chan)
+        {
+            float* x = history.getWriteArray()[chan];
+            const float* delayed = x + numPast - halfLength;
+            float* z = output[chan];
+
+            vectorCopy (input[chan], x + numPast, numInputSamples);
+            vectorFir (taps.data(), numTaps, x, filtered, numInputSamples, false);
+            for (int m = 0; m < numInputSamples; ++m)
+            {
+                z[2 * m] = filtered[m];
+                z[2 * m + 1] = delayed[m];
+            }
+
+            std::memmove (x, x + numInputSamples, sizeof (float) * static_cast<size_t> (numPast));
+        }
+
+        return 2 * numInputSamples;
+    }
+
+    const int highRate;
+    const bool down;
+    int halfLength;                             // K
+    std::vector<float> taps;                    // the 2K + 2 at odd distances from the centre
+
+    ado::Buffer history {1, 1};                 // 2K + 1 past inputs then the block's: the odd ones going down
+    ado::Buffer evens {1, 1};                   // down: K past even inputs then the block's
+    ado::Buffer scratch {1, 1};                 // down: the block's inputs; up: the even outputs
+    bool pending {false};                       // down: an odd input's waiting in scratch
+};
+
+//==============================================================================
+/** The ratio left after the halvings, up / down, through a polyphase windowed
+    sinc at the rate between the two, fromRate * up.
+*/
+class PolyphaseResampler::Rational : public PolyphaseResampler::Stage
+{
+public:
+    Rational (int sourceRate, int destRate, double passbandHz)
+        : fromRate {sourceRate}
+    {
+        const int divisor = greatestCommonDivisor (sourceRate, destRate);
+        up = destRate / divisor;
+        down = sourceRate / divisor;
+
+            // the stopband starts where aliases & images of the passband would land
+        const double filterRate = static_cast<double> (fromRate) * up;
+        const double stopbandHz = std::min (sourceRate, destRate) - passbandHz;
+        const double cutoff = (passbandHz + stopbandHz) / 2.0 / filterRate;    // cycles per sample
+        const double transition = (stopbandHz - passbandHz) / filterRate;
+
+        tapsPerPhase = (kaiserLength (transition) + up - 1) / up;
+        const int length = tapsPerPhase * up;
+        const std::vector<double> h = kaiserSinc (length, cutoff);
+
+        double total {0.0};
+        for (const double tap : h)
+            total += tap;
+
+            // Unity gain at DC through every phase's share (each input is up taps apart),
+            // back to front by phase for vectorDots()
+        taps.resize (static_cast<size_t> (length));
+        for (int p = 0; p < up; ++p)
+            for (int k = 0; k < tapsPerPhase; ++k)
+                taps[static_cast<size_t> (p * tapsPerPhase + k)]
+                    = static_cast<float> (h[static_cast<size_t> (p + (tapsPerPhase - 1 - k) * up)] * up / total);
+    }
+
+    void prepare (int numChannels, int maxInputSamples) override
+    {
+        maxInput = maxInputSamples;
+        history.clearAndResize (numChannels, tapsPerPhase - 1 + maxInput);
+        phaseOffsets.resize (static_cast<size_t> (getMaxOutputSamples (maxInput)));
+        inputOffsets.resize (phaseOffsets.size());
+        reset();
+    }
+
+    void reset() override
+    {
+        history.clear();
+        time = static_cast<std::int64_t> (tapsPerPhase - 1) * up;  // the first output on the first input
+    }
+
+    int getMaxOutputSamples (int numInputSamples) const noexcept override
+    {
+        return static_cast<int> ((static_cast<std::int64_t> (numInputSamples) * up + down - 1) / down);
+    }
+
+    int process (const float* const* input, int numInputSamples, float* const* output) override
+    {
+        Expects (numInputSamples <= maxInput);
+
+        const int numPast = tapsPerPhase - 1;
+        const std::int64_t end {static_cast<std::int64_t> (numPast + numInputSamples) * up};
+        int numOutput {0};
+
+            // y(t) = sum of x[j] h[t - j * up], t stepping by down: its newest input
+            // & phase kept as a quotient & remainder, no division per output
+        const int stepInputs = down / up;
+        const int stepPhase = down % up;
+        int newest = static_cast<int> (time / up);
+        int phase = static_cast<int> (time % up);
+
+        for (std::int64_t t = time; t < end; t += down)
+        {
+            phaseOffsets[static_cast<size_t> (numOutput)] = phase * tapsPerPhase;
+            inputOffsets[static_cast<size_t> (numOutput)] = newest - numPast;
+            ++numOutput;
+
+            newest += stepInputs;
+            phase += stepPhase;
+            if (phase >= up)
+            {
+                phase -= up;
+                ++newest;
+            }
+        }
+
+        for (int chan = 0; chan < history.getNumChannels(); ++chan)
+        {
+            float* x = history.getWriteArray()[chan];
+            vectorCopy (input[chan], x + numPast, numInputSamples);
+            vectorDots (taps.data(), phaseOffsets.data(), x, inputOffsets.data(), output[chan], numOutput, tapsPerPhase);
+            std::memmove (x, x + numInputSamples, sizeof (float) * static_cast<size_t> (numPast));
+        }
+
+        time += static_cast<std::int64_t> (numOutput) * down - static_cast<std::int64_t> (numInputSamples) * up;
+        return numOutput;
+    }
+
+    double getLatencySeconds() const noexcept override
+    {
+        return (tapsPerPhase * up - 1) / (2.0 * fromRate * up);
+    }
+
+private:
+    const int fromRate;
+    int up;
+    int down;
+    int tapsPerPhase;
+    std::vector<float> taps;                    // by phase, each back to front (see vectorDots())
+
+    ado::Buffer history {1, 1};                 // tapsPerPhase - 1 past inputs, then the block's
+    int maxInput {0};
+    std::vector<int> phaseOffsets;              // each output's taps & input, the same for every channel
+    std::vector<int> inputOffsets;
+    std::int64_t time {0};                      // next output, in up * input samples from history's start
+};
+
+//==============================================================================
+PolyphaseResampler::PolyphaseResampler (int sourceRate, int destRate)
+    : fromRate {sourceRate},
+      toRate {destRate}
+{
+    Expects (0 < fromRate && 0 < toRate);
+
+        // halve the higher rate while it stays at or above the lower
+    const int lowRate = std::min (fromRate, toRate);
+    const double passbandHz = passbandEdge * lowRate / 2.0;
+    std::vector<int> halvings;                  // each one's higher rate, highest first
+    int rate = std::max (fromRate, toRate);
+
+    while (rate % 2 == 0 && rate / 2 >= lowRate && fromRate != toRate)
+    {
+        halvings.push_back (rate);
+        rate /= 2;
+    }
+
+    if (fromRate > toRate)
+    {
+        for (const int high : halvings)
+            stages.emplace_back (new HalfBand {high, passbandHz, true});
+        if (rate != toRate)
+            stages.emplace_back (new Rational {rate, toRate, passbandHz});
+    }
+    else
+    {
+        if (rate != fromRate || fromRate == toRate)
+            stages.emplace_back (new Rational {fromRate, rate, passbandHz});
+        for (auto high = halvings.rbegin(); high != halvings.rend(); ++high)
+            stages.emplace_back (new HalfBand {*high, passbandHz, false});
+    }
+}
+
+PolyphaseResampler::~PolyphaseResampler() {}
+
+void PolyphaseResampler::prepare (int numChannels, int maxInputSamples)
+{
+    Expects (0 < numChannels && 0 < maxInputSamples);
+
+    between.resize (stages.size() - 1);
+    int maxSamples = maxInputSamples;
+    for (size_t i = 0; i < stages.size(); ++i)
+    {
+        stages[i]->prepare (numChannels, maxSamples);
+        maxSamples = stages[i]->getMaxOutputSamples (maxSamples);
+        if (i < between.size())
+            between[i].clearAndResize (numChannels, maxSamples);
+    }
+}
+
+void PolyphaseResampler::reset()
+{
+    for (auto& stage : stages)
+        stage->reset();
+}
+
+int PolyphaseResampler::getMaxOutputSamples (int numInputSamples) const noexcept
+{
+    int maxSamples = numInputSamples;
+    for (auto& stage : stages)
+        maxSamples = stage->getMaxOutputSamples (maxSamples);
+    return maxSamples;
+}
+
+int PolyphaseResampler::process (const float* const* input, int numInputSamples, float* const* output)
+{
+    const float* const* in = input;
+    int numSamples = numInputSamples;
+
+    for (size_t i = 0; i < between.size(); ++i)
+    {
+        float** out = between[i].getWriteArray();
+        numSamples = stages[i]->process (in, numSamples, out);
+        in = out;
+    }
+    return stages.back()->process (in, numSamples, output);
+}
+
+double PolyphaseResampler::getLatencySeconds() const noexcept
+{
+    double seconds {0.0};
+    for (auto& stage : stages)
+        seconds += stage->getLatencySeconds();
+    return seconds;
+}
+
 } // namespace
@@ -0,0 +1,217 @@
+//==============================================================================
+/*
+    The MIT License (MIT)
+
+    Copyright (c) 2016 John Flynn
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to
+    deal in the Software without restriction, including without limitation the
+    rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+    sell copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+    THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+    IN THE SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include "../Dependencies/gsl.h"
+#include "../SegmentedConvolution.h"
+
+namespace ado
+{
+
+namespace
+{
+    juce::int64 roundUp (juce::int64 n, juce::int64 multiple) noexcept
+    {
+        return (n + multiple - 1) / multiple * multiple;
+    }
+
+    int greatestCommonDivisor (int a, int b) noexcept
+    {
+        while (b != 0)
+        {
+            const int r = a % b;
+            a = b;
+            b = r;
+        }
+        return a;
+    }
+
+    class SegmentJob  : public juce::ThreadPoolJob
+    {
+    public:
+        explicit SegmentJob (std::function<void()> work)
+            : juce::ThreadPoolJob {"Convolution segment"}, run {std::move (work)}
+        {
+        }
+
+        JobStatus runJob() override
+        {
+            run();
+            return jobHasFinished;
+        }
+
+    private:
+        std::function<void()> run;
+    };
+}
+
+//==============================================================================
+struct SegmentedConvolution::Segment
+{
+    Segment (juce::int64 first, juce::int64 last) : start {first}, end {last} {}
+
+    const juce::int64 start;                    // output, [start, end)
+    const juce::int64 end;
+    ado::Buffer output {1, 1};
+    bool done {false};
+};
+
+//==============================================================================
+SegmentedConvolution::SegmentedConvolution (const ado::Buffer& impulse, int numChannelsToUse,
+                                            int blockSizeToUse, Setup setupToUse)
+    : ir (impulse),
+      numChannels {numChannelsToUse},
+      blockSize {blockSizeToUse},
+      setup {std::move (setupToUse)}
+{
+    Expects (0 < numChannels && numChannels <= MultichannelConvolution::maxChannels);
+    Expects (0 < blockSize);
+
+    MultichannelConvolution probe {ir, 0};      // what the setup makes of it
+    if (setup)
+        setup (probe);
+
+        // Every partition runs on a multiple of its size from the engine's start
+        // (the largest FFT's half, the reblocking quantum below that), fed
+        // blockSize at a time: the schedule repeats every lcm of the two.
+    const int maxFftSize = probe.getMaxFftSize();
+    latency = probe.getLatencySamples();
+    period = blockSize / greatestCommonDivisor (blockSize, maxFftSize) * maxFftSize;
+    warmUp = static_cast<int> (roundUp (ir.getNumSamples() + latency + maxFftSize, period));
+}
+
+juce::int64 SegmentedConvolution::getSegmentSize (juce::int64 numSamples, int numJobs) const noexcept
+{
+    const juce::int64 whole = roundUp (std::max<juce::int64> (numSamples, 1), blockSize);
+    const juce::int64 minimum = 8 * static_cast<juce::int64> (warmUp);
+
+    if (numJobs < 2 || numSamples < 2 * minimum)
+        return whole;
+
+    const juce::int64 share = numSamples / (4 * numJobs);
+    const juce::int64 size = roundUp (std::max (minimum, std::min<juce::int64> (share, maxSegmentSize)), period);
+
+    return std::min (size, whole);
+}
+
+bool SegmentedConvolution::process (juce::int64 numSamples, Convolution::MixGains gains, int numJobs,
+                                    Reader reader, Writer writer)
+{
+    Expects (0 <= numSamples && 0 < numJobs);
+    Expects (reader && writer);
+
+    const juce::int64 segmentSize = getSegmentSize (numSamples, numJobs);
+    const int numThreads = static_cast<int> (std::min<juce::int64> (numJobs, (numSamples + segmentSize - 1) / segmentSize));
+
+    std::mutex lock;
+    std::condition_variable segmentDone;
+    std::deque<std::unique_ptr<Segment>> inFlight;  // in order, oldest first
+    juce::int64 nextStart {0};
+
+    juce::ThreadPool pool {std::max (numThreads, 1)};
+    bool ok {true};
+
+    for (;;)
+    {
+        while (nextStart < numSamples && static_cast<int> (inFlight.size()) < 2 * numThreads)
+        {
+            inFlight.emplace_back (new Segment {nextStart, std::min (nextStart + segmentSize, numSamples)});
+            Segment* segment = inFlight.back().get();
+            nextStart = segment->end;
+
+            pool.addJob (new SegmentJob {[this, segment, gains, &reader, &lock, &segmentDone]
+                         {
+                             render (*segment, gains, reader);
+
+                             std::lock_guard<std::mutex> guard {lock};
+                             segment->done = true;
+                             segmentDone.notify_all();
+                         }},
+                         true);
+        }
+
+        if (inFlight.empty())
+            break;
+
+        {
+            std::unique_lock<std::mutex> guard {lock};
+            segmentDone.wait (guard, [&inFlight] { return inFlight.front()->done; });
+        }
+
+        const Segment& oldest = *inFlight.front();
+        ok = writer (oldest.output.getReadArray(), numChannels, oldest.start,
+                     static_cast<int> (oldest.end - oldest.start));
+        inFlight.pop_front();
+
+        if (! ok)
+        {
+            pool.removeAllJobs (true, -1);      // lets the running ones finish with the segments
+            break;
+        }
+    }
+
+    return ok;
+}
+
+//==============================================================================
+//private:
+
+void SegmentedConvolution::render (Segment& segment, Convolution::MixGains gains, const Reader& reader)
+{
+    MultichannelConvolution engine {ir, 0};     // this thread's, no workers of its own
+    if (setup)
+        setup (engine);
+    engine.prepare (numChannels, blockSize);
+
+    segment.output.clearAndResize (numChannels, static_cast<int> (segment.end - segment.start));
+
+    ado::Buffer block {numChannels, blockSize};
+
+        // From a multiple of period, as the sequential engine ran through it
+    for (juce::int64 pos = std::max<juce::int64> (0, segment.start - warmUp); pos < segment.end; pos += blockSize)
+    {
+        block.clear();
+        {
+            std::lock_guard<std::mutex> guard {readLock};
+            reader (block.getWriteArray(), numChannels, pos, blockSize);
+        }
+
+        engine.process (block.getWriteArray(), numChannels, blockSize, gains, gains);
+
+        const juce::int64 from = std::max (pos, segment.start);      // the warm-up's output is dropped
+        const juce::int64 to = std::min (pos + blockSize, segment.end);
+        if (from < to)
+            for (int c = 0; c < numChannels; ++c)
+                std::copy (block.getReadArray()[c] + (from - pos), block.getReadArray()[c] + (to - pos),
+                           segment.output.getWriteArray()[c] + (from - segment.start));
+    }
+}
+
+} // namespace ado
@@ -27,6 +27,7 @@
 #include <iostream>
 #include "../Utility.h"
 #include "../Buffer.h"
+#include "../Kernels.h"
 
 namespace ado
 {
@@ -36,9 +37,8 @@ namespace ado
 bool rawBufferEquals (const float** a, const float** b, int channels, int samples)
 {
     for (int chan = 0; chan < channels; ++chan)
-        for (int samp = 0; samp < samples; ++samp)
-            if (a[chan][samp] != b[chan][samp])
-                return false;
+        if (! vectorEquals (a[chan], b[chan], samples))
+            return false;
     return true;
 }
 
@@ -47,8 +47,7 @@ bool rawBufferEquals (const float** a, const float** b, int channels, int sample
 void rawBufferCopy (const float** source, float** dest, int channels, int samples)
 {
     for (int chan = 0; chan < channels; ++chan)
-        for (int samp = 0; samp < samples; ++samp)
-            dest[chan][samp] = source[chan][samp];
+        vectorCopy (source[chan], dest[chan], samples);
 }
 
 //==============================================================================
@@ -57,8 +56,7 @@ float rawBufferSum (const float** buffer, int channelsToSum, int samples)
 {
     float elementSum = 0.0f;
     for (int chan = 0; chan < channelsToSum; ++chan)
-        for (int samp = 0; samp < samples; ++samp)
-            elementSum += buffer[chan][samp]; // not checked!!!
+        elementSum += vectorSum (buffer[chan], samples); // not checked!!!
 
     return elementSum;
 }
@@ -67,11 +65,8 @@ float rawBufferSum (const float** buffer, int channelsToSum, int samples)
 
 void rawBufferDownmix4To2 (float** buffer, int samples)
 {
-    for (int samp = 0; samp < samples; ++samp)
-    {
-        buffer[0][samp] = buffer[0][samp] + buffer[2][samp];
-        buffer[1][samp] = buffer[1][samp] + buffer[3][samp];
-    }
+    vectorAdd (buffer[2], buffer[0], samples);
+    vectorAdd (buffer[3], buffer[1], samples);
 }
 
 //==============================================================================
@@ -98,5 +93,10 @@ int nextPowerOf2Order (int x)
     return order;
 }
 
+bool isPowerOf2 (int x)
+{
+    return x > 0 && (x & (x - 1)) == 0;
+}
+
 
 } // namespace
@@ -237,6 +237,87 @@ void Buffer::runTest()
         sum = ado::bufferSumElements(b);
         expectEquals (sum, 64.0f);
     }
+
+    beginTest ("Aligned and padded channels");
+
+    {
+        ado::Buffer b {3, 100};
+        expectEquals (b.getNumPaddedSamples(), 112);
+        for (int c = 0; c < b.getNumChannels(); ++c)
+            expect (reinterpret_cast<uintptr_t> (b.getReadArray()[c]) % ado::Buffer::alignmentBytes == 0);
+
+        b.fillAllOnes();
+        expectEquals (b.getReadArray()[2][111], 0.0f);  // padding stays zero
+        expect (ado::makeBufferView (b).isAligned());
+
+        b.clearAndResize (5, 17);
+        expectEquals (b.getNumPaddedSamples(), 32);
+        expect (ado::makeBufferView (b).isAligned());
+    }
+
+    beginTest ("Copy is deep");
+
+    {
+        ado::Buffer a {2, 50, 48000};
+        a.fillAscending();
+        ado::Buffer b {a};
+        expectEquals (b.getSampleRate(), 48000);
+        expectEquals (b.getReadArray()[1][49], 50.0f);
+        expect (b.getReadArray()[1] != a.getReadArray()[1]);
+
+        a.clear();
+        expectEquals (b.getReadArray()[1][49], 50.0f);
+
+        ado::Buffer c {1, 8};
+        c = b;
+        expectEquals (c.getNumChannels(), 2);
+        expectEquals (c.getReadArray()[0][9], 10.0f);
+        expect (ado::makeBufferView (c).isAligned());
+    }
+
+    beginTest ("Move takes storage");
+
+    {
+        ado::Buffer a {2, 64, 96000};
+        a.fillAscending();
+        const float* data = a.getReadArray()[1];
+
+        ado::Buffer b {std::move (a)};
+        expect (b.getReadArray()[1] == data);
+        expectEquals (b.getSampleRate(), 96000);
+        expectEquals (a.getNumChannels(), 0);
+
+        ado::Buffer c;
+        c = std::move (b);
+        expect (c.getReadArray()[1] == data);
+        expectEquals (c.getReadArray()[1][63], 64.0f);
+    }
+
+    beginTest ("channel() span");
+
+    {
+        ado::Buffer b {2, 10};
+        b.fillAscending();
+        gsl::span<float> right = b.channel (1);
+        expectEquals (static_cast<int> (right.size()), 10);
+        expectEquals (right[9], 10.0f);
+        right[0] = 99.0f;
+        expectEquals (b.getReadArray()[1][0], 99.0f);
+        expectThrows (b.channel (2));
+    }
+
+    beginTest ("copyFrom()");
+
+    {
+        ado::Buffer source {1, 20};
+        source.fillAscending();
+        ado::Buffer dest {2, 40};
+        dest.fillAllOnes();
+        dest.copyFrom (source);
+        expectEquals (dest.getReadArray()[0][19], 20.0f);
+        expectEquals (dest.getReadArray()[0][20], 0.0f);
+        expectEquals (dest.getReadArray()[1][0], 0.0f);
+    }
 }
 
 #endif // AIDIO_UNIT_TESTS
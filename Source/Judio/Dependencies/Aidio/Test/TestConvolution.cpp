@@ -10,6 +10,8 @@
 
 #include "../JuceLibraryCode/JuceHeader.h"
 #include "../Aidio.h"
+#include <atomic>
+#include <thread>
 
 //==============================================================================
 
@@ -17,6 +19,75 @@
 
 AIDIO_DECLARE_UNIT_TEST_WITH_STATIC_INSTANCE(Convolution)
 
+namespace
+{
+
+/** Noise, -scale to scale. */
+ado::Buffer randomBuffer (Random& rand, int numChannels, int numSamples, float scale)
+{
+    ado::Buffer buffer {numChannels, numSamples};
+    for (int c = 0; c < numChannels; ++c)
+        for (auto& s : buffer.channel (c))
+            s = (rand.nextFloat() * 2.0f - 1.0f) * scale;
+    return buffer;
+}
+
+/** y[n] = sum h[k] x[n-k], in double: the reference the engines are checked against. */
+float directConvolution (const ado::Buffer& h, const ado::Buffer& x, int channel, int n)
+{
+    double y {0.0};
+    for (int k = 0; k < h.getNumSamples() && k <= n; ++k)
+        y += static_cast<double> (h.getReadArray()[channel][k]) * x.getReadArray()[channel][n - k];
+    return static_cast<float> (y);
+}
+
+ado::Buffer directConvolution (const ado::Buffer& h, const ado::Buffer& x)
+{
+    ado::Buffer y {x.getNumChannels(), x.getNumSamples()};
+    for (int c = 0; c < y.getNumChannels(); ++c)
+        for (int n = 0; n < y.getNumSamples(); ++n)
+            y.getWriteArray()[c][n] = directConvolution (h, x, c, n);
+    return y;
+}
+
+/** The largest difference between y, x through h, and the direct form, checking
+    every step'th sample from the first (the direct form is slow).
+*/
+float maxErrorAgainstDirect (const ado::Buffer& h, const ado::Buffer& x, const ado::Buffer& y,
+                             int step = 1, int first = 0)
+{
+    float err {0.0f};
+    for (int c = 0; c < y.getNumChannels(); ++c)
+        for (int n = first; n < y.getNumSamples(); n += step)
+            err = std::max (err, std::abs (y.getReadArray()[c][n] - directConvolution (h, x, c, n)));
+    return err;
+}
+
+/** x through the engine in place, blockSize at a time (the last block may be
+    short), wet only.
+*/
+ado::Buffer processInBlocks (ado::Convolution& engine, const ado::Buffer& x, int blockSize, bool mixing = false)
+{
+    const ado::Convolution::MixGains wetOnly {1.0f, 0.0f};
+    ado::Buffer y {x};
+    std::vector<float*> block (static_cast<size_t> (y.getNumChannels()));
+
+    for (int start = 0; start < y.getNumSamples(); start += blockSize)
+    {
+        for (int c = 0; c < y.getNumChannels(); ++c)
+            block[static_cast<size_t> (c)] = y.getWriteArray()[c] + start;
+
+        const int len = std::min (blockSize, y.getNumSamples() - start);
+        if (mixing)
+            engine.process (block.data(), y.getNumChannels(), len, wetOnly, wetOnly);
+        else
+            engine.process (block.data(), y.getNumChannels(), len);
+    }
+    return y;
+}
+
+} // namespace
+
 Convolution::Convolution() : UnitTest ("Convolution") {}
 
 void Convolution::runTest()
@@ -132,6 +203,136 @@ void Convolution::runTest()
         
         expectWithinAbsoluteError<float> (cmpl[WDL_fft_permute(len, 0)].im,  0.57451, 0.00001); // stores Nyquist in DC.imag !!!
     }
+
+    beginTest ("Fft WDL mixed radix");
+
+    {
+        Random rand {314159};
+
+        expect (WDL_fft_size_supported (960) && WDL_fft_size_supported (1440) && WDL_fft_size_supported (1024));
+        expect (! WDL_fft_size_supported (441) && ! WDL_fft_size_supported (40960));
+        expect (! WDL_fft_init_size (14));
+
+        for (int len : {6, 60, 480, 960, 1440, 30720})
+        {
+            expect (WDL_fft_init_size (len) != 0);
+
+            std::vector<WDL_FFT_COMPLEX> x (len), h (len), y (len);
+            for (int i = 0; i < len; ++i)
+            {
+                x[i] = {rand.nextFloat() - 0.5f, rand.nextFloat() - 0.5f};
+                h[i] = {rand.nextFloat() - 0.5f, rand.nextFloat() - 0.5f};
+            }
+            std::vector<WDL_FFT_COMPLEX> xf {x}, hf {h};
+
+            WDL_fft (xf.data(), len, 0);    // forward then inverse, unscaled
+            y = xf;
+            WDL_fft (y.data(), len, 1);
+            float err {0.0f};
+            for (int i = 0; i < len; ++i)
+                err = std::max (err, std::max (std::abs (y[i].re / len - x[i].re), std::abs (y[i].im / len - x[i].im)));
+            expectLessThan (err, 1.0e-5f);
+
+            if (len > 1440)                 // direct below is O(n^2)
+                continue;
+
+            WDL_fft (hf.data(), len, 0);    // spectra in the same (permuted) order, so
+            for (int i = 0; i < len; ++i)   // multiplying them circularly convolves
+                y[i] = {xf[i].re * hf[i].re - xf[i].im * hf[i].im, xf[i].re * hf[i].im + xf[i].im * hf[i].re};
+            WDL_fft (y.data(), len, 1);
+
+            err = 0.0f;
+            for (int n = 0; n < len; ++n)
+            {
+                double re {0.0}, im {0.0};
+                for (int k = 0; k < len; ++k)
+                {
+                    const WDL_FFT_COMPLEX& a = x[k];
+                    const WDL_FFT_COMPLEX& b = h[(n - k + len) % len];
+                    re += static_cast<double> (a.re) * b.re - static_cast<double> (a.im) * b.im;
+                    im += static_cast<double> (a.re) * b.im + static_cast<double> (a.im) * b.re;
+                }
+                err = std::max (err, static_cast<float> (std::max (std::abs (y[n].re / len - re),
+                                                                   std::abs (y[n].im / len - im))));
+            }
+            expectLessThan (err, 1.0e-4f);
+        }
+    }
+    beginTest ("Fft WDL large sizes");
+
+    {
+        Random rand {271828};
+        WDL_fft_init();
+
+        for (int len : {65536, 131072, 262144})
+        {
+            expect (WDL_fft_size_supported (len) != 0);
+
+            std::vector<WDL_FFT_COMPLEX> x (len), y (len);
+            for (auto& c : x)
+                c = {rand.nextFloat() - 0.5f, rand.nextFloat() - 0.5f};
+
+            y = x;                          // forward then inverse, unscaled
+            WDL_fft (y.data(), len, 0);
+            WDL_fft (y.data(), len, 1);
+            float err {0.0f};
+            for (int i = 0; i < len; ++i)
+                err = std::max (err, std::max (std::abs (y[i].re / len - x[i].re), std::abs (y[i].im / len - x[i].im)));
+            expectLessThan (err, 1.0e-5f);
+
+            const int a {12345}, b {len - 100};     // delta * delta wraps to a delta at (a + b) % len
+            std::vector<WDL_FFT_COMPLEX> da (len, WDL_FFT_COMPLEX {0.0f, 0.0f}), db {da};
+            da[a].re = 1.0f;
+            db[b].re = 1.0f;
+            WDL_fft (da.data(), len, 0);
+            WDL_fft (db.data(), len, 0);
+            for (int i = 0; i < len; ++i)
+                y[i] = {da[i].re * db[i].re - da[i].im * db[i].im, da[i].re * db[i].im + da[i].im * db[i].re};
+            WDL_fft (y.data(), len, 1);
+
+            err = 0.0f;
+            for (int i = 0; i < len; ++i)
+                err = std::max (err, std::abs (y[i].re / len - (i == (a + b) % len ? 1.0f : 0.0f)));
+            expectLessThan (err, 1.0e-5f);
+        }
+        expect (! WDL_fft_size_supported (524288));
+    }
+
+    beginTest ("Fft WDL thread safe init");
+
+    {
+        const std::vector<int> sizes {720, 1200, 2400, 3840, 4800, 7680};  // none made by the tests above
+        std::atomic<int> failures {0};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 8; ++t)
+            threads.emplace_back ([&sizes, &failures, t]
+            {
+                WDL_fft_init();
+                for (size_t i = 0; i < sizes.size(); ++i)
+                    if (! WDL_fft_init_size (sizes[(i + t) % sizes.size()]))
+                        ++failures;
+            });
+        for (auto& t : threads)
+            t.join();
+        expectEquals (failures.load(), 0);
+
+        Random rand {161803};
+        for (int len : sizes)
+        {
+            std::vector<WDL_FFT_COMPLEX> x (len), y (len);
+            for (auto& c : x)
+                c = {rand.nextFloat() - 0.5f, rand.nextFloat() - 0.5f};
+
+            y = x;                          // forward then inverse, unscaled
+            WDL_fft (y.data(), len, 0);
+            WDL_fft (y.data(), len, 1);
+            float err {0.0f};
+            for (int i = 0; i < len; ++i)
+                err = std::max (err, std::max (std::abs (y[i].re / len - x[i].re), std::abs (y[i].im / len - x[i].im)));
+            expectLessThan (err, 1.0e-5f);
+        }
+    }
+
 /*
     beginTest ("Fft WDL speed");     // ----  MAKE SURE TO BE IN RELEASE MODE!!!! ---- WDL 2x faster!
 
@@ -472,7 +673,8 @@ void Convolution::runTest()
 
         sum += ado::rawBufferSum (block.getReadArray(), channels, blockSize);
 
-        expectWithinAbsoluteError (sum, 5.010006e+11f, 0.0001f); // octave: sum(conv(h, h))
+        expectWithinAbsoluteError (sum, 5.010005e+11f, 5.010005e+11f * 1.0e-7f); // octave: sum(conv(h, h)),
+                                                                                 // within float summing error
     }
 
     beginTest ("set()");
@@ -509,6 +711,531 @@ void Convolution::runTest()
 
         expectEquals (sum, 3.0f);
     }
+
+    beginTest ("Mixing process()");
+
+    {
+        ado::Buffer h {2, 16};
+        h.getWriteArray()[0][0] = 2.0f;     // wet == 2 * dry
+        h.getWriteArray()[1][0] = 2.0f;
+
+        ado::Convolution engine {h};
+
+        const int blockSize = 64;
+        ado::Buffer block {2, blockSize};
+        using Gains = ado::Convolution::MixGains;
+
+        block.fillAllOnes();                // ramp all wet to all dry
+        engine.process (block.getWriteArray(), 2, blockSize, Gains {1.0f, 0.0f}, Gains {0.0f, 1.0f});
+        for (int s = 0; s < blockSize; ++s)
+        {
+            const float t = static_cast<float> (s) / blockSize;
+            expectWithinAbsoluteError (block.getReadArray()[1][s], 2.0f * (1.0f - t) + t, 1.0e-5f);
+        }
+
+        block.fillAllOnes();                // all wet, with gain
+        engine.process (block.getWriteArray(), 2, blockSize, Gains {0.5f, 0.0f}, Gains {0.5f, 0.0f});
+        expectWithinAbsoluteError (ado::bufferSumElements (block), 2.0f * blockSize, 1.0e-4f);
+
+        block.fillAllOnes();                // all dry, gain ramped down
+        engine.process (block.getWriteArray(), 2, blockSize, Gains {0.0f, 1.0f}, Gains {0.0f, 0.5f});
+        expectWithinAbsoluteError (block.getReadArray()[0][blockSize / 2], 0.75f, 1.0e-5f);
+
+        block.fillAllOnes();                // engine kept running while all dry
+        engine.process (block.getWriteArray(), 2, blockSize, Gains {1.0f, 0.0f}, Gains {1.0f, 0.0f});
+        expectWithinAbsoluteError (ado::bufferSumElements (block), 4.0f * blockSize, 1.0e-4f);
+    }
+
+    beginTest ("Against direct convolution");
+
+    {
+        const int channels {2};
+        const int irLength {3000};          // several partitions
+        const int sigLength {8192};
+        Random rand {123456};
+        const ado::Buffer h {randomBuffer (rand, channels, irLength, 0.05f)};
+        const ado::Buffer x {randomBuffer (rand, channels, sigLength, 1.0f)};
+
+        auto maxError = [&] (ado::Convolution& engine, int blockSize, bool mixing)
+        {
+            return maxErrorAgainstDirect (h, x, processInBlocks (engine, x, blockSize, mixing));
+        };
+
+        ado::Convolution engine {h};
+        engine.prepare (channels, 64);
+        expectLessThan (maxError (engine, 64, false), 1.0e-4f);
+
+        ado::Convolution mixer {h};         // blocks bigger than the scratch, mixed in chunks
+        expectLessThan (maxError (mixer, 2048, true), 1.0e-4f);
+
+        for (int head : {16, 128, 512, 2048})   // direct form head, up to most of the impulse
+        {
+            ado::Convolution headed {h};
+            headed.setHeadSize (head);
+            headed.prepare (channels, 32);
+            expectEquals (headed.getHeadSize(), head);
+            expectLessThan (maxError (headed, 32, false), 1.0e-4f);
+        }
+    }
+
+    beginTest ("Head size benchmark");
+
+    {
+        for (int blockSize : {32, 256})
+        {
+            const int best = ado::Convolution::measureHeadSize (2, blockSize);
+            logMessage ("Fastest head for 2 channels, " + String (blockSize) + " sample blocks: " + String (best));
+
+            expect (32 <= best && best <= 512 && (best & (best - 1)) == 0);
+            expectEquals (ado::Convolution::measureHeadSize (2, blockSize), best);     // cached
+
+            ado::Buffer ir {2, 4096};
+            ir.fillAscending();
+            ado::Convolution engine {ir};
+            engine.prepare (2, blockSize);                                              // auto by default
+            expectEquals (engine.getHeadSize(), best);
+
+            engine.setHeadSize (100);                                                   // rounded up
+            expectEquals (engine.getHeadSize(), 128);
+            engine.setHeadSize (ado::Convolution::autoHeadSize);
+            expectEquals (engine.getHeadSize(), best);
+        }
+    }
+
+    beginTest ("Mono input topology");
+
+    {
+        const int irLength {3000};
+        Random rand {654321};
+
+        ado::Buffer h {2, irLength};        // true stereo ir, different channels
+        for (int c = 0; c < 2; ++c)
+            for (int s = 0; s < irLength; ++s)
+                h.getWriteArray()[c][s] = (rand.nextFloat() * 2.0f - 1.0f) * 0.05f;
+
+        for (int blockSize : {256, 16})     // 16 is small block mode
+        {
+            ado::Convolution stereo {h};        // mono duplicated into both channels
+            ado::Convolution mono {h};          // told the input is mono
+            mono.setTopology (ado::Convolution::Topology::monoInput);
+            mono.prepare (2, blockSize);
+            stereo.prepare (2, blockSize);
+
+            using Gains = ado::Convolution::MixGains;
+            const Gains gains {0.7f, 0.3f};
+
+            ado::Buffer a {2, blockSize};
+            ado::Buffer b {2, blockSize};
+            float err {0.0f};
+            for (int block = 0; block < 10240 / blockSize; ++block)
+            {
+                for (int s = 0; s < blockSize; ++s)
+                {
+                    const float x = rand.nextFloat() * 2.0f - 1.0f;
+                    a.getWriteArray()[0][s] = a.getWriteArray()[1][s] = x;
+                    b.getWriteArray()[0][s] = x;
+                    b.getWriteArray()[1][s] = 123.0f;   // must not be read
+                }
+
+                stereo.process (a.getWriteArray(), 2, blockSize, gains, gains);
+                mono.process (b.getWriteArray(), 2, blockSize, gains, gains);
+
+                for (int c = 0; c < 2; ++c)
+                    for (int s = 0; s < blockSize; ++s)
+                        err = std::max (err, std::abs (a.getReadArray()[c][s] - b.getReadArray()[c][s]));
+            }
+            expectLessThan (err, 1.0e-5f);
+            expect (mono.getTopology() == ado::Convolution::Topology::monoInput);
+        }
+    }
+
+    beginTest ("True stereo topology");
+
+    {
+        const int irLength {3000};
+        const int sigLength {4096};
+        Random rand {24680};
+
+        ado::Buffer h {4, irLength};        // LL, LR, RL, RR
+        ado::Buffer x {2, sigLength};
+        for (int c = 0; c < 4; ++c)
+            for (int s = 0; s < irLength; ++s)
+                h.getWriteArray()[c][s] = (rand.nextFloat() * 2.0f - 1.0f) * 0.05f;
+        for (int c = 0; c < 2; ++c)
+            for (int s = 0; s < sigLength; ++s)
+                x.getWriteArray()[c][s] = rand.nextFloat() * 2.0f - 1.0f;
+
+        auto direct = [&] (int out, int n) // L->out + R->out
+        {
+            double y {0.0};
+            for (int in = 0; in < 2; ++in)
+                for (int k = 0; k < irLength && k <= n; ++k)
+                    y += static_cast<double> (h.getReadArray()[in * 2 + out][k]) * x.getReadArray()[in][n - k];
+            return static_cast<float> (y);
+        };
+
+        for (int blockSize : {128, 32})     // 32 is small block mode
+        {
+            ado::Convolution engine {h};
+            engine.setTopology (ado::Convolution::Topology::trueStereo);
+            engine.prepare (2, blockSize);
+
+            ado::Buffer block {2, blockSize};
+            float err {0.0f};
+            for (int start = 0; start < sigLength; start += blockSize)
+            {
+                for (int c = 0; c < 2; ++c)
+                    std::copy (x.getReadArray()[c] + start, x.getReadArray()[c] + start + blockSize,
+                               block.getWriteArray()[c]);
+
+                engine.process (block);
+
+                for (int c = 0; c < 2; ++c)
+                    for (int s = 0; s < blockSize; ++s)
+                        err = std::max (err, std::abs (block.getReadArray()[c][s] - direct (c, start + s)));
+            }
+            expectLessThan (err, 1.0e-4f);
+        }
+    }
+
+    beginTest ("Small block mode");
+
+    {
+        const int channels {2};
+        const int irLength {5000};
+        const int sigLength {6000};
+        Random rand {97531};
+        ado::Buffer h {randomBuffer (rand, channels, irLength, 0.05f)};
+        ado::Buffer x {randomBuffer (rand, channels, sigLength, 1.0f)};
+
+        WDL_ImpulseBuffer imp;
+        imp.Set (h.getReadArray(), irLength, channels);
+
+        WDL_ConvolutionEngine_Div eng;
+        eng.SetImpulse (&imp);
+        eng.Prepare (channels, 32);
+        expect (eng.GetSmallBlockMode());
+
+        ado::Buffer out {channels, sigLength};
+        float* in[channels];
+        float* o[channels];
+        int pos {0}, read {0}, i {0};
+
+        while (pos < sigLength)             // uneven blocks, via both AvailTo() & Avail()/Get()/Advance()
+        {
+            const int len = std::min (1 + (i * 7) % 32, sigLength - pos);
+            for (int c = 0; c < channels; ++c)
+                in[c] = x.getWriteArray()[c] + pos;
+            eng.Add (in, len, channels);
+            pos += len;
+
+            if (i % 3 == 2)                 // sometimes two Add()s before reading
+            {
+                const int avail = eng.Avail (pos - read);
+                WDL_FFT_REAL** got = eng.Get();
+                for (int c = 0; c < channels; ++c)
+                    std::copy (got[c], got[c] + avail, out.getWriteArray()[c] + read);
+                eng.Advance (avail);
+                read += avail;
+            }
+            else if (i % 3 == 0)
+            {
+                for (int c = 0; c < channels; ++c)
+                    o[c] = out.getWriteArray()[c] + read;
+                read += eng.AvailTo (o, channels, pos - read);
+            }
+            ++i;
+        }
+        for (int c = 0; c < channels; ++c)
+            o[c] = out.getWriteArray()[c] + read;
+        read += eng.AvailTo (o, channels, sigLength - read);
+        expectEquals (read, sigLength);
+        expectLessThan (maxErrorAgainstDirect (h, x, out), 1.0e-4f);
+
+        eng.Prepare (channels, 256);        // bigger blocks queue as before
+        expect (! eng.GetSmallBlockMode());
+        eng.Prepare (channels, 16);
+        expect (eng.GetSmallBlockMode());
+        eng.SetImpulse (&imp);              // until the next impulse
+        expect (! eng.GetSmallBlockMode());
+    }
+
+    beginTest ("Mixed radix partitions");
+
+    {
+        const int channels {2};
+        const int irLength {20000};         // into the 4x partitions
+        const int sigLength {24000};
+        Random rand {86420};
+        const ado::Buffer h {randomBuffer (rand, channels, irLength, 0.02f)};
+        const ado::Buffer x {randomBuffer (rand, channels, sigLength, 1.0f)};
+
+        expect (ado::Convolution::partitionsMatchBlockSize (480));
+        expect (ado::Convolution::partitionsMatchBlockSize (1440));
+        expect (ado::Convolution::partitionsMatchBlockSize (512));
+        expect (! ado::Convolution::partitionsMatchBlockSize (441));
+        expect (! ado::Convolution::partitionsMatchBlockSize (1000 + 2));
+
+        for (int blockSize : {480, 960, 1440})
+        {
+            ado::Convolution engine {h};
+            engine.prepare (channels, blockSize);
+
+            ado::Buffer y {x};
+            for (int start = 0, i = 0; start < sigLength; ++i)
+            {
+                const int len = std::min (i % 4 == 3 ? blockSize / 3 : blockSize, sigLength - start);
+                float* b[channels] {y.getWriteArray()[0] + start, y.getWriteArray()[1] + start};
+                engine.process (b, channels, len);
+                start += len;
+            }
+            expectLessThan (maxErrorAgainstDirect (h, x, y, 7), 1.0e-4f);
+        }
+    }
+
+    beginTest ("Large FFT tail");
+
+    {
+        const int irLength {200000};        // the last partition 65536 on, 131072 point FFTs
+        const int sigLength {150000};
+        const int blockSize {1024};
+        Random rand {11235};
+        const ado::Buffer h {randomBuffer (rand, 1, irLength, 0.005f)};
+        const ado::Buffer x {randomBuffer (rand, 1, sigLength, 1.0f)};
+
+        ado::Convolution engine {h};
+        engine.setMaxFftSize (262144);
+        expectEquals (engine.getMaxFftSize(), 262144);
+        engine.prepare (1, blockSize);
+
+        const ado::Buffer y {processInBlocks (engine, x, blockSize)};
+        expectLessThan (maxErrorAgainstDirect (h, x, y, 97, 65536), 1.0e-4f);    // where the big partition contributes
+    }
+
+    beginTest ("FFT backends");
+
+    {
+        struct CountingFft : public ado::Convolution::FftBackend
+        {
+            explicit CountingFft (int maxLen) : maxSize {maxLen} {}
+
+            const char* GetName() const override { return "counting"; }
+            bool SupportsSize (int len) const override { return len <= maxSize && WDL_fft_size_supported (len); }
+            bool PrepareSize (int len) override { return SupportsSize (len) && WDL_fft_init_size (len); }
+
+            void FFT (WDL_FFT_COMPLEX* buf, int len, int isInverse) override
+            {
+                ++calls;
+                if (isInverse)              // bins reversed, the engine mustn't care about their order
+                    std::reverse (buf, buf + len);
+                WDL_fft (buf, len, isInverse);
+                if (! isInverse)
+                    std::reverse (buf, buf + len);
+            }
+
+            const int maxSize;
+            int calls {0};
+        };
+
+        const int irLength {20000};
+        const int sigLength {12000};
+        const int blockSize {256};
+        Random rand {57721};
+        const ado::Buffer h {randomBuffer (rand, 1, irLength, 0.02f)};
+        const ado::Buffer x {randomBuffer (rand, 1, sigLength, 1.0f)};
+
+        CountingFft small {1024}, any {WDL_FFT_MAX_SIZE};
+        ado::Convolution engine {h};
+        engine.setFftBackends ({&small, &any});
+        expect (engine.getFftBackends().size() == 2);
+        engine.prepare (1, blockSize);
+
+        expectLessThan (maxErrorAgainstDirect (h, x, processInBlocks (engine, x, blockSize), 13), 1.0e-4f);
+        expect (small.calls > 0);           // the small partitions
+        expect (any.calls > 0);             // and the rest
+
+        small.calls = 0;
+        any.calls = 0;
+        engine.setFftBackends ({});         // back to WDL's own
+        ado::Buffer block {1, blockSize};
+        engine.process (block);
+        expectEquals (small.calls + any.calls, 0);
+    }
+
+    beginTest ("Segment blocks");
+
+    {
+        const int irLength {30000};
+        const int sigLength {8192};
+        const int blockSize {128};
+        Random rand {14142};
+        const ado::Buffer h {randomBuffer (rand, 1, irLength, 0.01f)};
+        const ado::Buffer x {randomBuffer (rand, 1, sigLength, 1.0f)};
+
+        for (int blocks : {1, 2, 3, 5, 16})
+        {
+            ado::Convolution engine {h};
+            engine.setSegmentBlocks (blocks);
+            expectEquals (engine.getSegmentBlocks(), blocks);
+            engine.prepare (1, blockSize);
+
+            expectLessThan (maxErrorAgainstDirect (h, x, processInBlocks (engine, x, blockSize), 17), 1.0e-4f);
+        }
+
+        ado::Convolution engine {h};
+        expectEquals (engine.getSegmentBlocks(), ado::Convolution::defaultSegmentBlocks);
+        expectThrows (engine.setSegmentBlocks (0));
+        expectThrows (engine.setSegmentBlocks (WDL_CONVO_MAX_SEGMENT_BLOCKS + 1));
+    }
+
+    beginTest ("Load balancing");
+
+    {
+        const int irLength {40000};
+        const int sigLength {24000};
+        Random rand {17320};
+        const ado::Buffer h {randomBuffer (rand, 2, irLength, 0.01f)};
+        const ado::Buffer x {randomBuffer (rand, 2, sigLength, 1.0f)};
+
+        for (int blockSize : {32, 256, 480})        // small block mode, and queued
+        {
+            double worst[2] {};
+            for (bool balanced : {false, true})
+            {
+                ado::Convolution engine {h};
+                engine.setHeadSize (256);           // not measured, so the costs compared are the same each run
+                engine.setLoadBalancing (balanced);
+                expect (engine.getLoadBalancing() == balanced);
+                engine.prepare (2, blockSize);
+
+                expectLessThan (maxErrorAgainstDirect (h, x, processInBlocks (engine, x, blockSize), 37), 1.0e-4f);
+
+                const ado::Convolution::Accounting& acc = engine.getAccounting();
+                expectEquals (static_cast<int> (acc.total_samples), sigLength);
+                worst[balanced] = acc.max_cost;
+            }
+            expectLessThan (worst[1], worst[0]);    // the total may go either way, only the peak matters
+        }
+    }
+
+    beginTest ("Reblocking");
+
+    {
+        const int channels {2};
+        const int sigLength {12000};
+        Random rand {24680};
+        const ado::Buffer x {randomBuffer (rand, channels, sigLength, 1.0f)};
+
+        const int sizes[] {480, 441, 1000, 1, 7, 64, 333, 2048, 3, 127};    // what hosts do
+
+        using Reblocking = ado::Convolution::Reblocking;
+        using Gains = ado::Convolution::MixGains;
+
+        for (int irLength : {3000, 100})    // 100: no tail past the quantum
+        {
+            const ado::Buffer h {randomBuffer (rand, channels, irLength, 0.05f)};
+            const ado::Buffer y {directConvolution (h, x)};
+
+            for (auto mode : {Reblocking::fixedLatency, Reblocking::zeroLatency})
+                for (int quantum : {64, 512})
+                    for (bool mixing : {false, true})
+                    {
+                        ado::Convolution engine {h};
+                        engine.setReblocking (mode, quantum);
+                        engine.prepare (channels, 2048);
+
+                        const int latency = engine.getLatencySamples();
+                        expectEquals (latency, mode == Reblocking::fixedLatency ? quantum : 0);
+
+                        const Gains gains {mixing ? 0.6f : 1.0f, mixing ? 0.4f : 0.0f};
+                        ado::Buffer block {channels, 2048};
+                        float* b[channels];
+                        float err {0.0f};
+
+                        for (int start = 0, i = 0; start < sigLength; ++i)
+                        {
+                            const int len = std::min (sizes[i % 10], sigLength - start);
+                            for (int c = 0; c < channels; ++c)
+                            {
+                                b[c] = block.getWriteArray()[c];
+                                std::copy (x.getReadArray()[c] + start, x.getReadArray()[c] + start + len, b[c]);
+                            }
+
+                            if (mixing)
+                                engine.process (b, channels, len, gains, gains);
+                            else
+                                engine.process (b, channels, len);
+
+                            for (int c = 0; c < channels; ++c)
+                                for (int s = 0; s < len; ++s)
+                                {
+                                    const int n = start + s - latency;
+                                    const float expected = n < 0 ? 0.0f : gains.wet * y.getReadArray()[c][n]
+                                                                        + gains.dry * x.getReadArray()[c][n];
+                                    err = std::max (err, std::abs (b[c][s] - expected));
+                                }
+                            start += len;
+                        }
+                        expectLessThan (err, 1.0e-4f);
+                    }
+        }
+
+        ado::Buffer h {channels, 3000};     // monoInput's dry is channel 0, delayed too
+        h.fillAscending();
+        h *= 1.0e-7f;
+        ado::Convolution engine {h};
+        engine.setTopology (ado::Convolution::Topology::monoInput);
+        engine.setReblocking (Reblocking::fixedLatency, 256);
+        engine.prepare (channels, 1000);
+
+        ado::Buffer block {channels, 1000};
+        block.fillAllOnes();
+        std::fill (block.getWriteArray()[1], block.getWriteArray()[1] + 1000, 123.0f);  // not read
+        engine.process (block.getWriteArray(), channels, 1000, Gains {0.0f, 1.0f}, Gains {0.0f, 1.0f});
+        for (int c = 0; c < channels; ++c)
+        {
+            expectEquals (block.getReadArray()[c][255], 0.0f);
+            expectEquals (block.getReadArray()[c][256], 1.0f);
+        }
+
+        engine.setReblocking (Reblocking::off);
+        expectEquals (engine.getLatencySamples(), 0);
+    }
+
+    beginTest ("prepare() with memory locking");
+
+    {
+        const int channels {2};
+        ado::Buffer h {channels, 5000};
+        h.fillAllOnes();
+
+        ado::Convolution engine {h};
+        engine.setMemoryLocking (true);
+        engine.prepare (channels, 512);
+
+        const ado::MemoryLockReport report = engine.getMemoryLockReport();
+        expect (report.bytesTouched > 0);
+        expect (report.bytesLocked > 0 || report.lockFailed); // depends on RLIMIT_MEMLOCK
+
+        ado::Buffer block {channels, 512};
+        block.getWriteArray()[0][0] = 1.0f; // kronecker
+        block.getWriteArray()[1][0] = 1.0f;
+
+        float sum {0.0f};
+        for (int b = 0; b < 11; ++b)    // 11 * 512 > 5000
+        {
+            engine.process (block);
+            sum += ado::rawBufferSum (block.getReadArray(), channels, 512);
+            block.clear();
+        }
+
+        expectWithinAbsoluteError (sum, 5000.0f * channels, 0.01f);
+
+        engine.set (h);                 // re-prepares with the same layout
+        expect (engine.getMemoryLockReport().bytesTouched == report.bytesTouched);
+
+        expectThrows (engine.prepare (0, 512));
+    }
 }
 
 #endif // AIDIO_UNIT_TESTS
@@ -0,0 +1,176 @@
+/*
+  ==============================================================================
+
+    TestKernels.cpp
+    Created: 18 Oct 2026 2:31:05pm
+    Author:  John Flynn
+
+  ==============================================================================
+*/
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "../Aidio.h"
+
+//==============================================================================
+
+#if AIDIO_UNIT_TESTS
+
+AIDIO_DECLARE_UNIT_TEST_WITH_STATIC_INSTANCE(Kernels)
+
+Kernels::Kernels() : UnitTest ("Kernels") {}
+
+void Kernels::runTest()
+{
+    const ado::SimdLevel original = ado::getSimdLevel();
+    expect (original == ado::getHighestSupportedSimdLevel());
+
+    Random rand {98765};
+    std::vector<float> a (300), b (300);        // vectors, so channels aren't aligned for free
+    for (size_t i = 0; i < a.size(); ++i)
+    {
+        a[i] = rand.nextFloat() * 2.0f - 1.0f;
+        b[i] = rand.nextFloat() * 2.0f - 1.0f;
+    }
+
+    const int lengths[] = {0, 1, 3, 4, 7, 8, 15, 16, 17, 33, 257};
+    const int offsets[] = {0, 1, 3};            // misaligned starts
+
+    for (int level = 0; level <= static_cast<int> (ado::getHighestSupportedSimdLevel()); ++level)
+    {
+        ado::setSimdLevel (static_cast<ado::SimdLevel> (level));
+        expectEquals (static_cast<int> (ado::getSimdLevel()), level);
+
+        beginTest ("Kernels at SIMD level " + String (level));
+
+        for (int n : lengths)
+        {
+            for (int o : offsets)
+            {
+                const float* x = a.data() + o;
+                const float* y = b.data() + o;
+                std::vector<float> out (n + 1, 42.0f);  // sentinel past the end
+
+                ado::vectorCopy (x, out.data(), n);
+                expect (ado::vectorEquals (x, out.data(), n));
+                expectEquals (out[n], 42.0f);
+
+                ado::vectorScale (out.data(), 0.5f, n);
+                for (int i = 0; i < n; ++i)
+                    expectEquals (out[i], x[i] * 0.5f);
+                expectEquals (out[n], 42.0f);
+
+                ado::vectorAddScaled (y, out.data(), 2.0f, n);
+                for (int i = 0; i < n; ++i)
+                    expectWithinAbsoluteError (out[i], x[i] * 0.5f + y[i] * 2.0f, 1.0e-6f);
+
+                ado::vectorAdd (x, out.data(), n);
+                for (int i = 0; i < n; ++i)
+                    expectWithinAbsoluteError (out[i], x[i] * 1.5f + y[i] * 2.0f, 1.0e-6f);
+
+                ado::vectorMix (x, 0.25f, y, 0.75f, out.data(), n);
+                for (int i = 0; i < n; ++i)
+                    expectWithinAbsoluteError (out[i], x[i] * 0.25f + y[i] * 0.75f, 1.0e-6f);
+                expectEquals (out[n], 42.0f);
+
+                ado::vectorMixRamped (x, 1.0f, 0.0f, y, 0.0f, 2.0f, out.data(), n);
+                for (int i = 0; i < n; ++i)
+                {
+                    const float t = static_cast<float> (i) / n;
+                    expectWithinAbsoluteError (out[i], x[i] * (1.0f - t) + y[i] * 2.0f * t, 1.0e-5f);
+                }
+                expectEquals (out[n], 42.0f);
+
+                ado::vectorScaleRamped (x, out.data(), 0.5f, 1.5f, n);
+                for (int i = 0; i < n; ++i)
+                    expectWithinAbsoluteError (out[i], x[i] * (0.5f + static_cast<float> (i) / n), 1.0e-5f);
+                expectEquals (out[n], 42.0f);
+
+                double sum {0.0};
+                float peak {0.0f};
+                for (int i = 0; i < n; ++i)
+                {
+                    sum += x[i];
+                    peak = std::max (peak, std::abs (x[i]));
+                }
+                expectWithinAbsoluteError (ado::vectorSum (x, n), static_cast<float> (sum), 1.0e-5f);
+                expectEquals (ado::vectorPeak (x, n), peak);
+
+                if (n > 0)
+                {
+                    ado::vectorCopy (x, out.data(), n);
+                    out[n - 1] += 1.0f;             // differs in the tail only
+                    expect (! ado::vectorEquals (x, out.data(), n));
+                }
+
+                for (int numTaps : {1, 7, 33})      // b's start as the taps, x as input
+                {
+                    std::vector<float> fir (n + 1, 42.0f);
+                    ado::vectorFir (y, numTaps, x, fir.data(), n, false);
+                    ado::vectorFir (y, numTaps, x, fir.data(), n, true);     // doubles it
+                    for (int i = 0; i < n; ++i)
+                    {
+                        double expected {0.0};
+                        for (int k = 0; k < numTaps; ++k)
+                            expected += static_cast<double> (y[k]) * x[i + k];
+                        expectWithinAbsoluteError (fir[i], static_cast<float> (2.0 * expected), 1.0e-5f);
+                    }
+                    expectEquals (fir[n], 42.0f);
+                }
+
+                std::vector<float> re (n + 1, 1.0f), im (n + 1, 1.0f);  // += (x + iy) (y + ix), shifted one
+                re[n] = im[n] = 42.0f;
+                ado::vectorComplexMultiplyAdd (x, y, y + 1, x + 1, re.data(), im.data(), n);
+                for (int i = 0; i < n; ++i)
+                {
+                    expectWithinAbsoluteError (re[i], 1.0f + x[i] * y[i + 1] - y[i] * x[i + 1], 1.0e-6f);
+                    expectWithinAbsoluteError (im[i], 1.0f + x[i] * x[i + 1] + y[i] * y[i + 1], 1.0e-6f);
+                }
+                expectEquals (re[n], 42.0f);
+                expectEquals (im[n], 42.0f);
+
+                const int aOffsets[] {0, 1, 2, 3, 4, 5};    // 4 at once, then singly
+                const int bOffsets[] {0, 2, 4, 6, 8, 10};
+                std::vector<float> dots (7, 42.0f);
+                ado::vectorDots (x, aOffsets, y, bOffsets, dots.data(), 6, n);
+                for (int j = 0; j < 6; ++j)
+                {
+                    double dot {0.0};
+                    for (int i = 0; i < n; ++i)
+                        dot += static_cast<double> (x[aOffsets[j] + i]) * y[bOffsets[j] + i];
+                    expectWithinAbsoluteError (dots[static_cast<size_t> (j)], static_cast<float> (dot), 1.0e-5f);
+                }
+                expectEquals (dots[6], 42.0f);
+
+                std::vector<double> wide (n + 1, 42.0), mixed (n + 1, 42.0);  // x & y with double's bits below float's
+                for (int i = 0; i < n; ++i)
+                    wide[i] = x[i] + y[i] * 1.0e-9;
+
+                ado::vectorConvert (wide.data(), out.data(), n);
+                for (int i = 0; i < n; ++i)
+                    expectEquals (out[i], static_cast<float> (wide[i]));
+                expectEquals (out[n], 42.0f);
+
+                ado::vectorCopy (wide.data(), mixed.data(), n);
+                ado::vectorMixRamped (mixed.data(), 1.0f, 0.0f, wide.data(), 0.0f, 2.0f, mixed.data(), n);
+                for (int i = 0; i < n; ++i)
+                {
+                    const double t = static_cast<double> (i) / n;
+                    expectWithinAbsoluteError (mixed[i], wide[i] * (1.0 - t) + wide[i] * 2.0 * t, 1.0e-14);
+                }
+                expectEquals (mixed[n], 42.0);
+
+                ado::vectorMixRamped (wide.data(), 0.5f, 1.5f, y, 1.0f, 0.0f, mixed.data(), n);
+                for (int i = 0; i < n; ++i)
+                {
+                    const double t = static_cast<double> (i) / n;
+                    expectWithinAbsoluteError (mixed[i], wide[i] * (0.5 + t) + y[i] * (1.0 - t), 1.0e-14);
+                }
+                expectEquals (mixed[n], 42.0);
+            }
+        }
+    }
+
+    ado::setSimdLevel (original);
+}
+
+#endif // AIDIO_UNIT_TESTS
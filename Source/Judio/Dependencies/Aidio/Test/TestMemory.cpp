@@ -0,0 +1,105 @@
+/*
+  ==============================================================================
+
+    TestMemory.cpp
+    Created: 18 Oct 2026 10:12:40am
+    Author:  John Flynn
+
+  ==============================================================================
+*/
+
+#include <fstream>
+#include <string>
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "../Aidio.h"
+
+//==============================================================================
+
+#if AIDIO_UNIT_TESTS
+
+AIDIO_DECLARE_UNIT_TEST_WITH_STATIC_INSTANCE(MemoryLocking)
+
+MemoryLocking::MemoryLocking() : UnitTest ("MemoryLocking") {}
+
+void MemoryLocking::runTest()
+{
+    beginTest ("prefaultMemory()");
+
+    {
+        std::vector<float> v (100000, 1.0f);
+        expect (ado::prefaultMemory (v.data(), v.size() * sizeof (float)) == v.size() * sizeof (float));
+        expectEquals (v[0] + v[50000] + v[99999], 3.0f);   // contents untouched
+        expect (ado::prefaultMemory (nullptr, 100) == 0);
+    }
+
+    beginTest ("lockMemory() within limit");
+
+    {
+        std::vector<char> v (1000);
+        const bool locked = ado::lockMemory (v.data(), v.size());
+        if (ado::getMemoryLockLimit() >= 2 * 4096 * 2)    // two pages at most, generous
+            expect (locked);
+        if (locked)
+            ado::unlockMemory (v.data(), v.size());
+    }
+
+    beginTest ("MemoryLocker");
+
+    {
+        std::vector<float> a (4096), b (4096);
+        ado::MemoryLocker locker;
+        locker.add (a.data(), a.size() * sizeof (float));
+        locker.add (b.data(), b.size() * sizeof (float));
+        locker.add (nullptr, 64);   // ignored
+
+        locker.lock (false);
+        expect (locker.getReport().bytesTouched == 2 * 4096 * sizeof (float));
+        expect (locker.getReport().bytesLocked == 0);
+        expect (! locker.getReport().lockFailed);
+
+        locker.lock (true);
+        const auto& report = locker.getReport();
+        expect (report.lockFailed || report.bytesLocked == 2 * 4096 * sizeof (float));
+
+        locker.clear();
+        expect (locker.getReport().bytesTouched == 0);
+    }
+
+   #if JUCE_LINUX
+    beginTest ("Lockers sharing a page");
+
+    {
+        auto lockedKilobytes = []                       // the kernel's count, VmLck
+        {
+            std::ifstream status {"/proc/self/status"};
+            std::string line;
+            while (std::getline (status, line))
+                if (line.compare (0, 6, "VmLck:") == 0)
+                    return std::stol (line.substr (6));
+            return -1L;
+        };
+
+        std::vector<char> v (3 * 4096);                 // two halves of one whole page
+        char* page = reinterpret_cast<char*> ((reinterpret_cast<uintptr_t> (v.data()) + 4095) & ~static_cast<uintptr_t> (4095));
+        const long before = lockedKilobytes();
+
+        ado::MemoryLocker first, second;
+        first.add (page, 2048);
+        second.add (page + 2048, 2048);
+        first.lock (true);
+        second.lock (true);
+
+        if (! first.getReport().lockFailed && ! second.getReport().lockFailed && before >= 0)
+        {
+            expectEquals (lockedKilobytes(), before + 4);
+            first.clear();                              // the second's half still needs it
+            expectEquals (lockedKilobytes(), before + 4);
+            second.clear();
+            expectEquals (lockedKilobytes(), before);
+        }
+    }
+   #endif
+}
+
+#endif // AIDIO_UNIT_TESTS
@@ -0,0 +1,108 @@
+/*
+  ==============================================================================
+
+    TestMultiStreamConvolution.cpp
+    Created: 18 Oct 2026 11:48:37pm
+    Author:  John Flynn
+
+  ==============================================================================
+*/
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "../Aidio.h"
+
+//==============================================================================
+
+#if AIDIO_UNIT_TESTS
+
+AIDIO_DECLARE_UNIT_TEST_WITH_STATIC_INSTANCE(MultiStreamConvolution)
+
+MultiStreamConvolution::MultiStreamConvolution() : UnitTest ("MultiStreamConvolution") {}
+
+void MultiStreamConvolution::runTest()
+{
+    const int blockSize {64};
+    const int length {blockSize * 40};
+
+    Random rand {13579};
+    ado::Buffer h {2, 1000};                    // 16 partitions, the last part filled
+    for (int c = 0; c < h.getNumChannels(); ++c)
+        for (int s = 0; s < h.getNumSamples(); ++s)
+            h.getWriteArray()[c][s] = (rand.nextFloat() * 2.0f - 1.0f) * std::exp (-0.003f * s);
+
+    auto makeStreams = [&rand] (int numStreams)
+    {
+        ado::Buffer x {numStreams, length};
+        for (int c = 0; c < numStreams; ++c)
+            for (int s = 0; s < length; ++s)
+                x.getWriteArray()[c][s] = rand.nextFloat() * 2.0f - 1.0f;
+        return x;
+    };
+
+    auto maxError = [&h] (const ado::Buffer& x, const ado::Buffer& y, int channel)
+    {
+        const float* const ir {h.getReadArray()[channel]};
+        float error {0.0f};
+        for (int c = 0; c < x.getNumChannels(); ++c)
+            for (int s = 0; s < length; ++s)
+            {
+                double expected {0.0};          // direct convolution
+                for (int k = 0; k <= std::min (s, h.getNumSamples() - 1); ++k)
+                    expected += static_cast<double> (ir[k]) * x.getReadArray()[c][s - k];
+                error = std::max (error, std::abs (y.getReadArray()[c][s] - static_cast<float> (expected)));
+            }
+        return error;
+    };
+
+    auto equal = [] (const ado::Buffer& a, const ado::Buffer& b)
+    {
+        for (int c = 0; c < a.getNumChannels(); ++c)
+            if (! std::equal (a.getReadArray()[c], a.getReadArray()[c] + length, b.getReadArray()[c]))
+                return false;
+        return true;
+    };
+
+    beginTest ("Each stream convolved, odd & even counts, in blocks of any multiple");
+
+    for (int numStreams : {1, 2, 3, 8, 11})
+    {
+        const auto spectra = std::make_shared<const ado::MultiStreamConvolution::Spectra> (h, 1, blockSize);
+        expectEquals (spectra->getNumPartitions(), 16);
+
+        ado::MultiStreamConvolution engine {spectra, numStreams};
+        const ado::Buffer x {makeStreams (numStreams)};
+        ado::Buffer y {x};
+
+        float* channels[16];
+        for (int pos = 0, n = blockSize; pos < length; pos += n, n = 4 * blockSize - n)  // 1, 3, 1, 3... blocks
+        {
+            for (int c = 0; c < numStreams; ++c)
+                channels[c] = y.getWriteArray()[c] + pos;
+            engine.process (channels, n);
+        }
+
+        expectLessThan (maxError (x, y, 1), 1.0e-4f);
+    }
+
+    beginTest ("Engines share the spectra, and reset");
+
+    {
+        const auto spectra = std::make_shared<const ado::MultiStreamConvolution::Spectra> (h, 0, blockSize);
+        ado::MultiStreamConvolution first {spectra, 4};
+        ado::MultiStreamConvolution second {spectra, 4};
+
+        const ado::Buffer x {makeStreams (4)};
+        ado::Buffer y1 {x}, y2 {x};
+        first.process (y1.getWriteArray(), length);
+        second.process (y2.getWriteArray(), length);
+        expect (equal (y1, y2));
+        expectLessThan (maxError (x, y1, 0), 1.0e-4f);
+
+        first.reset();
+        ado::Buffer y3 {x};
+        first.process (y3.getWriteArray(), length);
+        expect (equal (y3, y1));
+    }
+}
+
+#endif // AIDIO_UNIT_TESTS
@@ -0,0 +1,368 @@
+/*
+  ==============================================================================
+
+    TestMultichannelConvolution.cpp
+    Created: 18 Oct 2026 2:41:05pm
+    Author:  John Flynn
+
+  ==============================================================================
+*/
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "../Aidio.h"
+#include <thread>
+
+//==============================================================================
+
+#if AIDIO_UNIT_TESTS
+
+AIDIO_DECLARE_UNIT_TEST_WITH_STATIC_INSTANCE(MultichannelConvolution)
+
+MultichannelConvolution::MultichannelConvolution() : UnitTest ("MultichannelConvolution") {}
+
+void MultichannelConvolution::runTest()
+{
+    const int irLength {2000};
+    const int sigLength {2048};
+    const int blockSize {256};
+
+    // Max error of the engine against direct convolution, channel c against
+    // impulse channel c % impulse channels
+    auto maxError = [this] (ado::MultichannelConvolution& engine, const ado::Buffer& h, int numChannels)
+    {
+        Random rand {13579};
+        ado::Buffer x {numChannels, sigLength};
+        for (int c = 0; c < numChannels; ++c)
+            for (int s = 0; s < sigLength; ++s)
+                x.getWriteArray()[c][s] = rand.nextFloat() * 2.0f - 1.0f;
+
+        ado::Buffer block {numChannels, blockSize};
+        float err {0.0f};
+        for (int start = 0; start < sigLength; start += blockSize)
+        {
+            for (int c = 0; c < numChannels; ++c)
+                std::copy (x.getReadArray()[c] + start, x.getReadArray()[c] + start + blockSize,
+                           block.getWriteArray()[c]);
+
+            engine.process (block);
+
+            for (int c = 0; c < numChannels; ++c)
+            {
+                const float* hc = h.getReadArray()[c % h.getNumChannels()];
+                for (int s = 0; s < blockSize; ++s)
+                {
+                    const int n = start + s;
+                    double y {0.0};
+                    for (int k = 0; k < irLength && k <= n; ++k)
+                        y += static_cast<double> (hc[k]) * x.getReadArray()[c][n - k];
+                    err = std::max (err, std::abs (block.getReadArray()[c][s] - static_cast<float> (y)));
+                }
+            }
+        }
+        return err;
+    };
+
+    auto randomImpulse = [] (int numChannels, int seed)
+    {
+        Random rand {seed};
+        ado::Buffer h {numChannels, irLength};
+        for (int c = 0; c < numChannels; ++c)
+            for (int s = 0; s < irLength; ++s)
+                h.getWriteArray()[c][s] = (rand.nextFloat() * 2.0f - 1.0f) * 0.05f;
+        return h;
+    };
+
+    beginTest ("5.1, an impulse channel each");
+
+    {
+        const ado::Buffer h = randomImpulse (6, 1);
+        ado::MultichannelConvolution engine {h, 2};
+        engine.prepare (6, blockSize);
+
+        expectEquals (engine.getNumEngines(), 3);       // in pairs
+        expectEquals (engine.getNumWorkers(), 2);
+        expectLessThan (maxError (engine, h, 6), 1.0e-4f);
+    }
+
+    beginTest ("7.1.4 from a stereo impulse, spectra shared");
+
+    {
+        const ado::Buffer h = randomImpulse (2, 2);
+        ado::MultichannelConvolution engine {h, 3};
+        engine.prepare (12, blockSize);
+
+        expectEquals (engine.getNumEngines(), 4);       // 6 channels per ir channel, 4 + 2
+        expectLessThan (maxError (engine, h, 12), 1.0e-4f);
+    }
+
+    beginTest ("Two engines on two threads, sharing the workers");
+
+    {
+        const ado::Buffer h = randomImpulse (6, 8);
+        ado::MultichannelConvolution first {h, 2}, second {h, 2};
+        first.prepare (6, blockSize);
+        second.prepare (6, blockSize);
+        expectEquals (first.getNumWorkers(), 2);
+        expectEquals (second.getNumWorkers(), 2);
+
+        float errors[2] {};
+        std::thread other {[&] { errors[1] = maxError (second, h, 6); }};
+        errors[0] = maxError (first, h, 6);
+        other.join();
+
+        expectLessThan (errors[0], 1.0e-4f);
+        expectLessThan (errors[1], 1.0e-4f);
+
+        const ado::Buffer h2 = randomImpulse (6, 9);    // new impulse, same workers
+        first.set (h2);
+        expectEquals (first.getNumWorkers(), 2);
+        expectLessThan (maxError (first, h2, 6), 1.0e-4f);
+    }
+
+    beginTest ("Third order ambisonics, no workers");
+
+    {
+        const ado::Buffer h = randomImpulse (1, 3);
+        ado::MultichannelConvolution engine {h, 0};
+        engine.prepare (16, blockSize);
+
+        expectEquals (engine.getNumEngines(), 4);
+        expectEquals (engine.getNumWorkers(), 0);
+        expectLessThan (maxError (engine, h, 16), 1.0e-4f);
+    }
+
+    beginTest ("Stereo is a single engine, topologies pass through");
+
+    {
+        const ado::Buffer h = randomImpulse (2, 4);
+        ado::MultichannelConvolution engine {h};
+        engine.setTopology (ado::Convolution::Topology::monoInput);
+        engine.prepare (2, blockSize);
+
+        expectEquals (engine.getNumEngines(), 1);
+        expectEquals (engine.getNumWorkers(), 0);
+
+        ado::Buffer block {2, blockSize};
+        block.getWriteArray()[0][0] = 1.0f;             // mono kronecker, channel 1 ignored
+        block.getWriteArray()[1][0] = 100.0f;
+        engine.process (block);
+        expectWithinAbsoluteError (block.getReadArray()[1][10], h.getReadArray()[1][10], 1.0e-6f);
+    }
+
+    beginTest ("Mixed precision: the float mix, but the dry in double");
+
+    {
+        const ado::Buffer h = randomImpulse (2, 7);
+        ado::MultichannelConvolution narrow {h}, wide {h};
+        narrow.prepare (2, blockSize);
+        wide.prepare (2, blockSize);
+
+        Random rand {24680};
+        const int length {blockSize * 2};               // mixed in chunks of the prepared size
+        ado::Buffer x {2, length};
+        std::vector<double> y0 (length), y1 (length);
+        double* y[2] {y0.data(), y1.data()};
+        for (int c = 0; c < 2; ++c)
+            for (int s = 0; s < length; ++s)
+                y[c][s] = x.getWriteArray()[c][s] = rand.nextFloat() * 2.0f - 1.0f;
+
+        narrow.process (x.getWriteArray(), 2, length, {0.2f, 0.8f}, {0.6f, 0.4f});
+        wide.process (y, 2, length, {0.2f, 0.8f}, {0.6f, 0.4f});
+
+        double err {0.0};
+        for (int c = 0; c < 2; ++c)
+            for (int s = 0; s < length; ++s)
+                err = std::max (err, std::abs (y[c][s] - x.getReadArray()[c][s]));
+        expectLessThan (err, 1.0e-5);
+
+        for (int s = 0; s < length; ++s)                // below float's resolution
+            y0[static_cast<size_t> (s)] = y1[static_cast<size_t> (s)] = 1.0 + s * 1.0e-12;
+        wide.process (y, 2, length, {0.0f, 1.0f}, {0.0f, 1.0f});
+        for (int s = 0; s < length; ++s)
+            expect (y0[static_cast<size_t> (s)] == 1.0 + s * 1.0e-12);
+
+        wide.setReblocking (ado::Convolution::Reblocking::fixedLatency, blockSize);
+        wide.prepare (2, blockSize);
+        expectThrows (wide.process (y, 2, blockSize, {0.5f, 0.5f}, {0.5f, 0.5f}));
+        wide.process (y, 2, blockSize, {1.0f, 0.0f}, {1.0f, 0.0f});
+    }
+
+    beginTest ("Mixed precision benchmark");                                    // MAKE SURE TO BE IN RELEASE MODE
+
+    {
+        const int length {88200};                       // a 2s impulse & 512 sample blocks, as the plugin
+        const int block {512};
+        const int numBlocks {400};
+
+        Random rand {97531};
+        ado::Buffer h {2, length};
+        for (int c = 0; c < 2; ++c)
+            for (auto& s : h.channel (c))
+                s = (rand.nextFloat() * 2.0f - 1.0f) * 0.01f;
+
+        ado::MultichannelConvolution narrow {h}, wide {h};
+        narrow.setHeadSize (256);                       // not measured, so both run the same plan
+        wide.setHeadSize (256);
+        narrow.prepare (2, block);
+        wide.prepare (2, block);
+
+        ado::Buffer in {2, block}, x {2, block};
+        for (int c = 0; c < 2; ++c)
+            for (auto& s : in.channel (c))
+                s = rand.nextFloat() * 2.0f - 1.0f;
+        std::vector<double> y0 (block), y1 (block);
+        double* y[2] {y0.data(), y1.data()};
+
+            // Best of several passes each, interleaved, so both see the same machine
+        double best[2] {1.0e9, 1.0e9};
+        for (int pass = 0; pass < 5; ++pass)
+        {
+            for (bool isDouble : {false, true})
+            {
+                const int64 start = Time::getHighResolutionTicks();
+                for (int b = 0; b < numBlocks; ++b)
+                {
+                    for (int c = 0; c < 2; ++c)         // the same input, each at its precision
+                    {
+                        if (isDouble)
+                            std::copy (in.getReadArray()[c], in.getReadArray()[c] + block, y[c]);
+                        else
+                            std::copy (in.getReadArray()[c], in.getReadArray()[c] + block, x.getWriteArray()[c]);
+                    }
+
+                    if (isDouble)
+                        wide.process (y, 2, block, {0.5f, 0.5f}, {0.5f, 0.5f});
+                    else
+                        narrow.process (x.getWriteArray(), 2, block, {0.5f, 0.5f}, {0.5f, 0.5f});
+                }
+                const double seconds = Time::highResolutionTicksToSeconds (Time::getHighResolutionTicks() - start);
+                best[isDouble] = std::min (best[isDouble], seconds);
+            }
+        }
+
+        const double realtime = static_cast<double> (numBlocks) * block / 44100.0;
+        logMessage ("float:  " + String (realtime / best[0], 1) + "x realtime");
+        logMessage ("double: " + String (realtime / best[1], 1) + "x realtime, "
+                    + String (100.0 * (best[1] / best[0] - 1.0), 1) + "% over float");
+
+        expectLessThan (best[1], best[0] * 1.5);       // conversions only, loosely: timings are noisy
+    }
+
+    beginTest ("Internal rate: a 44.1kHz impulse at 176.4kHz, convolved at 44.1kHz");
+
+    {
+        ado::Buffer h {1, irLength};                    // a delay of 100 impulse samples, 400 host ones
+        h.getWriteArray()[0][100] = 1.0f;
+
+        ado::MultichannelConvolution engine {h};
+        engine.resampleIrOnRateChange (176400.0);
+        engine.setInternalRate (44100);
+        engine.prepare (2, blockSize);
+        expect (engine.isConvertingRate());
+
+        const int latency = engine.getLatencySamples();
+        expectGreaterThan (latency, 0);
+
+        const int length {blockSize * 40};
+        ado::Buffer block {2, blockSize};
+        float err {0.0f};
+        for (int start = 0; start < length; start += blockSize)
+        {
+            for (int c = 0; c < 2; ++c)
+                for (int s = 0; s < blockSize; ++s)
+                    block.getWriteArray()[c][s] = static_cast<float> (std::sin (2.0 * 3.14159265358979 * 500.0
+                                                                                * (start + s) / 176400.0));
+            engine.process (block);
+
+            for (int s = 0; s < blockSize; ++s)         // past the filters' start up, within the rounding
+            {
+                const int n = start + s - latency - 400;
+                if (n >= 2000)
+                    err = std::max (err, std::abs (block.getReadArray()[1][s] - static_cast<float> (std::sin (2.0 * 3.14159265358979 * 500.0
+                                                                                                              * n / 176400.0))));
+            }
+        }
+        expectLessThan (err, 0.015f);
+
+        expectThrows (engine.process (block.getWriteArray(), 2, blockSize, {0.5f, 0.5f}, {0.5f, 0.5f}));
+
+        engine.setInternalRate (0);                     // back at the host's
+        expect (! engine.isConvertingRate());
+        expectEquals (engine.getLatencySamples(), 0);
+    }
+
+    beginTest ("Internal rate benchmark");                                      // MAKE SURE TO BE IN RELEASE MODE
+
+    {
+        const int length {88200};                       // a 2s impulse & 512 sample blocks, as the plugin
+        const int block {512};
+        const int numBlocks {400};
+
+        Random rand {86420};
+        ado::Buffer h {2, length};
+        for (int c = 0; c < 2; ++c)
+            for (auto& s : h.channel (c))
+                s = (rand.nextFloat() * 2.0f - 1.0f) * 0.01f;
+
+        for (int rate : {192000, 176400})
+        {
+                // the plugin's plans: reblocking off at the host's rate, and
+                // zero latency a power of two under the engines' block at 44.1kHz
+            ado::MultichannelConvolution host {h}, native {h};
+            host.resampleIrOnRateChange (rate);
+            native.resampleIrOnRateChange (rate);
+            native.setInternalRate (44100);
+            native.setReblocking (ado::Convolution::Reblocking::zeroLatency, 64);
+            host.prepare (2, block);
+            native.prepare (2, block);
+
+            ado::Buffer in {2, block}, x {2, block};
+            for (int c = 0; c < 2; ++c)
+                for (auto& s : in.channel (c))
+                    s = rand.nextFloat() * 2.0f - 1.0f;
+
+                // Best of several passes each, interleaved, so both see the same machine
+            double best[2] {1.0e9, 1.0e9};
+            for (int pass = 0; pass < 5; ++pass)
+            {
+                for (bool isNative : {false, true})
+                {
+                    const int64 start = Time::getHighResolutionTicks();
+                    for (int b = 0; b < numBlocks; ++b)
+                    {
+                        for (int c = 0; c < 2; ++c)
+                            std::copy (in.getReadArray()[c], in.getReadArray()[c] + block, x.getWriteArray()[c]);
+                        (isNative ? native : host).process (x);
+                    }
+                    const double seconds = Time::highResolutionTicksToSeconds (Time::getHighResolutionTicks() - start);
+                    best[isNative] = std::min (best[isNative], seconds);
+                }
+            }
+
+            const double realtime = static_cast<double> (numBlocks) * block / rate;
+            logMessage (String (rate) + "Hz: " + String (realtime / best[0], 1) + "x realtime, at 44.1kHz "
+                        + String (realtime / best[1], 1) + "x, " + String (best[0] / best[1], 1) + " times less");
+
+            expectLessThan (best[1], best[0] * 0.5);   // resamplers & all, loosely: timings are noisy
+        }
+    }
+
+    beginTest ("set() and limits");
+
+    {
+        ado::Buffer h = randomImpulse (4, 5);
+        ado::MultichannelConvolution engine {h, 1};
+        engine.prepare (4, blockSize);
+        expectEquals (engine.getNumEngines(), 2);
+
+        const ado::Buffer h2 = randomImpulse (1, 6);
+        engine.set (h2);                                // regroups: one engine for all 4
+        expectEquals (engine.getNumEngines(), 1);
+        expectLessThan (maxError (engine, h2, 4), 1.0e-4f);
+
+        expectThrows (engine.prepare (0, blockSize));
+        expectThrows (engine.prepare (ado::MultichannelConvolution::maxChannels + 1, blockSize));
+    }
+}
+
+#endif // AIDIO_UNIT_TESTS
@@ -0,0 +1,142 @@
+/*
+  ==============================================================================
+
+    TestPartitionTuner.cpp
+    Created: 18 Oct 2026 4:12:37pm
+    Author:  John Flynn
+
+  ==============================================================================
+*/
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "../Aidio.h"
+
+//==============================================================================
+
+#if AIDIO_UNIT_TESTS
+
+AIDIO_DECLARE_UNIT_TEST_WITH_STATIC_INSTANCE(PartitionTuner)
+
+PartitionTuner::PartitionTuner() : UnitTest ("PartitionTuner") {}
+
+void PartitionTuner::runTest()
+{
+    const ado::PartitionTuner::Problem problem {256, 48000.0, 8000, 2};
+    const TemporaryFile wisdomFile {".xml"};
+
+    beginTest ("Tunes, saves & finds a plan");
+
+    {
+        ado::PartitionTuner tuner {wisdomFile.getFile()};
+        ado::PartitionTuner::Plan plan;
+        expect (! tuner.findPlan (problem, plan));
+
+        plan = tuner.getPlan (problem);
+        expect (32 <= plan.headSize && plan.headSize <= 512);
+        expect (1 <= plan.segmentBlocks && plan.segmentBlocks <= 8);
+        expectEquals (plan.maxFftSize, ado::Convolution::defaultMaxFftSize);   // impulse too short for more
+        expect (plan.meanBlockSeconds > 0.0 && plan.worstBlockSeconds >= plan.meanBlockSeconds);
+        expect (wisdomFile.getFile().existsAsFile());
+
+        ado::PartitionTuner later {wisdomFile.getFile()};   // a later session
+        ado::PartitionTuner::Plan found;
+        expect (later.findPlan (problem, found));
+        expectEquals (found.headSize, plan.headSize);
+        expectEquals (found.segmentBlocks, plan.segmentBlocks);
+        expectEquals (found.maxFftSize, plan.maxFftSize);
+        expect (found.fftBackend == plan.fftBackend);
+
+        expect (! later.findPlan ({480, 48000.0, 8000, 2}, found));
+        expect (! later.findPlan ({256, 44100.0, 8000, 2}, found));
+
+        const ado::PartitionTuner::Problem reblocked {441, 44100.0, 8000, 2,      // timed reblocked, as it
+                                                      ado::Convolution::Reblocking::zeroLatency, 256};  // will run
+        expect (! later.findPlan (reblocked, found));
+        expect (later.measure (reblocked, plan).meanBlockSeconds > 0.0);
+    }
+
+    beginTest ("Another machine's wisdom is ignored");
+
+    {
+        ScopedPointer<XmlElement> xml {XmlDocument::parse (wisdomFile.getFile())};
+        expect (xml != nullptr);
+        xml->setAttribute ("machine", "some other machine");
+        xml->writeToFile (wisdomFile.getFile(), "");
+
+        ado::PartitionTuner tuner {wisdomFile.getFile()};
+        ado::PartitionTuner::Plan found;
+        expect (! tuner.findPlan (problem, found));
+    }
+
+    beginTest ("Bad wisdom is ignored");
+
+    {
+        ado::PartitionTuner tuner {wisdomFile.getFile()};
+        tuner.getPlan (problem);
+
+        ScopedPointer<XmlElement> xml {XmlDocument::parse (wisdomFile.getFile())};
+        xml->getChildByName ("PLAN")->setAttribute ("segmentBlocks", 100);
+        xml->writeToFile (wisdomFile.getFile(), "");
+
+        ado::PartitionTuner later {wisdomFile.getFile()};
+        ado::PartitionTuner::Plan found;
+        expect (! later.findPlan (problem, found));
+    }
+
+    beginTest ("Tuned plan convolves correctly");
+
+    {
+        struct NamedFft : public ado::Convolution::FftBackend
+        {
+            const char* GetName() const override { return "named"; }
+            bool SupportsSize (int len) const override { return WDL_fft_size_supported (len) != 0; }
+            bool PrepareSize (int len) override { return WDL_fft_init_size (len) != 0; }
+            void FFT (WDL_FFT_COMPLEX* buf, int len, int isInverse) override { WDL_fft (buf, len, isInverse); }
+        };
+        NamedFft named;
+
+        ado::PartitionTuner tuner {wisdomFile.getFile()};
+        tuner.setFftBackends ({&named});
+        ado::PartitionTuner::Plan plan = tuner.getPlan (problem);
+        plan.segmentBlocks = 1;             // and a non-default plan, whatever won
+        plan.headSize = 128;
+        plan.fftBackend = "named";
+
+        Random rand {1618};
+        ado::Buffer h {2, problem.impulseLength};
+        ado::Buffer x {2, 4096};
+        for (int c = 0; c < 2; ++c)
+        {
+            for (auto& s : h.channel (c))
+                s = (rand.nextFloat() * 2.0f - 1.0f) * 0.05f;
+            for (auto& s : x.channel (c))
+                s = rand.nextFloat() * 2.0f - 1.0f;
+        }
+
+        ado::Convolution engine {h};
+        tuner.apply (plan, engine);
+        expectEquals (engine.getHeadSize(), 128);
+        expectEquals (engine.getSegmentBlocks(), 1);
+        expect (engine.getFftBackends().size() == 1);
+        engine.prepare (2, problem.blockSize);
+
+        ado::Buffer y {x};
+        float err {0.0f};
+        for (int start = 0; start < x.getNumSamples(); start += problem.blockSize)
+        {
+            float* b[2] {y.getWriteArray()[0] + start, y.getWriteArray()[1] + start};
+            engine.process (b, 2, problem.blockSize);
+        }
+        for (int c = 0; c < 2; ++c)
+            for (int n = 0; n < x.getNumSamples(); n += 11)
+            {
+                double expected {0.0};
+                for (int k = 0; k <= n; ++k)
+                    expected += static_cast<double> (h.getReadArray()[c][k]) * x.getReadArray()[c][n - k];
+                err = std::max (err, std::abs (y.getReadArray()[c][n] - static_cast<float> (expected)));
+            }
+        expectLessThan (err, 1.0e-4f);
+    }
+}
+
+#endif // AIDIO_UNIT_TESTS
@@ -86,6 +86,77 @@ void Resample::runTest()
         expectWithinAbsoluteError (33.5712f, dest6.getReadArray()[14][31], 0.001f);   // i.e. don't carry garbage
         expectWithinAbsoluteError (33.5712f, dest6.getReadArray()[5][31], 0.001f);    // from previous channel pass
     }
+
+    // A sine through a PolyphaseResampler in uneven blocks, against the sine
+    // itself at the output rate & delayed by the filter's latency
+    auto streamSine = [] (ado::PolyphaseResampler& resampler, double frequency, int numInput,
+                          std::vector<float>& output)
+    {
+        const int blockSizes[] {500, 37, 1024, 1, 313};
+        resampler.prepare (1, 1024);
+        std::vector<float> block (1024);
+        output.assign (static_cast<size_t> (resampler.getMaxOutputSamples (numInput) + 8), 0.0f);
+
+        int numOutput {0};
+        for (int start = 0, i = 0; start < numInput; ++i)
+        {
+            const int n = std::min (blockSizes[i % 5], numInput - start);
+            for (int s = 0; s < n; ++s)
+                block[static_cast<size_t> (s)] = static_cast<float> (std::sin (2.0 * 3.14159265358979 * frequency
+                                                                               * (start + s) / resampler.getFromRate()));
+            const float* in[1] {block.data()};
+            float* out[1] {output.data() + numOutput};
+            numOutput += resampler.process (in, n, out);
+            start += n;
+        }
+        output.resize (static_cast<size_t> (numOutput));
+    };
+
+    beginTest ("Polyphase 192kHz & 176.4kHz to 44.1kHz, streamed");
+
+    {
+        for (int rate : {192000, 176400})           // halvings & a 147/160, halvings alone
+        {
+            ado::PolyphaseResampler down {rate, 44100};
+            std::vector<float> y;
+
+            for (double frequency : {1000.0, 19000.0})
+            {
+                streamSine (down, frequency, rate, y);
+                expect (std::abs (static_cast<int> (y.size()) - 44100) <= 1);
+
+                float err {0.0f};
+                for (size_t n = 1000; n < y.size(); ++n)    // past the filter's start up
+                    err = std::max (err, std::abs (y[n] - static_cast<float> (std::sin (2.0 * 3.14159265358979 * frequency
+                                                                                        * (n / 44100.0 - down.getLatencySeconds())))));
+                expectLessThan (err, 1.0e-3f);
+            }
+
+            streamSine (down, 30000.0, rate, y);    // in the stopband
+            float peak {0.0f};
+            for (size_t n = 1000; n < y.size(); ++n)
+                peak = std::max (peak, std::abs (y[n]));
+            expectLessThan (peak, 1.0e-4f);
+        }
+    }
+
+    beginTest ("Polyphase 44.1kHz to 192kHz, 176.4kHz & 96kHz, streamed");
+
+    {
+        for (int rate : {192000, 176400, 96000})
+        {
+            ado::PolyphaseResampler up {44100, rate};
+            std::vector<float> y;
+            streamSine (up, 5000.0, 44100, y);
+            expect (std::abs (static_cast<int> (y.size()) - rate) <= 1);
+
+            float err {0.0f};
+            for (size_t n = 5000; n < y.size(); ++n)
+                err = std::max (err, std::abs (y[n] - static_cast<float> (std::sin (2.0 * 3.14159265358979 * 5000.0
+                                                                                    * (static_cast<double> (n) / rate - up.getLatencySeconds())))));
+            expectLessThan (err, 1.0e-3f);
+        }
+    }
 }
 
 #endif // AIDIO_UNIT_TESTS
@@ -0,0 +1,167 @@
+/*
+  ==============================================================================
+
+    TestSegmentedConvolution.cpp
+    Created: 18 Oct 2026 10:21:05pm
+    Author:  John Flynn
+
+  ==============================================================================
+*/
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "../Aidio.h"
+
+//==============================================================================
+
+#if AIDIO_UNIT_TESTS
+
+AIDIO_DECLARE_UNIT_TEST_WITH_STATIC_INSTANCE(SegmentedConvolution)
+
+SegmentedConvolution::SegmentedConvolution() : UnitTest ("SegmentedConvolution") {}
+
+void SegmentedConvolution::runTest()
+{
+    const int numChannels {2};
+    const int length {2200000};                 // a few segments of 8 warm-ups
+
+    Random rand {24680};
+    ado::Buffer h {numChannels, 3000};
+    for (int c = 0; c < numChannels; ++c)
+        for (int s = 0; s < h.getNumSamples(); ++s)
+            h.getWriteArray()[c][s] = (rand.nextFloat() * 2.0f - 1.0f) * 0.05f * std::exp (-0.002f * s);
+
+    ado::Buffer x {numChannels, length};
+    for (int c = 0; c < numChannels; ++c)
+        for (int s = 0; s < length; ++s)
+            x.getWriteArray()[c][s] = rand.nextFloat() * 2.0f - 1.0f;
+
+    const ado::Convolution::MixGains gains {0.7f, 0.5f};
+
+    auto reader = [&x, length] (float* const* dest, int numChans, juce::int64 start, int numSamples)
+    {
+        const int n = static_cast<int> (jlimit<juce::int64> (0, numSamples, length - start));
+        for (int c = 0; c < numChans && 0 < n; ++c)
+            std::copy (x.getReadArray()[c] + start, x.getReadArray()[c] + start + n, dest[c]);
+    };
+
+    // One engine from the start, as a host renders
+    auto sequential = [&] (const ado::SegmentedConvolution::Setup& setup, juce::int64 numSamples, int blockSize)
+    {
+        ado::MultichannelConvolution engine {h, 0};
+        setup (engine);
+        engine.prepare (numChannels, blockSize);
+
+        ado::Buffer y {numChannels, static_cast<int> (numSamples)};
+        ado::Buffer block {numChannels, blockSize};
+        for (juce::int64 pos = 0; pos < numSamples; pos += blockSize)
+        {
+            block.clear();
+            reader (block.getWriteArray(), numChannels, pos, blockSize);
+            engine.process (block.getWriteArray(), numChannels, blockSize, gains, gains);
+
+            const int n = static_cast<int> (std::min<juce::int64> (blockSize, numSamples - pos));
+            for (int c = 0; c < numChannels; ++c)
+                std::copy (block.getReadArray()[c], block.getReadArray()[c] + n, y.getWriteArray()[c] + pos);
+        }
+        return y;
+    };
+
+    auto segmented = [&] (ado::SegmentedConvolution& renderer, juce::int64 numSamples, int& numWrites)
+    {
+        ado::Buffer y {numChannels, static_cast<int> (numSamples)};
+        juce::int64 written {0};
+        numWrites = 0;
+
+        const bool ok = renderer.process (numSamples, gains, 4, reader,
+                                          [&] (const float* const* src, int numChans, juce::int64 start, int numSamples)
+                                          {
+                                              expectEquals (start, written);    // in order
+                                              for (int c = 0; c < numChans; ++c)
+                                                  std::copy (src[c], src[c] + numSamples, y.getWriteArray()[c] + start);
+                                              written += numSamples;
+                                              ++numWrites;
+                                              return true;
+                                          });
+        expect (ok);
+        expectEquals (written, numSamples);
+        return y;
+    };
+
+    auto countDifferences = [numChannels] (const ado::Buffer& a, const ado::Buffer& b)
+    {
+        int differences {0};
+        for (int c = 0; c < numChannels; ++c)
+            for (int s = 0; s < a.getNumSamples(); ++s)
+                differences += a.getReadArray()[c][s] != b.getReadArray()[c][s];
+        return differences;
+    };
+
+    beginTest ("Offline plan: segments equal the sequential render exactly");
+
+    {
+        const ado::SegmentedConvolution::Setup setup {[] (ado::MultichannelConvolution& engine)
+        {
+            engine.setReblocking (ado::Convolution::Reblocking::fixedLatency, 1024);
+            engine.setMaxFftSize (2 * ado::Convolution::defaultMaxFftSize);
+        }};
+        ado::SegmentedConvolution renderer {h, numChannels, 256, setup};
+        expectEquals (renderer.getLatencySamples(), 1024);
+        expectEquals (renderer.getPeriod(), 65536);
+
+        const juce::int64 numSamples = length + h.getNumSamples() + renderer.getLatencySamples();
+        expect (renderer.getSegmentSize (numSamples, 4) < numSamples);
+
+        int numWrites {0};
+        const ado::Buffer y = segmented (renderer, numSamples, numWrites);
+        expect (numWrites > 1);
+        expectEquals (countDifferences (y, sequential (setup, numSamples, 256)), 0);
+    }
+
+    beginTest ("Zero latency plan: exact too");
+
+    {
+        const ado::SegmentedConvolution::Setup setup {[] (ado::MultichannelConvolution& engine)
+        {
+            engine.setHeadSize (64);
+            engine.setSegmentBlocks (2);
+        }};
+        ado::SegmentedConvolution renderer {h, numChannels, 512, setup};
+        expectEquals (renderer.getLatencySamples(), 0);
+
+        int numWrites {0};
+        const ado::Buffer y = segmented (renderer, length, numWrites);
+        expect (numWrites > 1);
+        expectEquals (countDifferences (y, sequential (setup, length, 512)), 0);
+    }
+
+    beginTest ("Segment sizes");
+
+    {
+        expectEquals (ado::SegmentedConvolution {h, numChannels, 480, nullptr}.getPeriod(), 15 * 32768);
+
+        ado::SegmentedConvolution renderer {h, numChannels, 256, nullptr};
+        expectEquals (renderer.getWarmUpSize(), 65536);         // impulse + largest FFT, on the period
+        expectEquals (renderer.getSegmentSize (100000000, 4), static_cast<juce::int64> (ado::SegmentedConvolution::maxSegmentSize));
+        expectEquals (renderer.getSegmentSize (20000000, 4), static_cast<juce::int64> (1277952));   // a 16th, on the period
+                                                                // one job, or too short to split: the whole stream
+        expectEquals (renderer.getSegmentSize (length, 1), static_cast<juce::int64> (length / 256 + 1) * 256);
+        expectEquals (renderer.getSegmentSize (10000, 8), static_cast<juce::int64> (10240));
+    }
+
+    beginTest ("The writer can stop it");
+
+    {
+        ado::SegmentedConvolution renderer {h, numChannels, 256, nullptr};
+        int numWrites {0};
+        const bool ok = renderer.process (length, gains, 4, reader,
+                                          [&numWrites] (const float* const*, int, juce::int64, int)
+                                          {
+                                              ++numWrites;
+                                              return false;
+                                          });
+        expect (! ok);
+        expectEquals (numWrites, 1);
+    }
+}
+
+#endif // AIDIO_UNIT_TESTS
@@ -75,6 +75,16 @@ void Utility::runTest()
         x = 16300;
         expectEquals(ado::nextPowerOf2(x), 16384);
     }
+
+    beginTest("isPowerOf2()");
+
+    {
+        expect(ado::isPowerOf2(1));
+        expect(ado::isPowerOf2(16384));
+        expect(! ado::isPowerOf2(480));
+        expect(! ado::isPowerOf2(0));
+        expect(! ado::isPowerOf2(-64));
+    }
 }
 
 #endif // AIDIO_UNIT_TESTS
@@ -67,6 +67,11 @@ int nextPowerOf2 (int x);
 */
 int nextPowerOf2Order (int x);
 
+//==============================================================================
+/** True for 1, 2, 4, 8... false for zero & negatives
+*/
+bool isPowerOf2 (int x);
+
 } // namespace
 
 #endif  // UTILITY_H_INCLUDED
@@ -54,11 +54,10 @@ void bufferLoadFromAudioBinaryData (const void* binaryData,
     const int chans = gsl::narrow<int> (audioReader->numChannels);
     const int samps = gsl::narrow<int> (audioReader->lengthInSamples);
 
-    juce::AudioBuffer<float> temp {chans, samps};
-    audioReader->read (&temp, 0, samps, 0, true, true);
-
     targetBuffer.clearAndResize (chans, samps, fileSampleRate);
-    ado::rawBufferCopy (temp.getArrayOfReadPointers(), targetBuffer.getWriteArray(), chans, samps);
+
+    juce::AudioBuffer<float> target {targetBuffer.getWriteArray(), chans, samps}; // refers to, doesn't own
+    audioReader->read (&target, 0, samps, 0, true, true);                          // so reads straight in
 }
 
 //--------//--------//--------//--------//--------//--------//--------//--------
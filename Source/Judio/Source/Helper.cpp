@@ -22,6 +22,7 @@
 #include "../Helper.h"
 
 #include "../Dependencies/Aidio/Utility.h"
+#include "../Dependencies/Aidio/Kernels.h"
 
 namespace jdo
 {
@@ -42,8 +43,7 @@ float bufferSumElements (const AudioBuffer<float>& b)
     float sum {0};
 
     for (int chan = 0; chan < b.getNumChannels(); ++chan)
-        for (int samp = 0; samp < b.getNumSamples(); ++samp)
-            sum += b.getSample(chan, samp);
+        sum += ado::vectorSum (b.getReadPointer (chan), b.getNumSamples());
 
     return sum;
 }
@@ -19,6 +19,7 @@ Editor::Editor (Processor& p)
       reverbTypeSlider {*p.getParameters()[Processor::ParamNames::reverbTypeName]},
       mixSlider        {*p.getParameters()[Processor::ParamNames::mixName]},
       gainSlider       {*p.getParameters()[Processor::ParamNames::gainName]},
+      nativeRateToggle {*p.getParameters()[Processor::ParamNames::nativeRateName]},
       backgroundImage {ImageCache::getFromMemory (BinaryData::layout04NoKnobsfs8_png,
                                                   BinaryData::layout04NoKnobsfs8_pngSize)},
       versionNumberLabel {"LabelID", "v" + String {ProjectInfo::versionString}},
@@ -35,10 +36,24 @@ Editor::Editor (Processor& p)
     addAndMakeVisible (&mixSlider);
     addAndMakeVisible (&gainSlider);
 
+    for (int i = 0; i < Processor::numSends; ++i)
+    {
+        const int gainIndex = Processor::ParamNames::send1Name + 2 * i;     // gain, dry, as ParamNames
+
+        auto* slider = sendSliders.add (new jdo::SliderStep {*p.getParameters()[gainIndex]});
+        slider->setSliderStyle (Slider::SliderStyle::LinearBar);
+        slider->setVelocityBasedMode (false);
+        addAndMakeVisible (slider);
+
+        addAndMakeVisible (sendDryToggles.add (new jdo::Toggle {*p.getParameters()[gainIndex + 1]}));
+    }
+
+    addAndMakeVisible (&nativeRateToggle);
+
     versionNumberLabel.setColour (Label::textColourId, Colour {0xff575757});
     addAndMakeVisible (&versionNumberLabel);
 
-    setSize (550, 500); // remember to set before xtor finished
+    setSize (550, backgroundHeight + stripHeight); // remember to set before xtor finished
 }
 
 Editor::~Editor()
@@ -48,9 +63,12 @@ Editor::~Editor()
 //==============================================================================
 void Editor::paint (Graphics& g)
 {
-    g.drawImage (backgroundImage, 0, 0, 1000, 500,  // xPos, yPos, xSize, ySize
+    g.drawImage (backgroundImage, 0, 0, 1000, backgroundHeight,  // xPos, yPos, xSize, ySize
                                   0, 0, 2000, 1000);
 
+    g.setColour (Colour {0xff202020});
+    g.fillRect (0, backgroundHeight, getWidth(), stripHeight);
+
     versionNumberLabel.setBounds(213, 34, 100, 10);
 }
 
@@ -66,4 +84,14 @@ void Editor::resized()
     bypassToggle.setBounds (466, 9,
                             jdo::CustomLook::buttonWidth + 16,
                             jdo::CustomLook::buttonLargeHeight + 8);
+
+        // toggles draw inset by 8 each side
+    for (int i = 0; i < Processor::numSends; ++i)
+    {
+        const int x = 24 + i * 138;
+        sendSliders   [i]->setBounds (x,           backgroundHeight + 9, 64,      jdo::CustomLook::buttonHeight);
+        sendDryToggles[i]->setBounds (x + 66 - 8,  backgroundHeight + 1, 64 + 16, jdo::CustomLook::buttonHeight + 16);
+    }
+
+    nativeRateToggle.setBounds (438, backgroundHeight + 1, 88 + 16, jdo::CustomLook::buttonHeight + 16);
 }
@@ -39,7 +39,13 @@ private:
     jdo::SliderStep mixSlider;
     jdo::SliderStep gainSlider;
 
+    OwnedArray<jdo::SliderStep> sendSliders;    // a gain & dry switch per send
+    OwnedArray<jdo::Toggle> sendDryToggles;
+    jdo::Toggle nativeRateToggle;
+
     Image backgroundImage;
+    static const int backgroundHeight {500};
+    static const int stripHeight      {40};     // below the background, for the sends & the engine's settings
 
     Label versionNumberLabel;
 
@@ -13,17 +13,21 @@
 
 //==============================================================================
 Processor::Processor()
+     :
 #ifndef JucePlugin_PreferredChannelConfigurations
-     : AudioProcessor (BusesProperties()                // Note position of ':' relies on this define!!!
+       AudioProcessor (BusesProperties()
                      #if ! JucePlugin_IsMidiEffect
                       #if ! JucePlugin_IsSynth
                        .withInput  ("Input",  AudioChannelSet::stereo(), true)
+                       .withInput  ("Send 1", AudioChannelSet::stereo(), false)   // numSends
+                       .withInput  ("Send 2", AudioChannelSet::stereo(), false)
+                       .withInput  ("Send 3", AudioChannelSet::stereo(), false)
                       #endif
                        .withOutput ("Output", AudioChannelSet::stereo(), true)
                      #endif
                        ),
 #endif
-    : stateAB {getParametersForWriting()},
+      stateAB {getParametersForWriting()},
       statePresets {getParametersForWriting(), "BalanceAudioTools/SPTeufelsbergReverb/presets.xml"},
                                          // ID            Name       Suffix          Min      Max     Def nSteps   skew broadcastParam
       bypassParam     {new jdo::ParamStep {"bypassID",   "Bypass",       "",    0.0f,     1.0f,   0.0f,    1        }},
@@ -32,7 +36,9 @@ Processor::Processor()
       gainParam       {new jdo::ParamStep {"gainID",     "Gain",       "dB",  -18.0f,    18.0f,   0.0f,   72        }},
       ir {1, 1},
       engine {ir},
-      impulseLoaderAsync {engine, ir}
+      impulseLoaderAsync {engine, ir, *this},
+      tuner {File::getSpecialLocation (File::userApplicationDataDirectory)
+                 .getChildFile ("BalanceAudioTools/SPTeufelsbergReverb/convolution-wisdom.xml")}
 {
         // Set look here not in editor.
         // Needs to be set before editor's member variables are initialised     // better way?
@@ -45,7 +51,22 @@ Processor::Processor()
     addParameter (mixParam);
     addParameter (gainParam);
 
+    for (int i = 0; i < numSends; ++i)  // after gain, as ParamNames
+    {
+        const String number {i + 1};
+        sendParams[i]    = new jdo::ParamStep {"send" + number + "ID",    "Send " + number,          "dB", minSendDecibels, 6.0f, 0.0f, 54};
+        sendDryParams[i] = new jdo::ParamStep {"send" + number + "DryID", "Send " + number + " Dry", "",    0.0f,           1.0f, 0.0f,  1};
+        addParameter (sendParams[i]);
+        addParameter (sendDryParams[i]);
+    }
+
+    nativeRateParam = new jdo::ParamStep {"nativeRateID", "Native Rate", "", 0.0f, 1.0f, 0.0f, 1};
+    addParameter (nativeRateParam);     // after the sends, as ParamNames
+
+    engine.setMemoryLocking (true);     // keep IR spectra & histories resident once prepared
     impulseLoaderAsync.changeImpulseNow (1);
+
+    startTimer (500);                   // see timerCallback()
 }
 
 Processor::~Processor()
@@ -111,8 +132,70 @@ void Processor::prepareToPlay (double sampleRate, int samplesPerBlock)
     // Use this method as the place to do any pre-playback
     // initialisation that you need..
 
+    const bool nativeRate = *nativeRateParam >= 0.5f && sampleRate >= 2.0 * ir.getSampleRate();
+    engine.setInternalRate (nativeRate ? ir.getSampleRate() : 0);
     engine.resampleIrOnRateChange (sampleRate);
-    dryBuffer.setSize (2, samplesPerBlock * 2); // extra safety size
+    engine.setTopology (getTopology());
+
+    const double engineRate = engine.isConvertingRate() ? ir.getSampleRate() : sampleRate;
+    const int engineBlockSize = static_cast<int> (std::ceil (samplesPerBlock * engineRate / sampleRate));
+
+    const int numChannels = jmax (getMainBusNumInputChannels(), getMainBusNumOutputChannels());
+    const int irLength = roundToInt (ir.getNumSamples() * engineRate / ir.getSampleRate());
+    realtimeProblem = {engineBlockSize, engineRate, irLength, jmin (2, numChannels)};
+
+    if (! ado::Convolution::partitionsMatchBlockSize (engineBlockSize)     // 441, 1000, ...: run the tail
+        || engine.isConvertingRate())                                       // on even quanta (resampled
+    {                                                                       // blocks vary)
+        realtimeProblem.reblocking = ado::Convolution::Reblocking::zeroLatency;
+        realtimeProblem.reblockQuantum = jlimit (32, 4096, nextPowerOfTwo (engineBlockSize) / 2);
+    }
+
+    preparedBlockSize = samplesPerBlock;
+    configureEngine (isNonRealtime());
+
+   #if JUCE_DEBUG
+    const ado::MemoryLockReport& report = engine.getMemoryLockReport();
+    DBG ("Convolution memory: " << (int64) report.bytesTouched << " bytes prefaulted, "
+         << (int64) report.bytesLocked << " locked" << (report.lockFailed ? " (lock failed)" : ""));
+   #endif
+
+    lastGains = getTargetGains();       // no ramp on the first block
+    for (int i = 0; i < numSends; ++i)
+        lastSendGains[i] = getTargetSendGain (i);
+}
+
+void Processor::configureEngine (bool nonRealtime)
+{
+    if (nonRealtime)                    // bouncing: throughput over latency
+    {
+        ReverbSettings::applyOfflinePlan (engine);
+    }
+    else                                // timed the first time for this setup (as it will run,
+    {                                   // reblocked or not), then from wisdom: never offline
+        engine.setReblocking (realtimeProblem.reblocking, realtimeProblem.reblockQuantum);
+        tuner.apply (tuner.getPlan (realtimeProblem), engine);
+    }
+
+    const int numChannels = jmax (getMainBusNumInputChannels(), getMainBusNumOutputChannels());
+    engine.prepare (numChannels, preparedBlockSize);    // allocate & prefault engine memory now, not in processBlock
+    preparedNonRealtime = nonRealtime;
+    modeChangeFlagged = false;
+
+    setLatencySamples (engine.getLatencySamples());     // offline the host compensates the lookahead
+
+    const int numInputs = jmax (1, getMainBusNumInputChannels());
+    const int latency = jmax (1, engine.getLatencySamples());
+    if (isUsingDoublePrecision())       // only the precision the host runs at
+        sendDryDouble.prepare (numInputs, preparedBlockSize, latency);
+    else
+        sendDry.prepare (numInputs, preparedBlockSize, latency);
+}
+
+void Processor::timerCallback()
+{
+    if (modeChangePending.exchange (false))
+        updateHostDisplay();            // (VST3) restarts the plugin, with its latency
 }
 
 void Processor::releaseResources()
@@ -128,16 +211,26 @@ bool Processor::isBusesLayoutSupported (const BusesLayout& layouts) const
     ignoreUnused (layouts);
     return true;
   #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    if (layouts.getMainOutputChannelSet() != AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != AudioChannelSet::stereo())
+    const AudioChannelSet& out = layouts.getMainOutputChannelSet();
+    const AudioChannelSet& in  = layouts.getMainInputChannelSet();
+
+    // Any width the engine can split into groups: mono, stereo, surround & ambisonic
+    if (out.isDisabled() || out.size() > ado::MultichannelConvolution::maxChannels)
         return false;
 
-    // This checks if the input layout matches the output layout
    #if ! JucePlugin_IsSynth
-    if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
+    // Input must match output, except mono in to stereo out
+    if (in != out
+        && ! (in == AudioChannelSet::mono() && out == AudioChannelSet::stereo()))
         return false;
+
+    // Sends: off, mono (to every input channel) or as the input
+    for (int i = 1; i < layouts.inputBuses.size(); ++i)
+    {
+        const AudioChannelSet& send = layouts.inputBuses.getReference (i);
+        if (! send.isDisabled() && send != AudioChannelSet::mono() && send != in)
+            return false;
+    }
    #endif
 
     return true;
@@ -146,11 +239,21 @@ bool Processor::isBusesLayoutSupported (const BusesLayout& layouts) const
 #endif
 
 void Processor::processBlock (AudioSampleBuffer& buffer, MidiBuffer& /*midiMessages*/) noexcept
+{
+    process (buffer);
+}
+
+void Processor::processBlock (AudioBuffer<double>& buffer, MidiBuffer& /*midiMessages*/) noexcept
+{
+    process (buffer);                   // the engine converts, the dry & gains stay double
+}
+
+template <typename FloatType>
+void Processor::process (AudioBuffer<FloatType>& buffer) noexcept
 {
     const int totalNumInputChannels  = getTotalNumInputChannels();
     const int totalNumOutputChannels = getTotalNumOutputChannels();
 
-    const int bufferNumChannels = buffer.getNumChannels();
     const int bufferNumSamples  = buffer.getNumSamples();
 
     // In case we have more outputs than inputs, this code clears any output
@@ -165,46 +268,175 @@ void Processor::processBlock (AudioSampleBuffer& buffer, MidiBuffer& /*midiMessa
     // This is the place where you'd normally do the guts of your plugin's
     // audio processing...
 
-    {
-        bool isMonoToStereo = getTotalNumInputChannels()  == 1
-                           && getTotalNumOutputChannels() == 2;
-        if (isMonoToStereo)
-            buffer.copyFrom(1, 0, buffer,               // dest chan, offset, buff
-                            0, 0, bufferNumSamples);    //  src chan, offset, size
-    }
-
     bool bypassed = *bypassParam >= 0.5f;
 
     const int newImpulse = static_cast<int> (*reverbTypeParam);
     impulseLoaderAsync.changeImpulseAsync (newImpulse);
 
     const bool impulseIsChanging {impulseLoaderAsync.isNowChanging()};  // lower gain on IR change
+
+    if (isNonRealtime() != preparedNonRealtime && ! modeChangeFlagged)  // hosts that only say so here
+    {                                                                   // (VST3): reconfigured off the
+        modeChangeFlagged = true;                                       // audio thread, from the next
+        modeChangePending = true;                                       // prepareToPlay()
+    }
+
+    const bool delaysDry = getLatencySamples() > 0; // offline lookahead & native rate: bypass and an
+                                                    // impulse change must be delayed too
     if (impulseIsChanging && ! bypassed)                                // (but not when bypassed)
         buffer.applyGain (0.25f);
 
-    if (bypassed || impulseIsChanging) // don't process a changing ir
+    if ((bypassed || impulseIsChanging) && ! delaysDry)
     {
-        // bypass
+        if (isMonoToStereo())           // the engine reads mono input itself, dry needs a copy
+            buffer.copyFrom(1, 0, buffer,               // dest chan, offset, buff
+                            0, 0, bufferNumSamples);    //  src chan, offset, size
+
+        lastGains = getTargetGains();   // bypass, and resume without a ramp
+        for (int i = 0; i < numSends; ++i)
+            lastSendGains[i] = getTargetSendGain (i);
     }
     else
     {
-        const float gainLin = Decibels::decibelsToGain<float> (*gainParam);
-        const float mix = *mixParam / 100.0f; // range 0-1
+        const ado::Convolution::MixGains gains {bypassed || impulseIsChanging ? ado::Convolution::MixGains {0.0f, 1.0f}
+                                                                              : getTargetGains()};
+
+        const int numChannels = jmax (getMainBusNumInputChannels(), getMainBusNumOutputChannels());
+
+            // Past prepareToPlay()'s block size in chunks of it, the dry sum's length
+            // (as the engine does), rather than allocating here
+        for (int start = 0; start < bufferNumSamples; start += preparedBlockSize)
+        {
+            const int numSamples = jmin (preparedBlockSize, bufferNumSamples - start);
+            AudioBuffer<FloatType> chunk {buffer.getArrayOfWritePointers(), buffer.getNumChannels(),
+                                          start, numSamples};   // refers to buffer, no allocation
+            FloatType** channels = chunk.getArrayOfWritePointers();
+
+            if (! addSends (chunk, bypassed || impulseIsChanging, numSamples))
+            {
+                engine.process (channels,                               // convolve, mix dry & apply
+                                numChannels,                            // gain in one pass, ramped
+                                numSamples,                             // from last block's values
+                                lastGains, gains);
+            }
+            else                                                        // wet only, then the dry sum
+            {
+                if (! impulseIsChanging)        // don't process a changing ir: no wet, the dry still delayed
+                    engine.process (channels, numChannels, numSamples,
+                                    {lastGains.wet, 0.0f}, {gains.wet, 0.0f});
+
+                SendDry<FloatType>& dry = getSendDry (FloatType());
+                if (delaysDry)
+                    delaySendDry (dry, numSamples);
+
+                const float wet {impulseIsChanging ? 0.0f : 1.0f};
+                for (int c = 0; c < getMainBusNumOutputChannels(); ++c)
+                    ado::vectorMixRamped (channels[c], wet, wet,
+                                          dry.sum.getReadPointer (c % dry.sum.getNumChannels()), lastGains.dry, gains.dry,
+                                          channels[c], numSamples);
+            }
+            lastGains = gains;
+        }
+    }
+}
+
+ado::Convolution::MixGains Processor::getTargetGains() const noexcept
+{
+    return ReverbSettings::getMixGains (*mixParam, *gainParam);
+}
 
-        dryBuffer.makeCopyOf (buffer, true);                            // copy dry buffer
+float Processor::getTargetSendGain (int send) const noexcept
+{
+    return getChannelCountOfBus (true, send + 1) > 0 ? Decibels::decibelsToGain (sendParams[send]->get(), minSendDecibels)
+                                                     : 0.0f;
+}
 
-        engine.process (buffer.getArrayOfWritePointers(),               // convolve buffer
-                        bufferNumChannels,
-                        bufferNumSamples);
-        buffer.applyGain (mix);
+template <typename FloatType>
+bool Processor::addSends (AudioBuffer<FloatType>& buffer, bool bypassed, int numSamples) noexcept
+{
+    FloatType** channels = buffer.getArrayOfWritePointers();
+    AudioBuffer<FloatType>& drySum = getSendDry (FloatType()).sum;
+    const int numInputs = getMainBusNumInputChannels();
 
-        for (int chan = 0; chan < bufferNumChannels; ++chan)            // mix back dry
-            buffer.addFrom (chan, 0, dryBuffer,
-                            chan, 0, dryBuffer.getNumSamples(),
-                            1.0f - mix);
+    std::array<float, numSends> gains {};
+    bool anySending {false};
+    bool anyDryOff {false};
 
-        buffer.applyGain (gainLin);                                     // apply gain from param
+    for (int i = 0; i < numSends; ++i)
+    {
+        gains[i] = bypassed ? 0.0f : getTargetSendGain (i);
+        if (gains[i] > 0.0f || lastSendGains[i] > 0.0f)
+        {
+            anySending = true;
+            anyDryOff |= *sendDryParams[i] < 0.5f;
+        }
+    }
+
+        // With latency (offline, or at the native rate) the dry sum is always separate,
+        // so its delay line runs continuously, through impulse changes too (the
+        // engine isn't run then). The engine's own delayed dry isn't used
+    const bool separateDry {anyDryOff || getLatencySamples() > 0};
+    if (! anySending && ! separateDry)
+    {
+        lastSendGains = gains;
+        return false;
     }
+
+    jassert (! separateDry || drySum.getNumSamples() >= numSamples);  // process() chunks to the prepared size
+
+        // Sends with their dry on, a copy of the dry sum if it's separate, then the others
+    for (bool dryOn : {true, false})
+    {
+        if (! dryOn && separateDry)
+            for (int c = 0; c < numInputs; ++c)
+                ado::vectorCopy (channels[c], drySum.getWritePointer (c), numSamples);
+
+        for (int i = 0; i < numSends; ++i)
+        {
+            if ((gains[i] > 0.0f || lastSendGains[i] > 0.0f) && (*sendDryParams[i] >= 0.5f) == dryOn)
+            {
+                const int numSendChannels = getChannelCountOfBus (true, i + 1);
+                for (int c = 0; c < numInputs; ++c)
+                    ado::vectorMixRamped (channels[c], 1.0f, 1.0f,
+                                          channels[getChannelIndexInProcessBlockBuffer (true, i + 1, c % numSendChannels)],
+                                          lastSendGains[i], gains[i],
+                                          channels[c], numSamples);
+            }
+        }
+    }
+
+    lastSendGains = gains;
+    return separateDry;
+}
+
+template <typename FloatType>
+void Processor::delaySendDry (SendDry<FloatType>& dry, int numSamples) noexcept
+{
+    const int latency = dry.delay.getNumSamples();
+
+    for (int pos = 0; pos < numSamples; )       // swapped through the ring: out a latency old, in for later
+    {
+        const int n = jmin (numSamples - pos, latency - dry.delayPos);
+        for (int c = 0; c < dry.sum.getNumChannels(); ++c)
+            std::swap_ranges (dry.sum.getWritePointer (c) + pos, dry.sum.getWritePointer (c) + pos + n,
+                              dry.delay.getWritePointer (c) + dry.delayPos);
+
+        pos += n;
+        dry.delayPos = (dry.delayPos + n) % latency;
+    }
+}
+
+bool Processor::isMonoToStereo() const noexcept
+{
+    return getMainBusNumInputChannels()  == 1
+        && getMainBusNumOutputChannels() == 2;
+}
+
+ado::Convolution::Topology Processor::getTopology() const noexcept
+{
+    return ReverbSettings::getTopology (getMainBusNumInputChannels(),
+                                        getMainBusNumOutputChannels(),
+                                        ir.getNumChannels());
 }
 
 //==============================================================================
@@ -11,14 +11,19 @@
 #ifndef PLUGINPROCESSOR_H_INCLUDED
 #define PLUGINPROCESSOR_H_INCLUDED
 
+#include <array>
+#include <atomic>
+
 #include "../JuceLibraryCode/JuceHeader.h"
 #include "Judio/Judio.h"
 #include "ImpulseLoaderAsync.h"
+#include "ReverbSettings.h"
 
 //==============================================================================
 /**
 */
-class Processor  : public AudioProcessor
+class Processor  : public AudioProcessor,
+                   private Timer
 {
 public:
     //==============================================================================
@@ -34,6 +39,8 @@ public:
    #endif
 
     void processBlock (AudioSampleBuffer&, MidiBuffer&) noexcept override;
+    void processBlock (AudioBuffer<double>&, MidiBuffer&) noexcept override;
+    bool supportsDoublePrecisionProcessing() const override { return true; }
 
     //==============================================================================
     AudioProcessorEditor* createEditor() override;
@@ -70,9 +77,25 @@ public:
         bypassName,                             // in the plugin editor's constructor
         reverbTypeName,                         // NOTE: MUST be same order as below
         mixName,
-        gainName
+        gainName,
+        send1Name,                              // then a gain & dry switch per send,
+        send1DryName,                           // as numSends
+        send2Name,
+        send2DryName,
+        send3Name,
+        send3DryName,
+        nativeRateName
     };
 
+    /** Auxiliary input buses after the main input, off until the host enables
+        them: each is added to the main input at its send gain and convolved
+        with it, so N instances sharing an impulse cost one convolution. Each
+        send's dry signal passes through with the main input's if its dry
+        switch is on, otherwise the send is wet only (as a return).
+    */
+    static constexpr int numSends {3};
+    static constexpr float minSendDecibels {-48.0f};    // send gain at the minimum is off
+
 private:
     //==============================================================================
     jdo::CustomLook look;
@@ -81,13 +104,79 @@ private:
     jdo::ParamStep* reverbTypeParam;            // managedParameters OwnedArray
     jdo::ParamStep* mixParam;                   // owns and manages. (See xtor.)
     jdo::ParamStep* gainParam;
+    std::array<jdo::ParamStep*, numSends> sendParams;
+    std::array<jdo::ParamStep*, numSends> sendDryParams;
+
+    /** Native Rate on: at host rates of twice the impulses' (44.1kHz) or more
+        the wet path runs at the impulses' rate, resampled down & back up
+        around the engine (see ado::MultichannelConvolution::setInternalRate()).
+        The FFTs, histories, spectra & work shrink by the ratio; the half-band
+        resamplers take some of it back, leaving the wet path about 3.5x cheaper
+        at 176.4kHz & 192kHz (Aidio's "Internal rate benchmark" test). Their
+        delay is reported as latency & the dry delayed to match.
+        Applies from the next prepareToPlay(), as retuning the engine is too
+        slow for the audio thread.
+    */
+    jdo::ParamStep* nativeRateParam;
 
     ado::Buffer ir;
-    ado::Convolution engine;
+    ado::MultichannelConvolution engine;
 
     ImpulseLoaderAsync impulseLoaderAsync;
+    ado::PartitionTuner tuner;                  // engine partition plans, tuned once per machine
+    ado::PartitionTuner::Problem realtimeProblem {512, 44100.0, 1, 2};     // at the engine's rate, as prepared
+    int preparedBlockSize {512};
+    bool preparedNonRealtime {false};
+
+    void configureEngine (bool nonRealtime);    // see ReverbSettings::applyOfflinePlan()
+
+    /** Hosts that only say a render is offline in processBlock() (VST3): the
+        plan & latency stay as prepared for that render, as the host compensated
+        them, and the audio thread just flags the switch. The timer then asks
+        the host to restart the plugin, so the next prepareToPlay() applies it.
+    */
+    bool modeChangeFlagged {false};             // audio thread only, once per prepare
+    std::atomic<bool> modeChangePending {false};
+    void timerCallback() override;
+
+    ado::Convolution::MixGains lastGains {0.5f, 0.5f};  // ramp start for next block
+    ado::Convolution::MixGains getTargetGains() const noexcept;
+
+    /** Float or double, as the host: the engine runs in float either way
+        (see ado::MultichannelConvolution's mixed precision process()), the
+        dry, sends & gains at the host's precision.
+    */
+    template <typename FloatType>
+    void process (AudioBuffer<FloatType>& buffer) noexcept;
+
+    template <typename FloatType>
+    struct SendDry
+    {
+        AudioBuffer<FloatType> sum;                     // the dry sum, while a send's dry is off or with latency
+        AudioBuffer<FloatType> delay;                   // by the engine's latency, as its own dry
+        int delayPos {0};
+
+        void prepare (int numChannels, int maxBlockSize, int latency)
+        {
+            sum.setSize (numChannels, maxBlockSize);
+            delay.setSize (numChannels, latency);
+            delay.clear();
+            delayPos = 0;
+        }
+    };
 
-    AudioBuffer<float> dryBuffer;
+    std::array<float, numSends> lastSendGains {};       // as lastGains
+    SendDry<float> sendDry;
+    SendDry<double> sendDryDouble;
+    SendDry<float>& getSendDry (float) noexcept { return sendDry; }
+    SendDry<double>& getSendDry (double) noexcept { return sendDryDouble; }
+    float getTargetSendGain (int send) const noexcept;
+    template <typename FloatType>
+    bool addSends (AudioBuffer<FloatType>& buffer, bool bypassed, int numSamples) noexcept;
+    template <typename FloatType>
+    void delaySendDry (SendDry<FloatType>& dry, int numSamples) noexcept;
+    bool isMonoToStereo() const noexcept;
+    ado::Convolution::Topology getTopology() const noexcept;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Processor)
 };
@@ -0,0 +1,84 @@
+/*
+  ==============================================================================
+
+    ReverbSettings.h
+    Created: 18 Oct 2026 6:02:11pm
+    Author:  John Flynn
+
+  ==============================================================================
+*/
+
+#ifndef REVERBSETTINGS_H_INCLUDED
+#define REVERBSETTINGS_H_INCLUDED
+
+#include "Judio/Helper.h"
+#include "Judio/Dependencies/Aidio/MultichannelConvolution.h"
+
+//==============================================================================
+/** What the plugin & the tools (Tools/BatchRender, Tools/RenderDaemon) agree on
+    to render identically: the impulses, how the mix & gain parameters become
+    wet & dry gains, the engine topology and the offline partition plan.
+
+    Header only, each project has its own BinaryData & JuceHeader.h.
+*/
+namespace ReverbSettings
+{
+
+constexpr int numImpulses {6};
+
+/** Loads impulse 1-6 from the project's BinaryData, at its native 44.1kHz. */
+inline void loadImpulse (int number, ado::Buffer& ir)
+{
+    jassert (1 <= number && number <= numImpulses);
+
+    const String name {"balancemasteringteufelsbergIR0" + String (number) + "4410024bit_flac"};
+    int size {0};
+    const char* data {BinaryData::getNamedResource (name.toRawUTF8(), size)};
+    jassert (data != nullptr);
+
+    jdo::bufferLoadFromAudioBinaryData<FlacAudioFormat> (data, static_cast<size_t> (size), ir, 44100);
+}
+
+/** Mix 0-100%, gain in dB, as the plugin's parameters. */
+inline ado::Convolution::MixGains getMixGains (float mixPercent, float gainDecibels) noexcept
+{
+    const float gainLin = Decibels::decibelsToGain<float> (gainDecibels);
+    const float mix = mixPercent / 100.0f; // range 0-1
+
+    return {gainLin * mix, gainLin * (1.0f - mix)};
+}
+
+inline ado::Convolution::Topology getTopology (int numInputs, int numOutputs, int irNumChannels) noexcept
+{
+    using Topology = ado::Convolution::Topology;
+
+    if (numInputs == 1 && numOutputs == 2)                  // mono in: channel 0 FFT'd once for both
+        return Topology::monoInput;
+
+    if (irNumChannels == 4                                  // 4 channel capture: LL, LR, RL, RR
+        && numInputs  == 2
+        && numOutputs == 2)
+        return Topology::trueStereo;
+
+    return Topology::matched;
+}
+
+/** Offline renders run a quantum of lookahead (reported as latency, so the
+    host keeps them aligned with playback) with the whole impulse in large
+    partitions, 2-4x the throughput of the zero latency playback plan. The
+    same on every machine, unlike the tuned playback plans.
+*/
+constexpr int offlineQuantum {16384};
+
+inline void applyOfflinePlan (ado::MultichannelConvolution& engine)
+{
+    engine.setReblocking (ado::Convolution::Reblocking::fixedLatency, offlineQuantum);
+    engine.setMaxFftSize (2 * ado::Convolution::defaultMaxFftSize);
+    engine.setSegmentBlocks (ado::Convolution::defaultSegmentBlocks);
+    engine.setLoadBalancing (false);
+    engine.setFftBackends ({});
+}
+
+} // namespace ReverbSettings
+
+#endif  // REVERBSETTINGS_H_INCLUDED
@@ -0,0 +1,212 @@
+/*
+  ==============================================================================
+
+    BatchRenderer.cpp
+    Created: 18 Oct 2026 6:40:52pm
+    Author:  John Flynn
+
+  ==============================================================================
+*/
+
+#include "BatchRenderer.h"
+
+namespace
+{
+
+class RenderJob  : public ThreadPoolJob
+{
+public:
+    RenderJob (BatchRenderer& r, const File& f, int jobs, BatchRenderer::Result& res, std::function<void()> done)
+        : ThreadPoolJob {f.getFileName()},
+          renderer (r),
+          input {f},
+          numJobs {jobs},
+          result (res),
+          onDone {done}
+    {
+    }
+
+    JobStatus runJob() override
+    {
+        result = renderer.render (input, numJobs);
+        onDone();
+        return jobHasFinished;
+    }
+
+private:
+    BatchRenderer& renderer;
+    const File input;
+    const int numJobs;
+    BatchRenderer::Result& result;
+    std::function<void()> onDone;
+};
+
+} // namespace
+
+//==============================================================================
+BatchRenderer::BatchRenderer (const Settings& settingsToUse)
+    : settings (settingsToUse)
+{
+    jassert (1 <= settings.impulse && settings.impulse <= ReverbSettings::numImpulses);
+    jassert (0 < settings.blockSize);
+
+    formats.registerBasicFormats();             // WAV, AIFF, FLAC...
+    ReverbSettings::loadImpulse (settings.impulse, impulse);
+}
+
+std::vector<BatchRenderer::Result> BatchRenderer::run (const Array<File>& inputs, int numJobs,
+                                                       std::function<void (const Result&)> onFileDone)
+{
+    std::vector<Result> results (static_cast<size_t> (inputs.size()));
+    std::mutex doneLock;
+
+        // A file per job, and jobs to spare split between the files, which
+        // share them out in segments (long files, see ado::SegmentedConvolution)
+    const int numFilesAtOnce = jlimit (1, jmax (1, numJobs), inputs.size());
+    const int jobsPerFile = jmax (1, numJobs / numFilesAtOnce);
+
+    ThreadPool pool {numFilesAtOnce};
+    for (int i = 0; i < inputs.size(); ++i)
+    {
+        Result& result = results[static_cast<size_t> (i)];
+        pool.addJob (new RenderJob {*this, inputs[i], jobsPerFile, result, [&result, &doneLock, &onFileDone]
+                                    {
+                                        std::lock_guard<std::mutex> guard {doneLock};
+                                        if (onFileDone)
+                                            onFileDone (result);
+                                    }},
+                     true);             // pool deletes it
+    }
+
+    while (pool.getNumJobs() > 0)
+        Thread::sleep (20);
+
+    return results;
+}
+
+BatchRenderer::Result BatchRenderer::render (const File& input, int numJobs)
+{
+    const double startTime = Time::getMillisecondCounterHiRes();
+
+    Result result;
+    result.input = input;
+    result.output = getOutputFile (input);
+
+    ScopedPointer<AudioFormatReader> reader {formats.createReaderFor (input)};
+    if (reader == nullptr)
+    {
+        result.error = input.existsAsFile() ? "not an audio file this can read" : "no such file";
+        return result;
+    }
+
+    const int numInputs = static_cast<int> (reader->numChannels);
+    const int numOutputs = numInputs == 1 ? 2 : numInputs;     // mono: as the plugin on a mono track
+    const int sampleRate = roundToInt (reader->sampleRate);
+
+    if (numOutputs > ado::MultichannelConvolution::maxChannels)
+    {
+        result.error = String (numInputs) + " channels, the most is " + String (ado::MultichannelConvolution::maxChannels);
+        return result;
+    }
+    if (result.output == input)
+    {
+        result.error = "the output would overwrite the input";
+        return result;
+    }
+
+    AudioFormat* const format {formats.findFormatForFileExtension (settings.outputFormat)};
+    result.output.deleteFile();
+    ScopedPointer<FileOutputStream> stream {result.output.createOutputStream()};
+    ScopedPointer<AudioFormatWriter> writer;
+    if (format != nullptr && stream != nullptr)
+        writer = format->createWriterFor (stream, reader->sampleRate, static_cast<unsigned int> (numOutputs),
+                                          settings.bitsPerSample, reader->metadataValues, 0);
+    if (writer == nullptr)
+    {
+        result.error = "can't write " + settings.outputFormat + " (" + String (numOutputs) + " channels, "
+                     + String (settings.bitsPerSample) + " bit) to " + result.output.getFullPathName();
+        return result;
+    }
+    stream.release();                           // writer owns it
+
+        // Set up as Processor::prepareToPlay() does for an offline render
+    const std::shared_ptr<const ado::Buffer> ir {getImpulse (sampleRate)};
+    const ado::Convolution::Topology topology {ReverbSettings::getTopology (numInputs, numOutputs, ir->getNumChannels())};
+
+    ado::SegmentedConvolution renderer {*ir, numOutputs, settings.blockSize, [sampleRate, topology] (ado::MultichannelConvolution& engine)
+    {
+        engine.resampleIrOnRateChange (sampleRate);     // already is, shared
+        engine.setTopology (topology);
+        ReverbSettings::applyOfflinePlan (engine);
+    }};
+
+    const ado::Convolution::MixGains gains {ReverbSettings::getMixGains (settings.mixPercent,
+                                                                         settings.gainDecibels)};
+
+        // The host drops the plugin's latency (compensating the lookahead) and
+        // feeds silence past the end to flush it, so does this
+    const int64 inputLength = reader->lengthInSamples;
+    const int64 outputLength = inputLength + (settings.addTail ? ir->getNumSamples() : 0);
+    const int latency = renderer.getLatencySamples();
+
+    auto read = [&reader, inputLength, numInputs] (float* const* dest, int numChannels, int64 start, int numSamples)
+    {
+        const int numToRead = static_cast<int> (jlimit<int64> (0, numSamples, inputLength - start));
+        if (numToRead > 0)
+        {
+            AudioSampleBuffer block {dest, numChannels, numSamples};
+            reader->read (&block, 0, numToRead, start, true, true);
+
+            for (int c = numInputs; c < numChannels; ++c)   // as processBlock(), outputs without inputs
+                block.clear (c, 0, numSamples);
+        }
+    };
+
+    auto write = [&writer, latency] (const float* const* source, int numChannels, int64 start, int numSamples)
+    {
+        const int from = static_cast<int> (jlimit<int64> (0, numSamples, latency - start));
+        const float* channels[ado::MultichannelConvolution::maxChannels];
+        for (int c = 0; c < numChannels; ++c)
+            channels[c] = source[c] + from;
+
+        return from == numSamples || writer->writeFromFloatArrays (channels, numChannels, numSamples - from);
+    };
+
+    const int64 numSamples = outputLength + latency;
+    const int64 segmentSize = renderer.getSegmentSize (numSamples, numJobs);
+    result.numSegments = static_cast<int> ((numSamples + segmentSize - 1) / segmentSize);
+
+    if (! renderer.process (numSamples, gains, numJobs, read, write))
+    {
+        result.error = "write failed, disk full?";
+        return result;
+    }
+
+    result.audioSeconds = outputLength / reader->sampleRate;
+    result.renderSeconds = (Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+    return result;
+}
+
+File BatchRenderer::getOutputFile (const File& input) const
+{
+    const File directory {settings.outputDirectory == File() ? input.getParentDirectory()
+                                                             : settings.outputDirectory};
+
+    return directory.getChildFile (input.getFileNameWithoutExtension()
+                                   + " (Teufelsberg " + String (settings.impulse) + ")"
+                                   + settings.outputFormat);
+}
+
+//==============================================================================
+//private:
+
+std::shared_ptr<const ado::Buffer> BatchRenderer::getImpulse (int sampleRate)
+{
+    std::lock_guard<std::mutex> guard {impulsesLock};
+
+    std::shared_ptr<const ado::Buffer>& found = impulses[sampleRate];
+    if (found == nullptr)
+        found = std::make_shared<const ado::Buffer> (ado::Convolution::resampleImpulse (impulse, sampleRate));
+
+    return found;
+}
@@ -0,0 +1,96 @@
+/*
+  ==============================================================================
+
+    BatchRenderer.h
+    Created: 18 Oct 2026 6:40:52pm
+    Author:  John Flynn
+
+  ==============================================================================
+*/
+
+#ifndef BATCHRENDERER_H_INCLUDED
+#define BATCHRENDERER_H_INCLUDED
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "../../../Source/ReverbSettings.h"
+#include "../../../Source/Judio/Dependencies/Aidio/SegmentedConvolution.h"
+
+//==============================================================================
+/** Renders audio files through the reverb as the plugin renders them offline,
+    without a host: the same engine, plan, mix & gain (see ReverbSettings), so
+    32 bit float output is bit-identical to a host's bounce of the plugin
+    processing in float, with Native Rate off and no send buses enabled. Other
+    setups mix the dry elsewhere (sends sum it apart from the wet, Native Rate
+    convolves at 44.1kHz, double precision mixes in double), so don't match
+    it bit for bit.
+
+    Each file streams through the engine a block at a time, so memory is
+    bounded whatever its length. Files render in parallel, one per job, and
+    jobs to spare (fewer files than jobs) render long files in segments on
+    several cores, exactly as in one go (see ado::SegmentedConvolution). The
+    impulse is decoded once and resampled once per sample rate, shared by every
+    engine at that rate.
+
+    @example    BatchRenderer renderer {settings};
+                auto results = renderer.run (files, SystemStats::getNumCpus(), nullptr);
+*/
+class BatchRenderer
+{
+public:
+    struct Settings
+    {
+        int impulse {1};                        // 1 - ReverbSettings::numImpulses
+        float mixPercent {50.0f};               // as the plugin's parameters
+        float gainDecibels {0.0f};
+        bool addTail {false};                   // render the reverb tail past the input's end
+        File outputDirectory;                   // next to each input if not set
+        String outputFormat {".wav"};           // ".wav", ".flac" or ".aiff"
+        int bitsPerSample {32};                 // 32 (WAV): float, the plugin's output exactly
+        int blockSize {4096};
+    };
+
+    struct Result
+    {
+        File input;
+        File output;
+        String error;                           // empty if rendered
+        double audioSeconds {0.0};
+        double renderSeconds {0.0};             // wall clock, this file
+        int numSegments {0};                    // rendered in parallel
+    };
+
+    explicit BatchRenderer (const Settings& settingsToUse);
+
+    /** Renders every file, numJobs at a time, calling onFileDone (if any) as
+        each finishes, one at a time. Results are in the order given.
+    */
+    std::vector<Result> run (const Array<File>& inputs, int numJobs,
+                             std::function<void (const Result&)> onFileDone);
+
+    /** Renders one file, from any thread, in segments on numJobs threads if
+        it's long enough.
+    */
+    Result render (const File& input, int numJobs = 1);
+
+    File getOutputFile (const File& input) const;
+
+private:
+    std::shared_ptr<const ado::Buffer> getImpulse (int sampleRate);
+
+    const Settings settings;
+    AudioFormatManager formats;
+    ado::Buffer impulse {1, 1};                 // as loaded, 44.1kHz
+
+    std::mutex impulsesLock;
+    std::map<int, std::shared_ptr<const ado::Buffer>> impulses;    // by sample rate
+
+    JUCE_DECLARE_NON_COPYABLE (BatchRenderer)
+};
+
+#endif  // BATCHRENDERER_H_INCLUDED
@@ -0,0 +1,155 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Created: 18 Oct 2026 6:40:52pm
+    Author:  John Flynn
+
+    Renders audio files through the Teufelsberg reverb without a host.
+
+  ==============================================================================
+*/
+
+#include <iostream>
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "BatchRenderer.h"
+
+namespace
+{
+
+void printUsage()
+{
+    std::cout << "Usage: BatchRender [options] file...\n"
+                 "\n"
+                 "Renders WAV, FLAC or AIFF files through the Teufelsberg reverb, as the plugin\n"
+                 "renders them offline, several files at once.\n"
+                 "\n"
+                 "  --ir N          impulse 1-" << ReverbSettings::numImpulses << " (default 1)\n"
+                 "  --mix PERCENT   wet 0-100 (default 50)\n"
+                 "  --gain DB       -60 to 12 (default 0)\n"
+                 "  --tail          render the reverb tail past each file's end\n"
+                 "  --out DIR       output directory (default: next to each file)\n"
+                 "  --format EXT    wav, flac or aiff (default wav)\n"
+                 "  --bits N        bits per sample (default 32, float WAV: identical to the plugin)\n"
+                 "  --jobs N        files rendered at once (default: number of CPUs)\n"
+                 "  --block N       samples per block (default 4096)\n"
+              << std::flush;
+}
+
+String formatSeconds (double seconds)
+{
+    return String (seconds, 2) + "s";
+}
+
+String formatRealtime (const BatchRenderer::Result& result)
+{
+    return result.renderSeconds > 0.0 ? String (result.audioSeconds / result.renderSeconds, 1) + "x realtime"
+                                      : String ("-");
+}
+
+} // namespace
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    BatchRenderer::Settings settings;
+    int numJobs {SystemStats::getNumCpus()};
+    Array<File> inputs;
+
+    const StringArray args (argv + 1, argc - 1);
+
+    for (int i = 0; i < args.size(); ++i)
+    {
+        const String& arg = args[i];
+        const bool hasValue {i + 1 < args.size()};
+
+        if (arg == "--help" || arg == "-h")
+        {
+            printUsage();
+            return 0;
+        }
+        else if (arg == "--tail")
+            settings.addTail = true;
+        else if (arg.startsWith ("--") && ! hasValue)
+        {
+            std::cerr << arg << " needs a value\n";
+            return 2;
+        }
+        else if (arg == "--ir")
+            settings.impulse = args[++i].getIntValue();
+        else if (arg == "--mix")
+            settings.mixPercent = jlimit (0.0f, 100.0f, args[++i].getFloatValue());
+        else if (arg == "--gain")
+            settings.gainDecibels = jlimit (-60.0f, 12.0f, args[++i].getFloatValue());
+        else if (arg == "--out")
+            settings.outputDirectory = File::getCurrentWorkingDirectory().getChildFile (args[++i]);
+        else if (arg == "--format")
+            settings.outputFormat = "." + args[++i].trimCharactersAtStart (".").toLowerCase();
+        else if (arg == "--bits")
+            settings.bitsPerSample = args[++i].getIntValue();
+        else if (arg == "--jobs")
+            numJobs = args[++i].getIntValue();
+        else if (arg == "--block")
+            settings.blockSize = args[++i].getIntValue();
+        else if (arg.startsWith ("--"))
+        {
+            std::cerr << "Unknown option " << arg << "\n";
+            return 2;
+        }
+        else
+            inputs.add (File::getCurrentWorkingDirectory().getChildFile (arg));
+    }
+
+    if (inputs.isEmpty())
+    {
+        printUsage();
+        return 2;
+    }
+    if (settings.impulse < 1 || ReverbSettings::numImpulses < settings.impulse
+        || numJobs < 1 || settings.blockSize < 1)
+    {
+        std::cerr << "--ir, --jobs or --block out of range\n";
+        return 2;
+    }
+    if (settings.outputDirectory != File() && ! settings.outputDirectory.createDirectory())
+    {
+        std::cerr << "Can't create " << settings.outputDirectory.getFullPathName() << "\n";
+        return 2;
+    }
+
+    BatchRenderer renderer {settings};
+
+    const double startTime = Time::getMillisecondCounterHiRes();
+    const std::vector<BatchRenderer::Result> results {renderer.run (inputs, numJobs, [] (const BatchRenderer::Result& result)
+    {
+        if (result.error.isEmpty())
+            std::cout << result.output.getFileName() << "  " << formatSeconds (result.audioSeconds)
+                      << " in " << formatSeconds (result.renderSeconds) << ", " << formatRealtime (result)
+                      << (result.numSegments > 1 ? " (" + String (result.numSegments) + " segments)" : String()) << "\n";
+        else
+            std::cerr << result.input.getFileName() << ": " << result.error << "\n";
+    })};
+    const double wallSeconds = (Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+
+    int numRendered {0};
+    double audioSeconds {0.0};
+    for (const auto& result : results)
+    {
+        if (result.error.isEmpty())
+        {
+            ++numRendered;
+            audioSeconds += result.audioSeconds;
+        }
+    }
+
+    BatchRenderer::Result total;
+    total.audioSeconds = audioSeconds;
+    total.renderSeconds = wallSeconds;
+
+    std::cout << numRendered << " of " << results.size() << " files, " << formatSeconds (audioSeconds)
+              << " of audio in " << formatSeconds (wallSeconds) << ", " << formatRealtime (total)
+              << " on " << numJobs << (numJobs == 1 ? " job\n" : " jobs\n");
+
+    return numRendered == static_cast<int> (results.size()) ? 0 : 1;
+}
@@ -0,0 +1,161 @@
+/*
+  ==============================================================================
+
+    Bench.cpp
+    Created: 19 Oct 2026 9:12:40am
+    Author:  John Flynn
+
+  ==============================================================================
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "Bench.h"
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int stallMicroseconds {5000000};      // no output for this long: the daemon's stuck
+
+class BenchClient  : public Thread
+{
+public:
+    BenchClient (const Bench& b, bool paced, int index)
+        : Thread {"Bench client"},
+          bench (b),
+          isPaced {paced},
+          seed {index}
+    {
+    }
+
+    void run() override
+    {
+        const RenderClient::Format& format = bench.format;
+        error = client.connect (bench.socketPath, format);
+        if (error.isNotEmpty())
+            return;
+
+        const int numBlocks {jmax (1, roundToInt (bench.seconds * format.sampleRate / format.blockSize))};
+        const std::chrono::duration<double> blockDuration {static_cast<double> (format.blockSize) / format.sampleRate};
+
+        AudioBuffer<float> input {format.numChannels, format.blockSize};
+        AudioBuffer<float> output {format.numChannels, format.blockSize};
+        Random rand {seed};
+        for (int c = 0; c < format.numChannels; ++c)
+            for (int i = 0; i < format.blockSize; ++i)
+                input.setSample (c, i, rand.nextFloat() * 0.5f - 0.25f);
+
+        std::vector<Clock::time_point> written (static_cast<size_t> (numBlocks));
+        latencies.reserve (written.size());
+
+        const Clock::time_point start {Clock::now()};
+        int numWritten {0};
+        for (;;)
+        {
+            while (client.getNumReadable() > 0)
+            {
+                client.read (output.getArrayOfWritePointers());
+                latencies.push_back (std::chrono::duration<double, std::micro> (Clock::now() - written[latencies.size()]).count());
+            }
+            if (static_cast<int> (latencies.size()) == numBlocks)
+                break;
+
+            if (numWritten < numBlocks && client.getNumWritable() > 0)
+            {
+                const Clock::time_point due {start + std::chrono::duration_cast<Clock::duration> (blockDuration * numWritten)};
+                const Clock::time_point now {Clock::now()};
+
+                if (! isPaced || due <= now)
+                {
+                    written[static_cast<size_t> (numWritten++)] = now;
+                    client.write (input.getArrayOfReadPointers());
+                }
+                else
+                    client.waitForOutput (1 + static_cast<int> (std::chrono::duration_cast<std::chrono::microseconds> (due - now).count()));
+            }
+            else if (! client.waitForOutput (stallMicroseconds) && client.getNumReadable() == 0)
+            {
+                error = "stalled after " + String (static_cast<int> (latencies.size())) + " blocks";
+                return;
+            }
+        }
+
+        numLate = client.getDeadlinesMissed();
+        client.disconnect();
+    }
+
+    String error;
+    std::vector<double> latencies;              // microseconds, by block
+    uint64_t numLate {0};
+
+private:
+    const Bench& bench;
+    const bool isPaced;
+    const int seed;
+    RenderClient client;
+};
+
+String formatMilliseconds (double microseconds)
+{
+    return String (microseconds / 1000.0, 2) + "ms";
+}
+
+} // namespace
+
+//==============================================================================
+bool Bench::run (std::ostream& out) const
+{
+    const double blockMicroseconds {1.0e6 * format.blockSize / format.sampleRate};
+    out << numStreams << (numStreams == 1 ? " stream" : " streams") << " of " << format.numChannels << " channels, "
+        << format.blockSize << " samples at " << format.sampleRate << "Hz (" << formatMilliseconds (blockMicroseconds)
+        << " a block), impulse " << format.impulse << "\n" << std::flush;
+
+    for (bool paced : {true, false})
+    {
+        OwnedArray<BenchClient> clients;
+        for (int s = 0; s < numStreams; ++s)
+            clients.add (new BenchClient {*this, paced, s});
+
+        const Clock::time_point start {Clock::now()};
+        for (auto* c : clients)
+            c->startThread();
+        for (auto* c : clients)
+            c->waitForThreadToExit (-1);
+        const double wallSeconds {std::chrono::duration<double> (Clock::now() - start).count()};
+
+        std::vector<double> latencies;
+        uint64_t numLate {0};
+        for (int s = 0; s < clients.size(); ++s)
+        {
+            if (clients[s]->error.isNotEmpty())
+            {
+                out << "Stream " << s << ": " << clients[s]->error << "\n";
+                return false;
+            }
+            latencies.insert (latencies.end(), clients[s]->latencies.begin(), clients[s]->latencies.end());
+            numLate += clients[s]->numLate;
+        }
+
+        if (paced)
+        {
+            std::sort (latencies.begin(), latencies.end());
+            const auto percentile = [&latencies] (double p) { return latencies[static_cast<size_t> (p * (latencies.size() - 1))]; };
+
+            out << "Latency, write to read back:  median " << formatMilliseconds (percentile (0.5))
+                << ", 99% " << formatMilliseconds (percentile (0.99)) << ", max " << formatMilliseconds (latencies.back())
+                << "; " << numLate << " of " << latencies.size() << " blocks past their deadline\n";
+        }
+        else
+        {
+            const double audioSeconds {static_cast<double> (latencies.size()) * format.blockSize / format.sampleRate};
+            out << "Throughput, rings kept full:  " << String (audioSeconds, 1) << "s of audio in "
+                << String (wallSeconds, 2) << "s, " << String (audioSeconds / wallSeconds, 1) << "x realtime\n";
+        }
+        out << std::flush;
+    }
+    return true;
+}
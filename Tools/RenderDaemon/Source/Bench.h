@@ -0,0 +1,37 @@
+/*
+  ==============================================================================
+
+    Bench.h
+    Created: 19 Oct 2026 9:12:40am
+    Author:  John Flynn
+
+  ==============================================================================
+*/
+
+#ifndef BENCH_H_INCLUDED
+#define BENCH_H_INCLUDED
+
+#include <ostream>
+
+#include "RenderClient.h"
+
+//==============================================================================
+/** Measures a running daemon with numStreams clients at once, each on its own
+    thread:
+    - latency: each writes a block every block's duration, as an audio device
+      would, timing each from its write to its output being read back.
+    - throughput: each keeps its ring full, the daemon flat out.
+
+    False if a stream couldn't connect, or stalled.
+*/
+struct Bench
+{
+    String socketPath {RenderProtocol::defaultSocketPath};
+    RenderClient::Format format;
+    int numStreams {8};
+    double seconds {5.0};                       // of audio per stream, each phase
+
+    bool run (std::ostream& out) const;
+};
+
+#endif  // BENCH_H_INCLUDED
@@ -0,0 +1,147 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Created: 19 Oct 2026 9:12:40am
+    Author:  John Flynn
+
+    Serves the Teufelsberg reverb to the processes of one machine, or
+    benchmarks a running server.
+
+  ==============================================================================
+*/
+
+#include <csignal>
+#include <iostream>
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "Bench.h"
+#include "RenderServer.h"
+
+namespace
+{
+
+RenderServer* server {nullptr};
+
+void stopServer (int)
+{
+    if (server != nullptr)
+        server->stop();                         // an eventfd write, safe in a signal handler
+}
+
+void printUsage()
+{
+    std::cout << "Usage: RenderDaemon [serve] [options]\n"
+                 "       RenderDaemon bench [options]\n"
+                 "\n"
+                 "Serves the Teufelsberg reverb to local clients over a Unix socket, audio\n"
+                 "through shared memory, until interrupted.\n"
+                 "\n"
+                 "  --socket PATH   (default " << RenderProtocol::defaultSocketPath << ")\n"
+                 "  --threads N     render threads (default: number of CPUs)\n"
+                 "  --streams N     streams served at once at most (default 256)\n"
+                 "\n"
+                 "bench runs clients against a running daemon, paced at realtime for latency,\n"
+                 "then flat out for throughput:\n"
+                 "\n"
+                 "  --socket PATH\n"
+                 "  --streams N     clients at once (default 8)\n"
+                 "  --seconds S     of audio per client, each phase (default 5)\n"
+                 "  --channels N    1-" << RenderProtocol::maxChannels << " (default 2)\n"
+                 "  --rate HZ       (default 44100)\n"
+                 "  --block N       samples per block, a power of two (default 256)\n"
+                 "  --ring N        blocks written ahead at most (default 32)\n"
+                 "  --ir N          impulse 1-" << ReverbSettings::numImpulses << " (default 1)\n"
+                 "  --deadline US   microseconds from a block's arrival (default: a block's duration)\n"
+              << std::flush;
+}
+
+} // namespace
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    StringArray args (argv + 1, argc - 1);
+    const bool isBench {args[0] == "bench"};
+    if (isBench || args[0] == "serve")
+        args.remove (0);
+
+    RenderServer::Settings settings;
+    Bench bench;
+
+    for (int i = 0; i < args.size(); ++i)
+    {
+        const String& arg = args[i];
+
+        if (arg == "--help" || arg == "-h")
+        {
+            printUsage();
+            return 0;
+        }
+        else if (i + 1 == args.size())
+        {
+            std::cerr << (arg.startsWith ("--") ? arg + " needs a value\n" : "Unknown argument " + arg + "\n");
+            return 2;
+        }
+
+        const String& value = args[++i];
+
+        if (arg == "--socket")
+            settings.socketPath = bench.socketPath = value;
+        else if (arg == "--threads" && ! isBench)
+            settings.numThreads = value.getIntValue();
+        else if (arg == "--streams")
+            settings.maxStreams = bench.numStreams = value.getIntValue();
+        else if (arg == "--seconds" && isBench)
+            bench.seconds = value.getDoubleValue();
+        else if (arg == "--channels" && isBench)
+            bench.format.numChannels = value.getIntValue();
+        else if (arg == "--rate" && isBench)
+            bench.format.sampleRate = value.getIntValue();
+        else if (arg == "--block" && isBench)
+            bench.format.blockSize = value.getIntValue();
+        else if (arg == "--ring" && isBench)
+            bench.format.ringBlocks = value.getIntValue();
+        else if (arg == "--ir" && isBench)
+            bench.format.impulse = value.getIntValue();
+        else if (arg == "--deadline" && isBench)
+            bench.format.deadlineMicroseconds = value.getIntValue();
+        else
+        {
+            std::cerr << "Unknown option " << arg << "\n";
+            return 2;
+        }
+    }
+
+    if (isBench)
+    {
+        if (bench.numStreams < 1 || bench.seconds <= 0.0)
+        {
+            std::cerr << "--streams or --seconds out of range\n";
+            return 2;
+        }
+        return bench.run (std::cout) ? 0 : 1;
+    }
+
+    if (settings.numThreads < 1 || settings.maxStreams < 1)
+    {
+        std::cerr << "--threads or --streams out of range\n";
+        return 2;
+    }
+
+    RenderServer renderServer {settings};
+    server = &renderServer;
+    std::signal (SIGINT, stopServer);
+    std::signal (SIGTERM, stopServer);
+    std::signal (SIGPIPE, SIG_IGN);             // clients gone mid-reply
+
+    const String error {renderServer.run ([] (const String& message) { std::cout << message << std::endl; })};
+    server = nullptr;
+
+    if (error.isNotEmpty())
+    {
+        std::cerr << error << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,143 @@
+/*
+  ==============================================================================
+
+    Protocol.h
+    Created: 19 Oct 2026 9:12:40am
+    Author:  John Flynn
+
+    What the render daemon and its clients share: the handshake over the Unix
+    socket and the layout of each stream's shared memory.
+
+  ==============================================================================
+*/
+
+#ifndef PROTOCOL_H_INCLUDED
+#define PROTOCOL_H_INCLUDED
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+//==============================================================================
+/** A stream, start to end:
+    - the client makes the shared memory (a memfd, getSharedSize() bytes,
+      zeroed, sealed with F_SEAL_SHRINK) and two eventfds, connects to the
+      daemon's socket and sends a Hello with the three descriptors attached
+      (SCM_RIGHTS), within a second of connecting.
+    - the daemon maps the memory and answers with a Welcome; the first
+      stream at a new impulse, rate & block size waits for its spectra.
+    - the client writes blocks into the input ring, bumps inputBlocks and
+      signals the input eventfd. The daemon convolves each block from the
+      input ring straight into the same slot of the output ring, bumps
+      outputBlocks and signals the output eventfd. The audio itself never
+      crosses the socket, or is copied between the processes.
+    - either side closing the socket ends the stream.
+
+    Each ring holds ringBlocks blocks, a channel at a time (the blocks of a
+    channel contiguous, so runs of them convolve in one call). The client may
+    write block n once it has read the output of block n - ringBlocks, which
+    keeps the daemon from overwriting output not yet read.
+*/
+namespace RenderProtocol
+{
+
+constexpr uint32_t magic {0x54465242};          // "TFRB"
+constexpr uint32_t version {2};
+
+constexpr const char* defaultSocketPath {"/tmp/teufelsberg-render.sock"};
+
+constexpr int maxChannels {8};
+constexpr int minBlockSize {16};                // a power of two in between
+constexpr int maxBlockSize {16384};
+constexpr int maxRingBlocks {1024};
+
+/** Client to daemon, with the memfd, the input eventfd and the output eventfd. */
+struct Hello
+{
+    uint32_t magic;
+    uint32_t version;
+    int32_t numChannels;                        // in & out, 1 to maxChannels
+    int32_t sampleRate;
+    int32_t blockSize;
+    int32_t ringBlocks;
+    int32_t impulse;                            // 1 - ReverbSettings::numImpulses
+    float mixPercent;                           // as the plugin's parameters
+    float gainDecibels;
+    int32_t deadlineMicroseconds;               // from a block's arrival, 0: a block's duration
+};
+
+enum class Status : int32_t
+{
+    ok,
+    badVersion,
+    badFormat,                                  // channels, rate, block or ring size
+    badImpulse,
+    badSharedMemory,                            // descriptors missing, memory too small or not sealed
+    tooManyStreams
+};
+
+inline const char* getDescription (Status status) noexcept
+{
+    switch (status)
+    {
+        case Status::ok:                return "ok";
+        case Status::badVersion:        return "not a client of this version";
+        case Status::badFormat:         return "channels, rate, block or ring size out of range";
+        case Status::badImpulse:        return "no such impulse";
+        case Status::badSharedMemory:   return "shared memory missing, too small or not sealed";
+        case Status::tooManyStreams:    return "too many streams";
+    }
+    return "?";
+}
+
+/** Daemon to client. */
+struct Welcome
+{
+    Status status;
+    int32_t latencySamples;                     // beyond the block: 0, the engine is zero latency
+};
+
+/** At the start of the shared memory, the rings follow. */
+struct Header
+{
+    std::atomic<uint64_t> inputBlocks;          // written by the client
+    std::atomic<uint64_t> outputBlocks;         // written by the daemon
+    std::atomic<uint64_t> deadlinesMissed;      // blocks finished after their deadline
+};
+
+static_assert (ATOMIC_LLONG_LOCK_FREE == 2, "the counters are shared between processes");
+
+constexpr size_t headerSize {64};               // a cache line, the rings stay aligned
+static_assert (sizeof (Header) <= headerSize, "");
+
+inline size_t getRingSize (int numChannels, int blockSize, int ringBlocks) noexcept
+{
+    return sizeof (float) * static_cast<size_t> (numChannels) * static_cast<size_t> (blockSize)
+                          * static_cast<size_t> (ringBlocks);
+}
+
+inline size_t getSharedSize (int numChannels, int blockSize, int ringBlocks) noexcept
+{
+    return headerSize + 2 * getRingSize (numChannels, blockSize, ringBlocks);
+}
+
+inline Header& getHeader (void* shared) noexcept
+{
+    return *static_cast<Header*> (shared);
+}
+
+/** Channel c of the input ring, ringBlocks * blockSize samples. */
+inline float* getInput (void* shared, const Hello& format, int c) noexcept
+{
+    return reinterpret_cast<float*> (static_cast<char*> (shared) + headerSize)
+           + static_cast<size_t> (c) * static_cast<size_t> (format.blockSize * format.ringBlocks);
+}
+
+inline float* getOutput (void* shared, const Hello& format, int c) noexcept
+{
+    return getInput (shared, format, format.numChannels + c);
+}
+
+} // namespace RenderProtocol
+
+#endif  // PROTOCOL_H_INCLUDED
@@ -0,0 +1,189 @@
+/*
+  ==============================================================================
+
+    RenderClient.cpp
+    Created: 19 Oct 2026 9:12:40am
+    Author:  John Flynn
+
+  ==============================================================================
+*/
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include "RenderClient.h"
+
+RenderClient::~RenderClient()
+{
+    disconnect();
+}
+
+String RenderClient::connect (const String& socketPath, const Format& formatToUse)
+{
+    disconnect();
+    format = formatToUse;
+
+    hello.magic = RenderProtocol::magic;
+    hello.version = RenderProtocol::version;
+    hello.numChannels = format.numChannels;
+    hello.sampleRate = format.sampleRate;
+    hello.blockSize = format.blockSize;
+    hello.ringBlocks = format.ringBlocks;
+    hello.impulse = format.impulse;
+    hello.mixPercent = format.mixPercent;
+    hello.gainDecibels = format.gainDecibels;
+    hello.deadlineMicroseconds = format.deadlineMicroseconds;
+
+    if (format.numChannels < 1 || RenderProtocol::maxChannels < format.numChannels
+        || format.blockSize < 1 || format.ringBlocks < 1)
+        return "bad format";
+
+    sockaddr_un address {};
+    address.sun_family = AF_UNIX;
+    if (socketPath.getNumBytesAsUTF8() >= sizeof (address.sun_path))
+        return "socket path too long";
+    socketPath.copyToUTF8 (address.sun_path, sizeof (address.sun_path));
+
+    socket = ::socket (AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (::connect (socket, reinterpret_cast<const sockaddr*> (&address), sizeof (address)) != 0)
+    {
+        const String error {"can't connect to " + socketPath + ": " + String (std::strerror (errno))};
+        disconnect();
+        return error;
+    }
+
+    sharedSize = RenderProtocol::getSharedSize (format.numChannels, format.blockSize, format.ringBlocks);
+    const int memory {memfd_create ("teufelsberg-stream", MFD_CLOEXEC | MFD_ALLOW_SEALING)};
+    if (memory < 0 || ftruncate (memory, static_cast<off_t> (sharedSize)) != 0
+        || fcntl (memory, F_ADD_SEALS, F_SEAL_SHRINK) != 0)            // the daemon requires it
+    {
+        if (memory >= 0)
+            close (memory);
+        disconnect();
+        return "can't make shared memory";
+    }
+
+    void* const mapped {mmap (nullptr, sharedSize, PROT_READ | PROT_WRITE, MAP_SHARED, memory, 0)};
+    shared = mapped != MAP_FAILED ? mapped : nullptr;   // zeroed by ftruncate: the counters start at 0
+    inputEvent = eventfd (0, EFD_CLOEXEC | EFD_NONBLOCK);
+    outputEvent = eventfd (0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (shared == nullptr || inputEvent < 0 || outputEvent < 0)
+    {
+        close (memory);
+        disconnect();
+        return "can't map shared memory";
+    }
+
+        // The Hello, with the memory & eventfds
+    const int fds[3] {memory, inputEvent, outputEvent};
+    char control[CMSG_SPACE (sizeof (fds))] {};
+    iovec data {&hello, sizeof (hello)};
+    msghdr message {};
+    message.msg_iov = &data;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof (control);
+
+    cmsghdr* const c {CMSG_FIRSTHDR (&message)};
+    c->cmsg_level = SOL_SOCKET;
+    c->cmsg_type = SCM_RIGHTS;
+    c->cmsg_len = CMSG_LEN (sizeof (fds));
+    std::memcpy (CMSG_DATA (c), fds, sizeof (fds));
+
+    const bool sent {sendmsg (socket, &message, MSG_NOSIGNAL) == static_cast<ssize_t> (sizeof (hello))};
+    close (memory);                             // the mappings keep it
+
+    RenderProtocol::Welcome welcome {RenderProtocol::Status::badVersion, 0};
+    if (! sent || recv (socket, &welcome, sizeof (welcome), MSG_WAITALL) != static_cast<ssize_t> (sizeof (welcome)))
+    {
+        disconnect();
+        return "no answer from " + socketPath;
+    }
+
+    if (welcome.status != RenderProtocol::Status::ok)
+    {
+        disconnect();
+        return "refused: " + String (RenderProtocol::getDescription (welcome.status));
+    }
+    return {};
+}
+
+void RenderClient::disconnect()
+{
+    if (shared != nullptr)
+        munmap (shared, sharedSize);
+    for (int fd : {socket, inputEvent, outputEvent})
+        if (fd >= 0)
+            close (fd);
+
+    shared = nullptr;
+    socket = inputEvent = outputEvent = -1;
+    numWritten = numRead = 0;
+}
+
+int RenderClient::getNumWritable() const noexcept
+{
+    return format.ringBlocks - static_cast<int> (numWritten - numRead);
+}
+
+void RenderClient::write (const float* const* channels)
+{
+    jassert (isConnected() && getNumWritable() > 0);
+
+    const int offset {static_cast<int> (numWritten % static_cast<uint64_t> (format.ringBlocks)) * format.blockSize};
+    for (int c = 0; c < format.numChannels; ++c)
+        std::memcpy (RenderProtocol::getInput (shared, hello, c) + offset, channels[c],
+                     sizeof (float) * static_cast<size_t> (format.blockSize));
+
+    RenderProtocol::getHeader (shared).inputBlocks.store (++numWritten, std::memory_order_release);
+
+    const uint64_t one {1};
+    const ssize_t written {::write (inputEvent, &one, sizeof (one))};
+    ignoreUnused (written);
+}
+
+int RenderClient::getNumReadable() const noexcept
+{
+    return shared != nullptr ? static_cast<int> (RenderProtocol::getHeader (shared).outputBlocks.load (std::memory_order_acquire) - numRead)
+                             : 0;
+}
+
+void RenderClient::read (float* const* channels)
+{
+    jassert (isConnected() && getNumReadable() > 0);
+
+    const int offset {static_cast<int> (numRead % static_cast<uint64_t> (format.ringBlocks)) * format.blockSize};
+    for (int c = 0; c < format.numChannels; ++c)
+        std::memcpy (channels[c], RenderProtocol::getOutput (shared, hello, c) + offset,
+                     sizeof (float) * static_cast<size_t> (format.blockSize));
+    ++numRead;
+}
+
+bool RenderClient::waitForOutput (int timeoutMicroseconds)
+{
+    if (! isConnected())
+        return false;
+
+    pollfd fds[2] {{outputEvent, POLLIN, 0}, {socket, POLLRDHUP, 0}};
+    const timespec timeout {timeoutMicroseconds / 1000000, (timeoutMicroseconds % 1000000) * 1000L};
+    if (ppoll (fds, 2, &timeout, nullptr) <= 0 || (fds[1].revents & (POLLRDHUP | POLLHUP)) != 0)
+        return false;
+
+    uint64_t count {0};
+    const ssize_t numBytes {::read (outputEvent, &count, sizeof (count))};
+    ignoreUnused (numBytes);
+    return true;
+}
+
+uint64_t RenderClient::getDeadlinesMissed() const noexcept
+{
+    return shared != nullptr ? RenderProtocol::getHeader (shared).deadlinesMissed.load() : 0;
+}
@@ -0,0 +1,87 @@
+/*
+  ==============================================================================
+
+    RenderClient.h
+    Created: 19 Oct 2026 9:12:40am
+    Author:  John Flynn
+
+  ==============================================================================
+*/
+
+#ifndef RENDERCLIENT_H_INCLUDED
+#define RENDERCLIENT_H_INCLUDED
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "Protocol.h"
+
+//==============================================================================
+/** A stream through the render daemon (see RenderServer), from one thread:
+    write blocks while there's room in the ring, read them back convolved.
+
+    @example    RenderClient client;
+                if (client.connect (RenderProtocol::defaultSocketPath, {}).isEmpty())
+                {
+                    client.write (input);
+                    while (client.getNumReadable() == 0)
+                        client.waitForOutput (1000000);
+                    client.read (output);
+                }
+*/
+class RenderClient
+{
+public:
+    struct Format
+    {
+        int numChannels {2};
+        int sampleRate {44100};
+        int blockSize {256};                    // a power of two, 16 - 16384
+        int ringBlocks {32};                    // written ahead at most
+        int impulse {1};                        // 1 - ReverbSettings::numImpulses
+        float mixPercent {50.0f};               // as the plugin's parameters
+        float gainDecibels {0.0f};
+        int deadlineMicroseconds {0};           // 0: a block's duration
+    };
+
+    RenderClient() {}
+    ~RenderClient();
+
+    /** Empty if the daemon took the stream, otherwise why not. */
+    String connect (const String& socketPath, const Format& formatToUse);
+    void disconnect();
+    bool isConnected() const noexcept { return shared != nullptr; }
+
+    /** Blocks that can be written now, up to ringBlocks. */
+    int getNumWritable() const noexcept;
+
+    /** A block of numChannels x blockSize, if getNumWritable() > 0. */
+    void write (const float* const* channels);
+
+    /** Blocks convolved and not yet read, in the order written. */
+    int getNumReadable() const noexcept;
+
+    /** The oldest block not yet read, if getNumReadable() > 0. */
+    void read (float* const* channels);
+
+    /** Sleeps until the daemon finishes a block or the timeout: false if it
+        timed out, or the daemon's gone.
+    */
+    bool waitForOutput (int timeoutMicroseconds);
+
+    uint64_t getDeadlinesMissed() const noexcept;
+    const Format& getFormat() const noexcept { return format; }
+
+private:
+    Format format;
+    RenderProtocol::Hello hello {};
+    int socket {-1};
+    int inputEvent {-1};
+    int outputEvent {-1};
+    void* shared {nullptr};
+    size_t sharedSize {0};
+    uint64_t numWritten {0};
+    uint64_t numRead {0};
+
+    JUCE_DECLARE_NON_COPYABLE (RenderClient)
+};
+
+#endif  // RENDERCLIENT_H_INCLUDED
@@ -0,0 +1,774 @@
+/*
+  ==============================================================================
+
+    RenderServer.cpp
+    Created: 19 Oct 2026 9:12:40am
+    Author:  John Flynn
+
+  ==============================================================================
+*/
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <queue>
+
+#include "RenderServer.h"
+#include "../../../Source/Judio/Dependencies/Aidio/Kernels.h"
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+void notify (int eventFd) noexcept
+{
+    const uint64_t one {1};
+    const ssize_t written {::write (eventFd, &one, sizeof (one))};
+    ignoreUnused (written);                     // full only after 2^64 - 1 unread
+}
+
+void drain (int eventFd) noexcept
+{
+    uint64_t count {0};
+    const ssize_t numRead {::read (eventFd, &count, sizeof (count))};
+    ignoreUnused (numRead);
+}
+
+/** Reads the Hello and up to 3 descriptors, without waiting: the bytes read
+    (sizeof (hello) for a Hello), or -1 with errno EAGAIN if there's nothing yet.
+*/
+ssize_t receiveHello (int socket, RenderProtocol::Hello& hello, int* fds, int& numFds)
+{
+    iovec data {&hello, sizeof (hello)};
+    char control[CMSG_SPACE (3 * sizeof (int))];
+    msghdr message {};
+    message.msg_iov = &data;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof (control);
+
+    const ssize_t received {recvmsg (socket, &message, MSG_CMSG_CLOEXEC | MSG_DONTWAIT)};
+    if (received < 0)
+        return received;
+
+    for (cmsghdr* c = CMSG_FIRSTHDR (&message); c != nullptr; c = CMSG_NXTHDR (&message, c))
+    {
+        if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SCM_RIGHTS)
+        {
+            numFds = std::min (3, static_cast<int> ((c->cmsg_len - CMSG_LEN (0)) / sizeof (int)));   // more are truncated
+            std::memcpy (fds, CMSG_DATA (c), sizeof (int) * static_cast<size_t> (numFds));
+        }
+    }
+    return received;
+}
+
+} // namespace
+
+//==============================================================================
+/** A client's stream: its shared memory & eventfds, and the engines. */
+class RenderServer::Stream
+{
+public:
+    Stream (int socketFd, const RenderProtocol::Hello& hello, int inputFd, int outputFd,
+            void* memory, size_t memorySize, std::shared_ptr<const Spectra> impulseSpectra)
+        : socket {socketFd},
+          inputEvent {inputFd},
+          outputEvent {outputFd},
+          format (hello),
+          budget {std::chrono::microseconds {hello.deadlineMicroseconds > 0
+                                             ? static_cast<int64> (hello.deadlineMicroseconds)
+                                             : static_cast<int64> (1.0e6 * hello.blockSize / hello.sampleRate)}},
+          shared {memory},
+          sharedSize {memorySize},
+          spectra {std::move (impulseSpectra)},
+          gains (ReverbSettings::getMixGains (hello.mixPercent, hello.gainDecibels))
+    {
+        const int numChannels {format.numChannels};
+        const int irChannels {static_cast<int> (spectra->size())};
+
+            // Routes (input to output channel) by impulse channel, as the
+            // plugin's topologies
+        std::vector<std::vector<Route>> routes (static_cast<size_t> (irChannels));
+        if (ReverbSettings::getTopology (numChannels, numChannels, irChannels) == ado::Convolution::Topology::trueStereo)
+            routes = {{{0, 0}}, {{0, 1}}, {{1, 0}}, {{1, 1}}};     // LL, LR, RL, RR
+        else
+            for (int c = 0; c < numChannels; ++c)
+                routes[static_cast<size_t> (c % irChannels)].push_back ({c, c});
+
+        for (size_t k = 0; k < routes.size(); ++k)
+            if (! routes[k].empty())
+                groups.emplace_back (new Group {(*spectra)[k], routes[k], maxBlocksPerTurn * format.blockSize});
+
+        wet.clearAndResize (numChannels, maxBlocksPerTurn * format.blockSize);
+    }
+
+    ~Stream()
+    {
+        munmap (shared, sharedSize);
+        close (inputEvent);
+        close (outputEvent);
+        close (socket);
+    }
+
+    /** Convolves the blocks waiting, maxBlocksPerTurn at most: how many, and
+        whether more are waiting.
+    */
+    int render (bool& moreWaiting)
+    {
+        RenderProtocol::Header& header = RenderProtocol::getHeader (shared);
+        const uint64_t done {header.outputBlocks.load (std::memory_order_relaxed)};
+        const uint64_t waiting {header.inputBlocks.load (std::memory_order_acquire) - done};
+
+        const int ringBlocks {format.ringBlocks};
+        const int slot {static_cast<int> (done % static_cast<uint64_t> (ringBlocks))};
+        const int numBlocks {static_cast<int> (std::min<uint64_t> (waiting, std::min (maxBlocksPerTurn, ringBlocks - slot)))};
+        moreWaiting = waiting > static_cast<uint64_t> (numBlocks);
+
+        if (numBlocks == 0)
+            return 0;
+
+        const int offset {slot * format.blockSize};
+        const int numSamples {numBlocks * format.blockSize};
+
+        wet.clear();
+        for (auto& group : groups)
+        {
+            float* const* scratch {group->scratch.getWriteArray()};
+            for (size_t r = 0; r < group->routes.size(); ++r)
+                ado::vectorCopy (RenderProtocol::getInput (shared, format, group->routes[r].input) + offset,
+                                 scratch[r], numSamples);
+
+            group->engine.process (scratch, numSamples);
+
+            for (size_t r = 0; r < group->routes.size(); ++r)
+                ado::vectorAdd (scratch[r], wet.getWriteArray()[group->routes[r].output], numSamples);
+        }
+
+        for (int c = 0; c < format.numChannels; ++c)
+            ado::vectorMix (RenderProtocol::getInput (shared, format, c) + offset, gains.dry,
+                            wet.getReadArray()[c], gains.wet,
+                            RenderProtocol::getOutput (shared, format, c) + offset, numSamples);
+
+        header.outputBlocks.store (done + static_cast<uint64_t> (numBlocks), std::memory_order_release);
+        notify (outputEvent);
+        return numBlocks;
+    }
+
+    bool hasInput() const noexcept
+    {
+        const RenderProtocol::Header& header = RenderProtocol::getHeader (shared);
+        return header.inputBlocks.load() != header.outputBlocks.load();
+    }
+
+    void countLate (int numBlocks) noexcept
+    {
+        RenderProtocol::getHeader (shared).deadlinesMissed += static_cast<uint64_t> (numBlocks);
+    }
+
+    uint64_t getNumBlocks() const noexcept { return RenderProtocol::getHeader (shared).outputBlocks.load(); }
+    uint64_t getNumLate() const noexcept { return RenderProtocol::getHeader (shared).deadlinesMissed.load(); }
+
+    const int socket;
+    const int inputEvent;
+    const int outputEvent;
+    const RenderProtocol::Hello format;
+    const Clock::duration budget;
+    std::atomic<bool> queued {false};           // with the scheduler, or rendering
+
+private:
+    struct Route
+    {
+        int input;
+        int output;
+    };
+
+    struct Group
+    {
+        Group (std::shared_ptr<const ado::MultiStreamConvolution::Spectra> s, std::vector<Route> r, int maxSamples)
+            : routes (std::move (r)),
+              engine {std::move (s), static_cast<int> (routes.size())},
+              scratch {static_cast<int> (routes.size()), maxSamples}
+        {
+        }
+
+        const std::vector<Route> routes;
+        ado::MultiStreamConvolution engine;     // a stream per route, in place
+        ado::Buffer scratch;
+    };
+
+    void* const shared;
+    const size_t sharedSize;
+    const std::shared_ptr<const Spectra> spectra;
+    const ado::Convolution::MixGains gains;
+    std::vector<std::unique_ptr<Group>> groups;
+    ado::Buffer wet;
+
+    JUCE_DECLARE_NON_COPYABLE (Stream)
+};
+
+//==============================================================================
+/** Worker threads taking the streams with blocks waiting, earliest deadline
+    first, a turn at a time.
+*/
+class RenderServer::Scheduler
+{
+public:
+    explicit Scheduler (int numThreads)
+    {
+        for (int t = 0; t < numThreads; ++t)
+        {
+            workers.emplace_back (new Worker {*this});
+            workers.back()->startThread (8);    // high, but below the clients' audio threads
+        }
+    }
+
+    ~Scheduler()
+    {
+        {
+            std::lock_guard<std::mutex> guard {lock};
+            stopping = true;
+        }
+        wake.notify_all();
+
+        for (auto& w : workers)
+            w->stopThread (2000);
+    }
+
+    /** Queues a stream with blocks arriving now, unless it already is. */
+    void add (const std::shared_ptr<Stream>& stream)
+    {
+        if (! stream->queued.exchange (true))
+            push (stream, Clock::now() + stream->budget);
+    }
+
+private:
+    struct Job
+    {
+        Clock::time_point deadline;
+        std::shared_ptr<Stream> stream;
+
+        bool operator< (const Job& other) const noexcept { return other.deadline < deadline; }  // earliest on top
+    };
+
+    struct Worker  : public juce::Thread
+    {
+        explicit Worker (Scheduler& owner) : juce::Thread {"Render worker"}, scheduler (owner) {}
+
+        void run() override
+        {
+            while (scheduler.runNext())
+                ;
+        }
+
+        Scheduler& scheduler;
+    };
+
+    void push (const std::shared_ptr<Stream>& stream, Clock::time_point deadline)
+    {
+        {
+            std::lock_guard<std::mutex> guard {lock};
+            jobs.push ({deadline, stream});
+        }
+        wake.notify_one();
+    }
+
+    bool runNext()
+    {
+        Job job;
+        {
+            std::unique_lock<std::mutex> guard {lock};
+            wake.wait (guard, [this] { return stopping || ! jobs.empty(); });
+            if (stopping)
+                return false;
+
+            job = jobs.top();
+            jobs.pop();
+        }
+
+        Stream& stream = *job.stream;
+        bool moreWaiting {false};
+        const int numBlocks {stream.render (moreWaiting)};
+        if (numBlocks > 0 && Clock::now() > job.deadline)
+            stream.countLate (numBlocks);
+
+        if (moreWaiting)                        // already there: the same deadline, after the others'
+            push (job.stream, job.deadline);
+        else
+        {
+            stream.queued = false;
+            if (stream.hasInput())              // arrived while rendering
+                add (job.stream);
+        }
+        return true;
+    }
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::priority_queue<Job> jobs;
+    std::mutex lock;
+    std::condition_variable wake;
+    bool stopping {false};
+};
+
+//==============================================================================
+/** Transforms the spectra for an impulse, rate & block size on a thread of its
+    own, loading & resampling the impulse, so the socket thread never waits
+    on it. Signals builtEvent when some are ready.
+*/
+class RenderServer::Builder  : private juce::Thread
+{
+public:
+    Builder()
+        : juce::Thread {"Spectra builder"},
+          builtEvent {eventfd (0, EFD_CLOEXEC | EFD_NONBLOCK)}
+    {
+        startThread();                          // below the render threads
+    }
+
+    ~Builder()
+    {
+        signalThreadShouldExit();
+        {
+            std::lock_guard<std::mutex> guard {lock};
+        }
+        wake.notify_all();
+        stopThread (10000);                     // a build can't be interrupted
+        close (builtEvent);
+    }
+
+    void build (const SpectraKey& key)
+    {
+        {
+            std::lock_guard<std::mutex> guard {lock};
+            toBuild.push_back (key);
+        }
+        wake.notify_one();
+    }
+
+    std::vector<std::pair<SpectraKey, std::shared_ptr<const Spectra>>> takeBuilt()
+    {
+        drain (builtEvent);
+
+        std::lock_guard<std::mutex> guard {lock};
+        std::vector<std::pair<SpectraKey, std::shared_ptr<const Spectra>>> taken;
+        std::swap (taken, built);
+        return taken;
+    }
+
+    const int builtEvent;
+
+private:
+    void run() override
+    {
+        for (;;)
+        {
+            SpectraKey key;
+            {
+                std::unique_lock<std::mutex> guard {lock};
+                wake.wait (guard, [this] { return threadShouldExit() || ! toBuild.empty(); });
+                if (threadShouldExit())
+                    return;
+
+                key = toBuild.front();
+                toBuild.pop_front();
+            }
+
+            std::shared_ptr<const Spectra> spectra {transform (key)};
+            {
+                std::lock_guard<std::mutex> guard {lock};
+                built.emplace_back (key, std::move (spectra));
+            }
+            ::notify (builtEvent);               // not Thread::notify()
+        }
+    }
+
+    std::shared_ptr<const Spectra> transform (const SpectraKey& key)
+    {
+        const int impulse {std::get<0> (key)};
+        if (impulses.count (impulse) == 0)
+            ReverbSettings::loadImpulse (impulse, impulses[impulse]);
+
+        const ado::Buffer ir {ado::Convolution::resampleImpulse (impulses[impulse], std::get<1> (key))};
+
+        auto channels = std::make_shared<Spectra>();
+        for (int c = 0; c < ir.getNumChannels(); ++c)
+            channels->push_back (std::make_shared<const ado::MultiStreamConvolution::Spectra> (ir, c, std::get<2> (key)));
+        return channels;
+    }
+
+    std::map<int, ado::Buffer> impulses;        // as loaded, 44.1kHz, a few at most
+    std::deque<SpectraKey> toBuild;
+    std::vector<std::pair<SpectraKey, std::shared_ptr<const Spectra>>> built;
+    std::mutex lock;
+    std::condition_variable wake;
+};
+
+//==============================================================================
+/** A client connected but not yet a stream: waiting for its Hello, then for
+    its spectra.
+*/
+struct RenderServer::Connection
+{
+    int socket;
+    Clock::time_point helloDeadline;
+    bool helloReceived {false};
+    RenderProtocol::Hello hello {};
+    int fds[3] {-1, -1, -1};
+    int numFds {0};
+};
+
+//==============================================================================
+RenderServer::RenderServer (const Settings& settingsToUse)
+    : settings (settingsToUse),
+      stopEvent {eventfd (0, EFD_CLOEXEC | EFD_NONBLOCK)}
+{
+    jassert (0 < settings.numThreads);
+}
+
+RenderServer::~RenderServer()
+{
+    close (stopEvent);
+}
+
+String RenderServer::run (Log log)
+{
+    const String& path = settings.socketPath;
+
+    sockaddr_un address {};
+    address.sun_family = AF_UNIX;
+    if (path.getNumBytesAsUTF8() >= sizeof (address.sun_path))
+        return "socket path too long: " + path;
+    path.copyToUTF8 (address.sun_path, sizeof (address.sun_path));
+
+    listener = socket (AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    const sockaddr* const addr {reinterpret_cast<const sockaddr*> (&address)};
+
+    if (connect (listener, addr, sizeof (address)) == 0)
+    {
+        close (listener);
+        return "already served: " + path;
+    }
+    unlink (address.sun_path);                  // not answering, left by one that crashed
+
+    if (bind (listener, addr, sizeof (address)) != 0 || listen (listener, 64) != 0)
+    {
+        const String error {"can't listen on " + path + ": " + String (std::strerror (errno))};
+        close (listener);
+        return error;
+    }
+
+    scheduler.reset (new Scheduler {settings.numThreads});
+    builder.reset (new Builder);
+
+    epoll = epoll_create1 (EPOLL_CLOEXEC);
+    for (int fd : {listener, stopEvent, builder->builtEvent})
+    {
+        epoll_event e {};
+        e.events = EPOLLIN;
+        e.data.fd = fd;
+        epoll_ctl (epoll, EPOLL_CTL_ADD, fd, &e);
+    }
+
+    log ("Listening on " + path + ", " + String (settings.numThreads) + " render threads");
+
+    bool running {true};
+    while (running)
+    {
+        epoll_event events[64];
+        const int numEvents {epoll_wait (epoll, events, 64, getMillisecondsToNextExpiry())};
+        if (numEvents < 0 && errno != EINTR)
+            break;
+
+        for (int i = 0; i < numEvents; ++i)
+        {
+            const int fd {events[i].data.fd};
+
+            if (fd == stopEvent)
+                running = false;
+            else if (fd == listener)
+                accept (log);
+            else if (fd == builder->builtEvent)
+                addBuilt (log);
+            else if (connections.count (fd) > 0)
+                readHello (*connections[fd], log);
+            else
+            {
+                auto found = streams.find (fd);
+                if (found == streams.end())
+                    continue;
+
+                const std::shared_ptr<Stream> stream {found->second};
+                if (fd == stream->inputEvent)
+                {
+                    drain (fd);
+                    scheduler->add (stream);
+                }
+                else                            // the client's socket: closed, or talking out of turn
+                {
+                    char ignored[64];
+                    if (recv (fd, ignored, sizeof (ignored), MSG_DONTWAIT) > 0)
+                        continue;
+
+                    epoll_ctl (epoll, EPOLL_CTL_DEL, stream->socket, nullptr);
+                    epoll_ctl (epoll, EPOLL_CTL_DEL, stream->inputEvent, nullptr);
+                    streams.erase (stream->socket);
+                    streams.erase (stream->inputEvent);
+                    log ("Stream " + String (stream->socket) + " closed, " + String (stream->getNumBlocks())
+                         + " blocks, " + String (stream->getNumLate()) + " late");
+                }                               // a worker may still hold it, it closes after
+            }
+        }
+
+        expireConnections (log);
+    }
+
+    scheduler.reset();                          // waits for the workers
+    builder.reset();
+    streams.clear();
+    for (auto& c : connections)
+    {
+        for (int i = 0; i < c.second->numFds; ++i)
+            close (c.second->fds[i]);
+        close (c.first);
+    }
+    connections.clear();
+    close (epoll);
+    close (listener);
+    unlink (address.sun_path);
+    log ("Stopped");
+    return {};
+}
+
+void RenderServer::stop() noexcept
+{
+    notify (stopEvent);
+}
+
+//==============================================================================
+//private:
+
+void RenderServer::accept (Log& log)
+{
+    const int client {accept4 (listener, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK)};
+    if (client < 0)
+        return;
+
+    if (static_cast<int> (connections.size()) >= settings.maxStreams)     // not even read, so not answered
+    {
+        close (client);
+        log ("Refused a connection: too many waiting");
+        return;
+    }
+
+        // Clients say hello on connecting, read when it arrives: those that
+        // don't within helloTimeoutMs are dropped (expireConnections())
+    std::unique_ptr<Connection> connection {new Connection};
+    connection->socket = client;
+    connection->helloDeadline = Clock::now() + std::chrono::milliseconds {helloTimeoutMs};
+
+    epoll_event e {};
+    e.events = EPOLLIN | EPOLLRDHUP;
+    e.data.fd = client;
+    epoll_ctl (epoll, EPOLL_CTL_ADD, client, &e);
+    connections[client] = std::move (connection);
+}
+
+void RenderServer::readHello (Connection& connection, Log& log)
+{
+    const ssize_t received {receiveHello (connection.socket, connection.hello, connection.fds, connection.numFds)};
+    if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        return;                                 // woken for nothing
+
+    if (received != static_cast<ssize_t> (sizeof (connection.hello)))
+    {
+        refuse (connection, RenderProtocol::Status::badVersion, log);
+        return;
+    }
+
+    const RenderProtocol::Status status {check (connection)};
+    if (status != RenderProtocol::Status::ok)
+    {
+        refuse (connection, status, log);
+        return;
+    }
+
+    connection.helloReceived = true;
+    epoll_ctl (epoll, EPOLL_CTL_DEL, connection.socket, nullptr);  // back once it's a stream
+
+    forgetUnusedSpectra();
+    const RenderProtocol::Hello& hello = connection.hello;
+    const SpectraKey key {hello.impulse, hello.sampleRate, hello.blockSize};
+
+    auto found = spectra.find (key);
+    std::shared_ptr<const Spectra> ready {found != spectra.end() ? found->second.lock() : nullptr};
+    if (ready != nullptr)
+    {
+        open (connection, std::move (ready), log);
+        return;
+    }
+
+    std::vector<int>& waiting = waitingForSpectra[key];
+    if (waiting.empty())
+        builder->build (key);
+    waiting.push_back (connection.socket);
+}
+
+void RenderServer::addBuilt (Log& log)
+{
+    for (auto& built : builder->takeBuilt())
+    {
+        spectra[built.first] = built.second;
+
+        std::vector<int> waiting;
+        std::swap (waiting, waitingForSpectra[built.first]);
+        waitingForSpectra.erase (built.first);
+
+        for (int socket : waiting)
+        {
+            auto found = connections.find (socket);
+            if (found != connections.end())
+                open (*found->second, built.second, log);
+        }
+    }
+}
+
+void RenderServer::expireConnections (Log& log)
+{
+    const Clock::time_point now {Clock::now()};
+
+    std::vector<Connection*> expired;
+    for (auto& c : connections)
+        if (! c.second->helloReceived && c.second->helloDeadline <= now)
+            expired.push_back (c.second.get());
+
+    for (Connection* c : expired)
+        refuse (*c, RenderProtocol::Status::badVersion, log);   // silent: no client of ours
+}
+
+int RenderServer::getMillisecondsToNextExpiry() const
+{
+    const Clock::time_point now {Clock::now()};
+    int wait {-1};
+
+    for (auto& c : connections)
+    {
+        if (c.second->helloReceived)
+            continue;
+
+        const auto left = std::chrono::duration_cast<std::chrono::milliseconds> (c.second->helloDeadline - now).count();
+        const int ms {static_cast<int> (std::max<int64> (0, left + 1))};
+        wait = wait < 0 ? ms : std::min (wait, ms);
+    }
+    return wait;
+}
+
+RenderProtocol::Status RenderServer::check (const Connection& connection) const
+{
+    using Status = RenderProtocol::Status;
+    const RenderProtocol::Hello& hello = connection.hello;
+
+    if (hello.magic != RenderProtocol::magic || hello.version != RenderProtocol::version)
+        return Status::badVersion;
+
+    if (hello.numChannels < 1 || RenderProtocol::maxChannels < hello.numChannels
+        || hello.sampleRate < 8000 || 384000 < hello.sampleRate
+        || ! ado::isPowerOf2 (hello.blockSize)
+        || hello.blockSize < RenderProtocol::minBlockSize || RenderProtocol::maxBlockSize < hello.blockSize
+        || hello.ringBlocks < 1 || RenderProtocol::maxRingBlocks < hello.ringBlocks)
+        return Status::badFormat;
+
+    if (hello.impulse < 1 || ReverbSettings::numImpulses < hello.impulse)
+        return Status::badImpulse;
+
+    int numWaiting {0};
+    for (auto& w : waitingForSpectra)
+        numWaiting += static_cast<int> (w.second.size());
+    if (static_cast<int> (streams.size() / 2) + numWaiting >= settings.maxStreams)
+        return Status::tooManyStreams;
+
+        // Sealed against shrinking, or the client could truncate it under
+        // the mapping and the daemon's next access would SIGBUS
+    const size_t size {RenderProtocol::getSharedSize (hello.numChannels, hello.blockSize, hello.ringBlocks)};
+    if (connection.numFds != 3)
+        return Status::badSharedMemory;
+
+    const int seals {fcntl (connection.fds[0], F_GET_SEALS)};
+    struct stat memory {};
+    if (seals < 0 || (seals & F_SEAL_SHRINK) == 0
+        || fstat (connection.fds[0], &memory) != 0 || static_cast<size_t> (memory.st_size) < size)
+        return Status::badSharedMemory;
+
+    return Status::ok;
+}
+
+void RenderServer::open (Connection& connection, std::shared_ptr<const Spectra> impulseSpectra, Log& log)
+{
+    const RenderProtocol::Hello hello {connection.hello};
+    const int client {connection.socket};
+
+    const size_t size {RenderProtocol::getSharedSize (hello.numChannels, hello.blockSize, hello.ringBlocks)};
+    void* const shared {mmap (nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, connection.fds[0], 0)};
+    if (shared == MAP_FAILED)
+    {
+        refuse (connection, RenderProtocol::Status::badSharedMemory, log);
+        return;
+    }
+
+    close (connection.fds[0]);                  // the mapping keeps it
+    const auto stream = std::make_shared<Stream> (client, hello, connection.fds[1], connection.fds[2], shared, size,
+                                                  std::move (impulseSpectra));
+    connections.erase (client);                 // the stream owns its descriptors now
+
+    const RenderProtocol::Welcome welcome {RenderProtocol::Status::ok, 0};
+    send (client, &welcome, sizeof (welcome), MSG_NOSIGNAL);
+
+    for (int fd : {stream->socket, stream->inputEvent})
+    {
+        epoll_event e {};
+        e.events = EPOLLIN | (fd == stream->socket ? EPOLLRDHUP : 0u);
+        e.data.fd = fd;
+        epoll_ctl (epoll, EPOLL_CTL_ADD, fd, &e);
+        streams[fd] = stream;
+    }
+    log ("Stream " + String (client) + ": " + String (hello.numChannels) + " channels, "
+         + String (hello.blockSize) + " samples at " + String (hello.sampleRate) + "Hz, impulse "
+         + String (hello.impulse) + ", " + String (static_cast<int> (streams.size() / 2)) + " streams");
+
+    if (stream->hasInput())                     // written before the welcome
+        scheduler->add (stream);
+}
+
+void RenderServer::refuse (Connection& connection, RenderProtocol::Status status, Log& log)
+{
+    const int client {connection.socket};
+
+    const RenderProtocol::Welcome welcome {status, 0};
+    send (client, &welcome, sizeof (welcome), MSG_NOSIGNAL);
+
+    for (int i = 0; i < connection.numFds; ++i)
+        close (connection.fds[i]);
+    epoll_ctl (epoll, EPOLL_CTL_DEL, client, nullptr);     // if it's still there
+    close (client);
+    connections.erase (client);
+
+    log ("Refused a stream: " + String (RenderProtocol::getDescription (status)));
+}
+
+void RenderServer::forgetUnusedSpectra()
+{
+    for (auto i = spectra.begin(); i != spectra.end(); )
+        i = i->second.expired() ? spectra.erase (i) : std::next (i);
+}
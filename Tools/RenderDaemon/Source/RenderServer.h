@@ -0,0 +1,108 @@
+/*
+  ==============================================================================
+
+    RenderServer.h
+    Created: 19 Oct 2026 9:12:40am
+    Author:  John Flynn
+
+  ==============================================================================
+*/
+
+#ifndef RENDERSERVER_H_INCLUDED
+#define RENDERSERVER_H_INCLUDED
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "../../../Source/ReverbSettings.h"
+#include "../../../Source/Judio/Dependencies/Aidio/MultiStreamConvolution.h"
+#include "Protocol.h"
+
+//==============================================================================
+/** The reverb as a service for the processes of one Linux machine: clients
+    connect over a Unix domain socket and stream audio through shared memory
+    (see RenderProtocol), each stream with its own format, impulse, mix and
+    gain.
+
+    Streams with the same impulse, rate and block size share its spectra,
+    transformed once (ado::MultiStreamConvolution::Spectra) and kept while a
+    stream uses them, and the channels of a stream that use the same impulse
+    channel share an engine, two per FFT. Blocks are convolved on a pool of
+    threads, earliest deadline first: a stream's deadline is its blocks'
+    arrival plus its budget (a block's duration unless the client asks for
+    less), and each turn runs a few blocks at most, so a client writing far
+    ahead can't hold up the others. Blocks finished late are counted in the
+    stream's shared header.
+
+    The socket thread never blocks on a client: Hellos are read as they
+    arrive (a client silent for helloTimeoutMs is dropped), and spectra not
+    yet transformed are built on a thread of their own, the client answered
+    once they're ready.
+
+    @example    RenderServer server {settings};
+                const String error {server.run ([] (const String& message) { std::cout << message << "\n"; })};
+*/
+class RenderServer
+{
+public:
+    struct Settings
+    {
+        String socketPath {RenderProtocol::defaultSocketPath};
+        int numThreads {SystemStats::getNumCpus()};
+        int maxStreams {256};
+    };
+
+    using Log = std::function<void (const String& message)>;
+
+    explicit RenderServer (const Settings& settingsToUse);
+    ~RenderServer();
+
+    /** Serves until stop(), on the calling thread. An error if it couldn't
+        listen, otherwise empty once stopped.
+    */
+    String run (Log log);
+
+    /** From any thread, or a signal handler. */
+    void stop() noexcept;
+
+    static constexpr int maxBlocksPerTurn {8};
+    static constexpr int helloTimeoutMs {1000};
+
+private:
+    class Stream;
+    class Scheduler;
+    class Builder;
+    struct Connection;
+    using Spectra = std::vector<std::shared_ptr<const ado::MultiStreamConvolution::Spectra>>;
+    using SpectraKey = std::tuple<int, int, int>;                  // impulse, rate, block
+
+    void accept (Log& log);
+    void readHello (Connection& connection, Log& log);
+    void addBuilt (Log& log);
+    void expireConnections (Log& log);
+    int getMillisecondsToNextExpiry() const;
+    RenderProtocol::Status check (const Connection& connection) const;
+    void open (Connection& connection, std::shared_ptr<const Spectra> impulseSpectra, Log& log);
+    void refuse (Connection& connection, RenderProtocol::Status status, Log& log);
+    void forgetUnusedSpectra();
+
+    const Settings settings;
+    const int stopEvent;
+    int listener {-1};
+    int epoll {-1};
+
+    std::unique_ptr<Scheduler> scheduler;
+    std::unique_ptr<Builder> builder;
+    std::map<int, std::shared_ptr<Stream>> streams;                 // by socket & input eventfd
+    std::map<int, std::unique_ptr<Connection>> connections;         // by socket, until they're streams
+    std::map<SpectraKey, std::weak_ptr<const Spectra>> spectra;     // while a stream uses them
+    std::map<SpectraKey, std::vector<int>> waitingForSpectra;       // sockets, while they're built
+
+    JUCE_DECLARE_NON_COPYABLE (RenderServer)
+};
+
+#endif  // RENDERSERVER_H_INCLUDED